@@ -103,12 +103,9 @@ PageBuilder delPage("/del", { elmDel });
 // with the <li> tag.
 String viewCredential(PageArgument& args) {
   AutoConnectCredential  ac(CREDENTIAL_OFFSET);
-  station_config_t  entry;
   String content = "";
-  uint8_t  count = ac.entries();          // Get number of entries.
 
-  for (int8_t i = 0; i < count; i++) {    // Loads all entries.
-    ac.load(i, &entry);
+  for (const station_config_t& entry : ac) {  // Loads all entries.
     // Build a SSID line of an HTML.
     content += String("<li>") + String((char *)entry.ssid) + String("</li>");
   }
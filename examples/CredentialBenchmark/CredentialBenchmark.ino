@@ -0,0 +1,119 @@
+/*
+  CredentialBenchmark.ino, Example for the AutoConnect library.
+  Copyright (c) 2026, Hieromon Ikasamo
+  https://github.com/Hieromon/AutoConnect
+
+  This software is released under the MIT License.
+  https://opensource.org/licenses/MIT
+
+  CredentialBenchmark.ino measures the time of saving, seeking and
+  loading many credentials with AutoConnectCredential. It saves
+  BENCH_ENTRIES synthetic credentials named "~000", "~001", ... and
+  reports the time of the following operations on the serial monitor:
+
+    saveAll   Save all the entries with a single commit
+    save      Replace an existing entry
+    seek      Load an entry by SSID (the last one saved)
+    load      Load every entry by index
+    iterate   Traverse all the entries with the iterator
+
+  The synthetic entries are deleted at the end and the credentials
+  saved by other sketches are left as they are. The EEPROM of ESP8266
+  is a single flash sector, so fewer entries are saved there by default.
+  Its total time includes erasing the sector at each commit.
+*/
+
+#if defined(ARDUINO_ARCH_ESP8266)
+#include <ESP8266WiFi.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#endif
+#include <AutoConnect.h>
+#include <AutoConnectCredential.h>
+#include <vector>
+
+#ifndef BENCH_ENTRIES
+#if AC_CREDENTIAL_PREFERENCES == 0
+#define BENCH_ENTRIES 300
+#else
+#define BENCH_ENTRIES 512
+#endif
+#endif
+
+static void makeEntry(const uint16_t n, station_config_t* config) {
+  memset(config, 0x00, sizeof(station_config_t));
+  snprintf(reinterpret_cast<char*>(config->ssid), sizeof(station_config_t::ssid), "~%03x", n);
+  config->bssid[5] = static_cast<uint8_t>(n);
+  config->dhcp = STA_DHCP;
+}
+
+static void report(const char* op, const unsigned long us, const uint16_t count) {
+  Serial.printf("%-8s %8lu us %6lu us/entry\n", op, us, count ? us / count : 0);
+}
+
+void bench(void) {
+  AutoConnectCredential credential;
+  station_config_t  config;
+  std::vector<station_config_t> configs(BENCH_ENTRIES);
+  const uint16_t  base = credential.entries();
+  unsigned long tm;
+
+  Serial.printf("%u entries saved, adding %u\n", base, BENCH_ENTRIES);
+  for (uint16_t n = 0; n < BENCH_ENTRIES; n++)
+    makeEntry(n, &configs[n]);
+
+  tm = micros();
+  bool  rc = credential.saveAll(configs.data(), configs.size());
+  report("saveAll", micros() - tm, BENCH_ENTRIES);
+  if (!rc) {
+    Serial.println("saveAll failed, reduce BENCH_ENTRIES");
+    return;
+  }
+  configs.clear();
+  configs.shrink_to_fit();
+  const uint16_t  total = credential.entries();
+
+  makeEntry(BENCH_ENTRIES / 2, &config);
+  config.bssid[0] = 0x02;
+  tm = micros();
+  credential.save(&config);
+  report("save", micros() - tm, 1);
+
+  makeEntry(BENCH_ENTRIES - 1, &config);
+  tm = micros();
+  int32_t entry = credential.load(reinterpret_cast<const char*>(config.ssid), &config);
+  report("seek", micros() - tm, 1);
+  Serial.printf("%s found at %d\n", reinterpret_cast<const char*>(config.ssid), entry);
+
+  tm = micros();
+  for (uint16_t n = 0; n < total; n++)
+    credential.load(n, &config);
+  report("load", micros() - tm, total);
+
+  uint16_t  count = 0;
+  tm = micros();
+  for (const station_config_t& it : credential) {
+    (void)it;
+    count++;
+  }
+  report("iterate", micros() - tm, count);
+  Serial.printf("%u of %u entries iterated\n", count, total);
+
+  tm = micros();
+  for (uint16_t n = 0; n < BENCH_ENTRIES; n++) {
+    makeEntry(n, &config);
+    credential.del(reinterpret_cast<const char*>(config.ssid));
+  }
+  report("del", micros() - tm, BENCH_ENTRIES);
+  Serial.printf("%u entries left\n", credential.entries());
+}
+
+void setup() {
+  delay(1000);
+  Serial.begin(115200);
+  Serial.println();
+  bench();
+}
+
+void loop() {
+}
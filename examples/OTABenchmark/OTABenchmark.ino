@@ -0,0 +1,98 @@
+/*
+  OTABenchmark.ino, Example for the AutoConnect library.
+  Copyright (c) 2026, Hieromon Ikasamo
+  https://github.com/Hieromon/AutoConnect
+
+  This software is released under the MIT License.
+  https://opensource.org/licenses/MIT
+
+  OTABenchmark.ino measures the throughput of the AutoConnectOTA upload.
+  It times each upload from the start to the end of AutoConnectOTA,
+  which includes receiving the data from the network and writing it
+  through AutoConnectOTABuffer, and reports the throughput on the
+  serial monitor.
+
+  A file whose name does not have the firmware extension is written to
+  the flash filesystem in the same way as the firmware is written to
+  the flash, and the file is removed after each measurement so that the
+  upload can be repeated without rebooting. Run ota_bench.py in this
+  folder to repeat the upload of a file of given size:
+
+    python3 ota_bench.py -s 1048576 -n 10 192.168.4.1
+
+  A firmware upload is measured once, since the module reboots after
+  it. Upload the binary of this sketch with the --firmware option and
+  the result appears on the serial monitor before rebooting:
+
+    python3 ota_bench.py --firmware OTABenchmark.ino.bin 192.168.4.1
+
+  Compare the results by building the library with the following
+  macros defined in the build flags:
+
+    -DAUTOCONNECT_OTA_BUFFERSIZE=0        Write each chunk as it is
+    -DAUTOCONNECT_NOUSE_OTAWRITER         Write the blocks in the loop
+                                          task with a single buffer (ESP32)
+*/
+
+// To properly include the suitable header files to the target platform.
+#if defined(ARDUINO_ARCH_ESP8266)
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+using WiFiWebServer = ESP8266WebServer;
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#include <WebServer.h>
+using WiFiWebServer = WebServer;
+#endif
+
+#include <AutoConnect.h>
+
+// The file name that ota_bench.py uploads.
+#define BENCH_FILE  "/bench.dat"
+
+WiFiWebServer server;
+AutoConnect portal(server);
+AutoConnectConfig config;
+
+unsigned long startTime;  // The upload started
+unsigned int  amount;     // Bytes uploaded
+unsigned int  runs;       // Number of the uploads measured
+bool  failed;             // The upload has failed
+
+void setup() {
+  delay(1000);
+  Serial.begin(115200);
+  Serial.println();
+
+  // The upload is timed from the start to the end of AutoConnectOTA.
+  portal.onOTAStart([]() {
+    amount = 0;
+    failed = false;
+    startTime = millis();
+  });
+  portal.onOTAProgress([](unsigned int total, unsigned int size) {
+    AC_UNUSED(size);
+    amount = total;
+  });
+  portal.onOTAError([](uint8_t err) {
+    failed = true;
+    Serial.printf("OTA error %u\n", err);
+  });
+  portal.onOTAEnd([]() {
+    unsigned long elapsed = millis() - startTime;
+    if (!failed) {
+      // Avoid zero division with a tiny file.
+      float kbps = (float)amount / 1024 / ((elapsed ? elapsed : 1) / 1000.0);
+      Serial.printf("#%u %u bytes in %lu ms, %.1f KB/s\n", ++runs, amount, elapsed, kbps);
+    }
+    AUTOCONNECT_APPLIED_FILESYSTEM.remove(BENCH_FILE);
+  });
+
+  config.ota = AC_OTA_BUILTIN;
+  portal.config(config);
+  portal.begin();
+}
+
+void loop() {
+  portal.handleClient();
+}
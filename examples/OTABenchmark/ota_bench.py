@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+
+"""Upload throughput benchmark for the OTABenchmark example.
+
+Uploads a file of random content to AutoConnectOTA of the OTABenchmark
+sketch repeatedly, and reports the throughput of each upload seen from
+the client. The throughput measured by the device is printed on its
+serial monitor. With --firmware, uploads the given firmware once.
+
+    ota_bench.py [-s SIZE] [-n COUNT] [-p PORT] [--firmware BIN] host
+"""
+
+import argparse
+import os
+import sys
+import time
+import uuid
+import urllib.request
+
+
+def post_file(url, field, filename, content):
+    boundary = uuid.uuid4().hex
+    body = b''.join((
+        '--{0}\r\n'.format(boundary).encode(),
+        'Content-Disposition: form-data; name="{0}"; filename="{1}"\r\n'.format(field, filename).encode(),
+        b'Content-Type: application/octet-stream\r\n\r\n',
+        content,
+        '\r\n--{0}--\r\n'.format(boundary).encode()))
+    request = urllib.request.Request(url, data=body, method='POST')
+    request.add_header('Content-Type', 'multipart/form-data; boundary={0}'.format(boundary))
+    with urllib.request.urlopen(request, timeout=120) as response:
+        return response.read().decode('utf-8', 'replace')
+
+
+def upload(url, filename, content):
+    start = time.monotonic()
+    try:
+        post_file(url, 'bin', filename, content)
+    except OSError as e:
+        sys.exit('Upload failed: {0}'.format(e))
+    return time.monotonic() - start
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Measure the upload throughput of AutoConnectOTA.')
+    parser.add_argument('host', help='Host address of the device')
+    parser.add_argument('--size', '-s', type=int, default=256 * 1024,
+                        help='Size of the file to upload [default:262144]')
+    parser.add_argument('--count', '-n', type=int, default=5,
+                        help='Number of the uploads [default:5]')
+    parser.add_argument('--port', '-p', type=int, default=80,
+                        help='Port of the device [default:80]')
+    parser.add_argument('--firmware', '-f',
+                        help='Upload the firmware binary once instead of the file')
+    args = parser.parse_args()
+
+    url = 'http://{0}:{1}/_ac/update_act'.format(args.host, args.port)
+    if args.firmware:
+        with open(args.firmware, 'rb') as f:
+            content = f.read()
+        elapsed = upload(url, os.path.basename(args.firmware), content)
+        print('firmware {0} bytes in {1:.0f} ms, {2:.1f} KB/s'.format(
+            len(content), elapsed * 1000, len(content) / 1024 / elapsed))
+        sys.exit(0)
+
+    content = os.urandom(args.size)
+    rates = []
+    for n in range(1, args.count + 1):
+        elapsed = upload(url, 'bench.dat', content)
+        rate = args.size / 1024 / elapsed
+        rates.append(rate)
+        print('#{0} {1} bytes in {2:.0f} ms, {3:.1f} KB/s'.format(
+            n, args.size, elapsed * 1000, rate))
+    print('average {0:.1f} KB/s, min {1:.1f} KB/s, max {2:.1f} KB/s'.format(
+        sum(rates) / len(rates), min(rates), max(rates)))
@@ -0,0 +1,188 @@
+/*
+  UploadBenchmark.ino, Example for the AutoConnect library.
+  Copyright (c) 2026, Hieromon Ikasamo
+  https://github.com/Hieromon/AutoConnect
+
+  This software is released under the MIT License.
+  https://opensource.org/licenses/MIT
+
+  UploadBenchmark.ino measures the throughput of the AutoConnectFile
+  built-in upload handler to the SD or the flash filesystem. It times
+  each upload from the start to the end of the handler, which includes
+  receiving the data from the network, and reports the throughput on
+  the result page and the serial monitor. The uploaded file is removed
+  after each measurement so that every run writes a new file.
+
+  Upload the file from the browser, or run upload_bench.py in this
+  folder to repeat the upload of a file of given size:
+
+    python3 upload_bench.py -s 1048576 -n 10 192.168.4.1
+
+  Compare the results by building the library with the following
+  macros defined in the build flags:
+
+    -DAUTOCONNECT_UPLOAD_KEEPMOUNT=true     Keep the media mounted
+    -DAUTOCONNECT_UPLOAD_SD_BUFFERSIZE=0    Write each chunk as it is
+    -DAUTOCONNECT_UPLOAD_FS_BUFFERSIZE=0
+*/
+
+// To properly include the suitable header files to the target platform.
+#if defined(ARDUINO_ARCH_ESP8266)
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#define FORMAT_ON_FAIL
+using WiFiWebServer = ESP8266WebServer;
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#include <WebServer.h>
+#define FORMAT_ON_FAIL  true
+using WiFiWebServer = WebServer;
+#endif
+
+#include <AutoConnect.h>
+
+// Comment out to measure the upload to the flash filesystem.
+#define BENCH_STORE_SD
+
+#ifdef BENCH_STORE_SD
+#include <SPI.h>
+#include <SD.h>
+#define BENCH_STORE "sd"
+#define BenchFS     SD
+#else
+#define BENCH_STORE "fs"
+#ifdef AUTOCONNECT_USE_LITTLEFS
+#include <LittleFS.h>
+#define BenchFS     LittleFS
+#else
+#include <FS.h>
+#include <SPIFFS.h>
+#define BenchFS     SPIFFS
+#endif
+#endif
+
+// Upload request custom Web page
+static const char PAGE_UPLOAD[] PROGMEM = R"(
+{
+  "uri": "/",
+  "title": "Benchmark",
+  "menu": true,
+  "element": [
+    {
+      "name": "caption",
+      "type": "ACText",
+      "value": "<h2>Upload benchmark</h2>"
+    },
+    {
+      "name": "bench_file",
+      "type": "ACFile",
+      "label": "Select file: ",
+      "store": ")" BENCH_STORE R"("
+    },
+    {
+      "name": "upload",
+      "type": "ACSubmit",
+      "value": "UPLOAD",
+      "uri": "/bench"
+    }
+  ]
+}
+)";
+
+// Benchmark result display
+static const char PAGE_RESULT[] PROGMEM = R"(
+{
+  "uri": "/bench",
+  "title": "Benchmark",
+  "menu": false,
+  "element": [
+    {
+      "name": "result",
+      "type": "ACText",
+      "posterior": "br"
+    }
+  ]
+}
+)";
+
+WiFiWebServer server;
+AutoConnect portal(server);
+AutoConnectAux auxUpload;
+AutoConnectAux auxResult;
+
+unsigned long startTime;  // The upload started
+unsigned long elapsed;    // Time taken by the upload
+unsigned int  amount;     // Bytes uploaded
+unsigned int  runs;       // Number of the uploads measured
+
+/**
+ * The result page handler reports the throughput of the upload just
+ * ended and removes the uploaded file.
+ * @param  aux  AutoConnectAux(/bench)
+ * @param  args PageArgument
+ * @return An empty string
+ */
+String postUpload(AutoConnectAux& aux, PageArgument& args) {
+  AC_UNUSED(args);
+  AutoConnectFile&  upload = auxUpload["bench_file"].as<AutoConnectFile>();
+  String  result;
+
+  if (upload.status() == AutoConnectUploadHandler::AC_UPLOAD_END) {
+    // Avoid zero division with a tiny file.
+    float kbps = (float)amount / 1024 / ((elapsed ? elapsed : 1) / 1000.0);
+    result = String(amount) + " bytes in " + String(elapsed) + " ms, " + String(kbps, 1) + " KB/s";
+    Serial.printf("#%u %s: %s\n", ++runs, upload.value.c_str(), result.c_str());
+  }
+  else {
+    result = "Upload failed, status " + String(upload.status());
+    Serial.println(result);
+  }
+  aux["result"].value = result;
+
+  // The upload handler has ended the SD unless it keeps the SD mounted.
+#ifdef BENCH_STORE_SD
+  if (!AUTOCONNECT_UPLOAD_KEEPMOUNT)
+    BenchFS.begin(AUTOCONNECT_SD_CS);
+#endif
+  BenchFS.remove(String("/") + upload.value);
+#ifdef BENCH_STORE_SD
+  if (!AUTOCONNECT_UPLOAD_KEEPMOUNT)
+    BenchFS.end();
+#endif
+  return String();
+}
+
+void setup() {
+  delay(1000);
+  Serial.begin(115200);
+  Serial.println();
+
+#ifndef BENCH_STORE_SD
+  BenchFS.begin(FORMAT_ON_FAIL);
+#endif
+
+  auxUpload.load(PAGE_UPLOAD);
+  auxResult.load(PAGE_RESULT);
+  auxResult.on(postUpload);
+
+  // The upload handler is timed from the start to the end.
+  AutoConnectFile&  upload = auxUpload["bench_file"].as<AutoConnectFile>();
+  upload.onStart([]() {
+    amount = 0;
+    startTime = millis();
+  });
+  upload.onProgress([](unsigned int total, unsigned int size) {
+    AC_UNUSED(size);
+    amount = total;
+  });
+  upload.onEnd([]() {
+    elapsed = millis() - startTime;
+  });
+
+  portal.join({ auxUpload, auxResult });
+  portal.begin();
+}
+
+void loop() {
+  portal.handleClient();
+}
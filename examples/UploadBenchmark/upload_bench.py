@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+
+"""Upload throughput benchmark for the UploadBenchmark example.
+
+Uploads a file of random content to the AutoConnectFile element of the
+UploadBenchmark sketch repeatedly, and reports the throughput of each
+upload seen from the client along with the result page of the device.
+
+    upload_bench.py [-s SIZE] [-n COUNT] [-p PORT] [-u URI] host
+"""
+
+import argparse
+import os
+import re
+import sys
+import time
+import uuid
+import urllib.request
+
+
+def post_file(url, field, filename, content):
+    boundary = uuid.uuid4().hex
+    body = b''.join((
+        '--{0}\r\n'.format(boundary).encode(),
+        'Content-Disposition: form-data; name="{0}"; filename="{1}"\r\n'.format(field, filename).encode(),
+        b'Content-Type: application/octet-stream\r\n\r\n',
+        content,
+        '\r\n--{0}--\r\n'.format(boundary).encode()))
+    request = urllib.request.Request(url, data=body, method='POST')
+    request.add_header('Content-Type', 'multipart/form-data; boundary={0}'.format(boundary))
+    with urllib.request.urlopen(request, timeout=120) as response:
+        return response.read().decode('utf-8', 'replace')
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Measure the upload throughput of AutoConnectFile.')
+    parser.add_argument('host', help='Host address of the device')
+    parser.add_argument('--size', '-s', type=int, default=256 * 1024,
+                        help='Size of the file to upload [default:262144]')
+    parser.add_argument('--count', '-n', type=int, default=5,
+                        help='Number of the uploads [default:5]')
+    parser.add_argument('--port', '-p', type=int, default=80,
+                        help='Port of the device [default:80]')
+    parser.add_argument('--uri', '-u', default='/bench',
+                        help='URI of the result page [default:/bench]')
+    parser.add_argument('--field', '-f', default='bench_file',
+                        help='Name of the AutoConnectFile element [default:bench_file]')
+    args = parser.parse_args()
+
+    url = 'http://{0}:{1}{2}'.format(args.host, args.port, args.uri)
+    content = os.urandom(args.size)
+    rates = []
+    for n in range(1, args.count + 1):
+        start = time.monotonic()
+        try:
+            page = post_file(url, args.field, 'bench.bin', content)
+        except OSError as e:
+            sys.exit('Upload failed: {0}'.format(e))
+        elapsed = time.monotonic() - start
+        rate = args.size / 1024 / elapsed
+        rates.append(rate)
+        device = re.search(r'\d+ bytes in \d+ ms, [\d.]+ KB/s|Upload failed[^<]*', page)
+        print('#{0} {1} bytes in {2:.0f} ms, {3:.1f} KB/s (device: {4})'.format(
+            n, args.size, elapsed * 1000, rate, device.group(0) if device else 'no result'))
+    print('average {0:.1f} KB/s, min {1:.1f} KB/s, max {2:.1f} KB/s'.format(
+        sum(rates) / len(rates), min(rates), max(rates)))
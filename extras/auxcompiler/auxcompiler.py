@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""AutoConnectAux JSON compiler.
+
+Compiles the JSON definition of AutoConnectAux pages into a C++ header
+which holds the page and the element descriptors in PROGMEM. A sketch
+loads the compiled page with AutoConnectAux::load(const ACPageDesc_t&)
+that builds the elements directly from flash without parsing JSON.
+
+    auxcompiler.py [-n NAME] [-o OUTPUT] input.json
+
+Copyright (c) 2026 Hieromon Ikasamo.
+This software is released under the MIT License.
+https://opensource.org/licenses/MIT
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+__version__ = '1.0.0'
+
+# Element types and the attribute values, which are accepted as well as
+# AutoConnectAux::_asElementType and each loadMember do.
+TYPES = {
+    'acbutton': 'AC_Button',
+    'accheckbox': 'AC_Checkbox',
+    'acelement': 'AC_Element',
+    'acfile': 'AC_File',
+    'acinput': 'AC_Input',
+    'acradio': 'AC_Radio',
+    'acrange': 'AC_Range',
+    'acselect': 'AC_Select',
+    'acstyle': 'AC_Style',
+    'acsubmit': 'AC_Submit',
+    'actext': 'AC_Text'
+}
+POSTERIOR = {'none': 'AC_Tag_None', 'br': 'AC_Tag_BR', 'par': 'AC_Tag_P', 'div': 'AC_Tag_DIV'}
+POSITION = {'infront': 'AC_Infront', 'behind': 'AC_Behind', 'void': 'AC_Void'}
+OPTIONS = {
+    'AC_Checkbox': ('labelposition', {k: POSITION[k] for k in ('infront', 'behind')}),
+    'AC_File': ('store', {'fs': 'AC_File_FS', 'sd': 'AC_File_SD', 'extern': 'AC_File_Extern'}),
+    'AC_Input': ('apply', {'text': 'AC_Input_Text', 'password': 'AC_Input_Password', 'number': 'AC_Input_Number'}),
+    'AC_Radio': ('arrange', {'vertical': 'AC_Vertical', 'horizontal': 'AC_Horizontal'}),
+    'AC_Range': ('magnify', POSITION)
+}
+# The type-specific string held by the peculiar of ACElementDesc_t, which
+# holds the items instead for Radio and Select.
+PECULIAR = {'AC_Button': 'action', 'AC_Input': 'pattern', 'AC_Submit': 'uri', 'AC_Text': 'format'}
+AUTH = {'none': 'AC_AUTH_NONE', 'digest': 'AC_AUTH_DIGEST', 'basic': 'AC_AUTH_BASIC'}
+
+
+class CompileError(Exception):
+    pass
+
+
+def as_string(value):
+    """Stringify a JSON value as ArduinoJson as<String>() does."""
+    if isinstance(value, str):
+        return value
+    if isinstance(value, bool):
+        return 'true' if value else 'false'
+    if value is None:
+        return 'null'
+    if isinstance(value, (int, float)):
+        return json.dumps(value)
+    return json.dumps(value, separators=(',', ':'), ensure_ascii=False)
+
+
+def as_int(value):
+    """Convert a JSON value as ArduinoJson as<int>() does."""
+    if isinstance(value, bool):
+        return int(value)
+    if isinstance(value, (int, float)):
+        return int(value)
+    if isinstance(value, str):
+        m = re.match(r'\s*[-+]?\d+', value)
+        return int(m.group(0)) if m else 0
+    return 0
+
+
+def as_bool(value):
+    """Convert a JSON value as ArduinoJson as<bool>() does."""
+    if isinstance(value, bool):
+        return value
+    if isinstance(value, (int, float)):
+        return value != 0
+    return False
+
+
+def c_string(text):
+    """Quote a string as a C string literal. Octal escapes are used for
+    control characters since they never absorb the following digit."""
+    out = []
+    for c in text:
+        if c in '\\"':
+            out.append('\\' + c)
+        elif c == '\n':
+            out.append('\\n')
+        elif c == '\t':
+            out.append('\\t')
+        elif ord(c) < 0x20 or ord(c) == 0x7f:
+            out.append('\\%03o' % ord(c))
+        else:
+            out.append(c)
+    return '"' + ''.join(out) + '"'
+
+
+class Compiler:
+    def __init__(self, name):
+        self.name = name
+        self.strings = {}       # Literal text to the PROGMEM identifier
+        self.lines = []
+
+    def string(self, text, items=None):
+        """Register a PROGMEM string and return its identifier. The items
+        are stored NUL-separated in a single array."""
+        if items is not None:
+            literal = ' '.join(c_string(item + '\0') for item in items) if items else '""'
+        else:
+            literal = c_string(text)
+        if literal not in self.strings:
+            ident = '%s_s%d' % (self.name, len(self.strings))
+            self.strings[literal] = ident
+            self.lines.append('static const char %s[] PROGMEM = %s;' % (ident, literal))
+        return self.strings[literal]
+
+    def optional(self, obj, key):
+        return self.string(as_string(obj[key])) if key in obj else 'nullptr'
+
+    def element(self, elm, where):
+        if not isinstance(elm, dict):
+            raise CompileError('%s: element must be an object' % where)
+        name = as_string(elm.get('name', ''))
+        if not name or name == 'null':
+            raise CompileError('%s: element name missing' % where)
+        where = '%s.%s' % (where, name)
+        type_name = str(elm.get('type', '')).lower()
+        if type_name not in TYPES:
+            raise CompileError('%s: unknown element type \'%s\'' % (where, elm.get('type')))
+        etype = TYPES[type_name]
+
+        attr = []
+        value = label = peculiar = placeholder = style = 'nullptr'
+        items = 0
+        post = option = checked = 0
+        is_global = 'false'
+        ranges = [0, 0, 0, 0]
+
+        items_key = {'AC_Radio': 'value', 'AC_Select': 'option'}.get(etype)
+        if items_key and items_key in elm:
+            if not isinstance(elm[items_key], list):
+                raise CompileError('%s: %s must be an array' % (where, items_key))
+            entries = [as_string(v) for v in elm[items_key]]
+            peculiar = self.string(None, entries)
+            items = len(entries)
+            attr.append('AC_DESC_ITEMS')
+        if 'value' in elm and items_key != 'value':
+            value = self.string(as_string(elm['value']))
+        if 'posterior' in elm:
+            key = as_string(elm['posterior']).lower()
+            if key in POSTERIOR:
+                post = POSTERIOR[key]
+                attr.append('AC_DESC_POST')
+            else:
+                print('Warning %s unknown posterior \'%s\'' % (where, elm['posterior']), file=sys.stderr)
+        if 'global' in elm:
+            is_global = 'true' if as_bool(elm['global']) else 'false'
+            attr.append('AC_DESC_GLOBAL')
+        if etype in ('AC_Checkbox', 'AC_File', 'AC_Input', 'AC_Radio', 'AC_Range', 'AC_Select'):
+            label = self.optional(elm, 'label')
+        if etype in PECULIAR:
+            peculiar = self.optional(elm, PECULIAR[etype])
+        if etype == 'AC_Input':
+            placeholder = self.optional(elm, 'placeholder')
+        if etype in ('AC_Input', 'AC_Range', 'AC_Text'):
+            style = self.optional(elm, 'style')
+        if etype in OPTIONS:
+            key, values = OPTIONS[etype]
+            if key in elm:
+                opt = as_string(elm[key]).lower()
+                if opt not in values:
+                    raise CompileError('%s: unknown %s \'%s\'' % (where, key, elm[key]))
+                option = values[opt]
+                attr.append('AC_DESC_OPTION')
+        checked_key = {'AC_Checkbox': 'checked', 'AC_Radio': 'checked', 'AC_Select': 'selected'}.get(etype)
+        if checked_key and checked_key in elm:
+            if etype == 'AC_Checkbox':
+                checked = int(as_bool(elm[checked_key]))
+            else:
+                checked = as_int(elm[checked_key]) & 0xff
+            attr.append('AC_DESC_CHECKED')
+        if etype == 'AC_Range':
+            for n, (key, bit) in enumerate((('value', 'AC_DESC_VALUE'), ('min', 'AC_DESC_MIN'), ('max', 'AC_DESC_MAX'), ('step', 'AC_DESC_STEP'))):
+                if key in elm:
+                    ranges[n] = as_int(elm[key])
+                    attr.append(bit)
+
+        return '  { %s, %s, %s, %s, %s, %s, %s, %d, %s, %s, %s, %s, %s, { %s } }' % (
+            etype, self.string(name), value, label, peculiar, placeholder, style, items,
+            ' | '.join('AutoConnectAux::' + a for a in attr) if attr else '0', post, option, checked, is_global,
+            ', '.join(str(r) for r in ranges))
+
+    def page(self, page, ident):
+        if not isinstance(page, dict):
+            raise CompileError('%s: page must be an object' % ident)
+        elements = page.get('element', [])
+        if isinstance(elements, dict):
+            elements = [elements]
+        descs = [self.element(elm, ident) for elm in elements]
+        elm_ident = ident + '_elm'
+        if descs:
+            self.lines.append('static const AutoConnectAux::ACElementDesc_t %s[] PROGMEM = {' % elm_ident)
+            self.lines.append(',\n'.join(descs))
+            self.lines.append('};')
+
+        attr = []
+        flags = {}
+        for key, bit in (('menu', 'AC_DESC_MENU'), ('cors', 'AC_DESC_CORS'), ('response', 'AC_DESC_RESPONSE')):
+            flags[key] = 'false'
+            if key in page:
+                flags[key] = 'true' if as_bool(page[key]) else 'false'
+                attr.append(bit)
+        auth = AUTH.get(as_string(page.get('auth', '')).lower())
+        if auth:
+            attr.append('AC_DESC_AUTH')
+        return '{ %s, %s, %s, %s, %s, %s, %s, %d, %s }' % (
+            self.optional(page, 'uri'), self.optional(page, 'title'),
+            ' | '.join('AutoConnectAux::' + a for a in attr) if attr else '0', flags['menu'], flags['cors'], flags['response'],
+            auth or 'AC_AUTH_NONE', len(descs), elm_ident if descs else 'nullptr')
+
+    def compile(self, doc):
+        if isinstance(doc, list):
+            pages = [self.page(page, '%s_%d' % (self.name, n)) for n, page in enumerate(doc)]
+            self.lines.append('static const AutoConnectAux::ACPageDesc_t %s[] PROGMEM = {' % self.name)
+            self.lines.append(',\n'.join('  ' + page for page in pages))
+            self.lines.append('};')
+        else:
+            page = self.page(doc, self.name)
+            self.lines.append('static const AutoConnectAux::ACPageDesc_t %s PROGMEM = %s;' % (self.name, page))
+        return self.lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compile AutoConnectAux JSON into PROGMEM page descriptors.')
+    parser.add_argument('input', help='JSON file that defines AutoConnectAux pages')
+    parser.add_argument('-n', '--name', help='identifier of the page descriptor (default: the input file name)')
+    parser.add_argument('-o', '--output', help='output header file (default: stdout)')
+    parser.add_argument('--version', action='version', version='%(prog)s ' + __version__)
+    args = parser.parse_args()
+
+    name = args.name or re.sub(r'\W', '_', os.path.splitext(os.path.basename(args.input))[0])
+    if not re.match(r'^[A-Za-z_]\w*$', name):
+        parser.error('invalid identifier: ' + name)
+    try:
+        with open(args.input, encoding='utf-8') as f:
+            doc = json.load(f)
+        lines = Compiler(name).compile(doc)
+    except (OSError, ValueError, CompileError) as e:
+        print('%s: %s' % (args.input, e), file=sys.stderr)
+        return 1
+
+    guard = '_%s_H_' % name.upper()
+    header = [
+        '// Compiled from %s by auxcompiler.py %s, do not edit.' % (os.path.basename(args.input), __version__),
+        '#ifndef %s' % guard,
+        '#define %s' % guard,
+        '',
+        '#include <AutoConnect.h>',
+        ''
+    ] + lines + ['', '#endif  // %s' % guard, '']
+    text = '\n'.join(header)
+    if args.output:
+        with open(args.output, 'w', encoding='utf-8') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
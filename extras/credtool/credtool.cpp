@@ -0,0 +1,273 @@
+/**
+ * Host tool to generate the AutoConnect credential image for flashing.
+ * It is built from AutoConnectCredential.cpp of the library as it is,
+ * so the generated image has the same layout as the one saved on the
+ * device. The generated image is reloaded through the same parser to
+ * verify all entries before it is written out.
+ * @file credtool.cpp
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "AutoConnectCredential.h"
+
+namespace credtool {
+std::vector<uint8_t> eeprom;
+std::map<std::string, std::vector<uint8_t>>  nvs;
+}
+
+/**
+ * Split a line of CSV into fields. A field enclosed in double quotes
+ * can contain commas, and "" in it is a double quote.
+ * @param  line  A line of CSV.
+ * @return Fields.
+ */
+static std::vector<std::string> splitCSV(const std::string& line) {
+  std::vector<std::string>  fields(1);
+  bool  quoted = false;
+
+  for (size_t i = 0; i < line.size(); i++) {
+    char  c = line[i];
+    if (quoted) {
+      if (c == '"') {
+        if (i + 1 < line.size() && line[i + 1] == '"')
+          fields.back() += line[++i];
+        else
+          quoted = false;
+      }
+      else
+        fields.back() += c;
+    }
+    else if (c == '"')
+      quoted = true;
+    else if (c == ',')
+      fields.emplace_back();
+    else if (c != '\r')
+      fields.back() += c;
+  }
+  return fields;
+}
+
+/**
+ * Parse an IPv4 address in dotted decimal into the uint32_t as the
+ * IPAddress holds, the first octet is the lowest byte.
+ * @param  str   IP address string.
+ * @param  addr  Parsed address.
+ * @return true  Parsed.
+ */
+static bool parseIP(const std::string& str, uint32_t* addr) {
+  unsigned int  o[4];
+  char  tail;
+  if (sscanf(str.c_str(), "%u.%u.%u.%u%c", &o[0], &o[1], &o[2], &o[3], &tail) != 4)
+    return false;
+  *addr = 0;
+  for (int i = 3; i >= 0; i--) {
+    if (o[i] > 255)
+      return false;
+    *addr = (*addr << 8) | o[i];
+  }
+  return true;
+}
+
+/**
+ * Parse a BSSID in the form of xx:xx:xx:xx:xx:xx.
+ * @param  str    BSSID string.
+ * @param  bssid  Parsed BSSID.
+ * @return true   Parsed.
+ */
+static bool parseBSSID(const std::string& str, uint8_t* bssid) {
+  unsigned int  b[6];
+  char  tail;
+  if (sscanf(str.c_str(), "%x:%x:%x:%x:%x:%x%c", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &tail) != 6)
+    return false;
+  for (int i = 0; i < 6; i++) {
+    if (b[i] > 255)
+      return false;
+    bssid[i] = static_cast<uint8_t>(b[i]);
+  }
+  return true;
+}
+
+/**
+ * Read the credential list. Each line is
+ * ssid,password[,bssid[,ip,gateway,netmask[,dns1[,dns2]]]]
+ * Empty lines and lines beginning with # are ignored. Specifying the ip
+ * makes the entry a static IP configuration.
+ * @param  in       Input stream of the list.
+ * @param  configs  Parsed credentials. A later entry of the same SSID replaces the earlier one.
+ * @return true     All lines parsed.
+ */
+static bool readList(std::istream& in, std::vector<station_config_t>& configs) {
+  std::string line;
+  int   ln = 0;
+
+  while (std::getline(in, line)) {
+    ln++;
+    if (line.empty() || line[0] == '#' || line == "\r")
+      continue;
+    std::vector<std::string>  f = splitCSV(line);
+    station_config_t  config;
+    memset(&config, 0x00, sizeof(station_config_t));
+
+    if (f.size() < 2 || f.size() > 8 || f[0].empty() ||
+        f[0].size() > sizeof(station_config_t::ssid) || f[1].size() >= sizeof(station_config_t::password)) {
+      std::cerr << "line " << ln << ": invalid ssid or password" << std::endl;
+      return false;
+    }
+    memcpy(config.ssid, f[0].data(), f[0].size());
+    memcpy(config.password, f[1].data(), f[1].size());
+    if (f.size() > 2 && !f[2].empty() && !parseBSSID(f[2], config.bssid)) {
+      std::cerr << "line " << ln << ": invalid bssid " << f[2] << std::endl;
+      return false;
+    }
+    config.dhcp = STA_DHCP;
+    if (f.size() > 3 && !f[3].empty()) {
+      config.dhcp = STA_STATIC;
+      for (size_t e = 3; e < f.size(); e++) {
+        if (!f[e].empty() && !parseIP(f[e], &config.config.addr[e - 3])) {
+          std::cerr << "line " << ln << ": invalid address " << f[e] << std::endl;
+          return false;
+        }
+      }
+    }
+
+    for (auto it = configs.begin(); it != configs.end(); ++it) {
+      if (!strncmp(reinterpret_cast<const char*>(it->ssid), reinterpret_cast<const char*>(config.ssid), sizeof(station_config_t::ssid))) {
+        std::cerr << "line " << ln << ": " << f[0] << " replaces the earlier entry" << std::endl;
+        configs.erase(it);
+        break;
+      }
+    }
+    configs.push_back(config);
+  }
+  return true;
+}
+
+/**
+ * Reload the generated image through AutoConnectCredential and compare
+ * every entry with the source credentials. The bytes following the
+ * terminator of the password are not compared since the loader leaves
+ * them as they are.
+ * @param  configs  Source credentials.
+ * @param  offset   Offset of the credential area in the EEPROM.
+ * @return true     All entries matched.
+ */
+static bool verify(const std::vector<station_config_t>& configs, const uint16_t offset) {
+  AutoConnectCredential credential(offset);
+  bool  rc = credential.entries() == configs.size();
+
+  if (!rc)
+    std::cerr << "verify: " << credential.entries() << " entries loaded, expected " << configs.size() << std::endl;
+  for (const station_config_t& config : configs) {
+    char  ssid[sizeof(station_config_t::ssid) + 1] = { '\0' };
+    station_config_t  loaded;
+    memcpy(ssid, config.ssid, sizeof(station_config_t::ssid));
+    memset(&loaded, 0x00, sizeof(station_config_t));
+    if (credential.load(ssid, &loaded) < 0 ||
+        strncmp(reinterpret_cast<const char*>(loaded.password), reinterpret_cast<const char*>(config.password), sizeof(station_config_t::password)) ||
+        memcmp(loaded.bssid, config.bssid, sizeof(station_config_t::bssid)) ||
+        loaded.dhcp != config.dhcp ||
+        memcmp(&loaded.config, &config.config, sizeof(station_config_t::_config))) {
+      std::cerr << "verify: " << ssid << " mismatched" << std::endl;
+      rc = false;
+    }
+  }
+  return rc;
+}
+
+static void usage(const char* name) {
+  std::cerr << "usage: " << name
+#if AC_CREDENTIAL_PREFERENCES == 0
+            << " [-b boundary_offset] [-s eeprom_size]"
+#endif
+            << " list.csv image.bin" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  uint16_t  offset = AC_IDENTIFIER_OFFSET;
+  size_t    eepromSize = 4096;
+  int  an = 1;
+
+  for (; an < argc && argv[an][0] == '-' && argv[an][1] != '\0'; an++) {
+    std::string opt = argv[an];
+    if (an + 1 >= argc) {
+      usage(argv[0]);
+      return 2;
+    }
+#if AC_CREDENTIAL_PREFERENCES == 0
+    if (opt == "-b")
+      offset = static_cast<uint16_t>(strtoul(argv[++an], nullptr, 0));
+    else if (opt == "-s")
+      eepromSize = strtoul(argv[++an], nullptr, 0);
+    else
+#endif
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (argc - an != 2) {
+    usage(argv[0]);
+    return 2;
+  }
+  const std::string listPath = argv[an];
+  const std::string imagePath = argv[an + 1];
+
+  std::vector<station_config_t> configs;
+  std::ifstream list(listPath);
+  if (!list) {
+    std::cerr << listPath << ": cannot open" << std::endl;
+    return 1;
+  }
+  if (!readList(list, configs))
+    return 1;
+
+  // The EEPROM image starts in the erased state.
+  credtool::eeprom.assign(eepromSize, 0xff);
+  {
+    AutoConnectCredential credential(offset);
+    if (!credential.saveAll(configs.data(), configs.size())) {
+      std::cerr << "cannot store " << configs.size() << " credentials" << std::endl;
+      return 1;
+    }
+  }
+  if (!verify(configs, offset))
+    return 1;
+
+  std::ofstream image(imagePath, std::ios::binary);
+#if AC_CREDENTIAL_PREFERENCES == 0
+  AutoConnectCredential credential(offset);
+  if (offset + credential.dataSize() > eepromSize) {
+    std::cerr << "credentials exceed the EEPROM size " << eepromSize << std::endl;
+    return 1;
+  }
+  image.write(reinterpret_cast<const char*>(credtool::eeprom.data()), credtool::eeprom.size());
+#else
+  const std::vector<uint8_t>& blob = credtool::nvs[AC_CREDENTIAL_NVSNAME "/" AC_CREDENTIAL_NVSKEY];
+  image.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+
+  // Emit the CSV for nvs_partition_gen.py of ESP-IDF.
+  std::ofstream csv(imagePath + ".csv");
+  csv << "key,type,encoding,value\n"
+      << AC_CREDENTIAL_NVSNAME ",namespace,,\n"
+      << AC_CREDENTIAL_NVSKEY ",file,binary," << imagePath << "\n";
+  if (!csv) {
+    std::cerr << imagePath << ".csv: write failed" << std::endl;
+    return 1;
+  }
+#endif
+  if (!image) {
+    std::cerr << imagePath << ": write failed" << std::endl;
+    return 1;
+  }
+  std::cout << configs.size() << " credentials written to " << imagePath << std::endl;
+  return 0;
+}
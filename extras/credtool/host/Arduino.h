@@ -0,0 +1,75 @@
+/**
+ * Minimal Arduino core shim to build AutoConnectCredential on the host.
+ * @file Arduino.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _CREDTOOL_ARDUINO_H_
+#define _CREDTOOL_ARDUINO_H_
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define PROGMEM
+#define PGM_P       const char*
+#define PSTR(s)     (s)
+#define F(s)        (s)
+
+inline void delay(unsigned long ms) { (void)(ms); }
+
+/** A subset of WString backed by std::string */
+class String {
+ public:
+  String() {}
+  String(const char* s) : _s(s ? s : "") {}
+  const char* c_str(void) const { return _s.c_str(); }
+  unsigned int length(void) const { return static_cast<unsigned int>(_s.length()); }
+  void toCharArray(char* buf, unsigned int size) const {
+    if (size) {
+      size_t  len = _s.copy(buf, size - 1);
+      buf[len] = '\0';
+    }
+  }
+  bool operator<(const String& rhs) const { return _s < rhs._s; }
+  bool operator==(const String& rhs) const { return _s == rhs._s; }
+
+ private:
+  std::string _s;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t size) {
+    size_t  n = 0;
+    while (size--)
+      n += write(*buf++);
+    return n;
+  }
+  size_t write(const char* buf, size_t size) { return write(reinterpret_cast<const uint8_t*>(buf), size); }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available(void) = 0;
+  virtual int read(void) = 0;
+  virtual int peek(void) = 0;
+  size_t readBytes(char* buf, size_t size) {
+    size_t  n = 0;
+    int     c;
+    while (n < size && (c = read()) >= 0)
+      buf[n++] = static_cast<char>(c);
+    return n;
+  }
+  size_t readBytes(uint8_t* buf, size_t size) { return readBytes(reinterpret_cast<char*>(buf), size); }
+};
+
+#endif  // _CREDTOOL_ARDUINO_H_
@@ -0,0 +1,52 @@
+/**
+ * EEPROM shim that maps the EEPROMClass onto the image to be generated.
+ * @file EEPROM.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _CREDTOOL_EEPROM_H_
+#define _CREDTOOL_EEPROM_H_
+
+#include <algorithm>
+#include <vector>
+#include "Arduino.h"
+
+namespace credtool {
+extern std::vector<uint8_t> eeprom;   /**< The EEPROM sector image */
+}
+
+class EEPROMClass {
+ public:
+  // The area beyond the image reads as erased and fails to commit.
+  bool begin(size_t size) {
+    size_t  len = std::min(size, credtool::eeprom.size());
+    _data.assign(credtool::eeprom.begin(), credtool::eeprom.begin() + len);
+    _data.resize(size, 0xff);
+    return true;
+  }
+  uint8_t read(int address) { return address < static_cast<int>(_data.size()) ? _data[address] : 0xff; }
+  void write(int address, uint8_t value) {
+    if (address < static_cast<int>(_data.size()))
+      _data[address] = value;
+  }
+  bool commit(void) {
+    if (_data.size() > credtool::eeprom.size())
+      return false;
+    std::copy(_data.begin(), _data.end(), credtool::eeprom.begin());
+    return true;
+  }
+  void end(void) { _data.clear(); }
+  template<typename T>
+  T& get(int address, T& t) {
+    memcpy(&t, _data.data() + address, sizeof(T));
+    return t;
+  }
+
+ private:
+  std::vector<uint8_t>  _data;
+};
+
+#endif  // _CREDTOOL_EEPROM_H_
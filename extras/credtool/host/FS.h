@@ -0,0 +1,29 @@
+/**
+ * File system shim to satisfy AutoConnectFS.h on the host.
+ * @file FS.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _CREDTOOL_FS_H_
+#define _CREDTOOL_FS_H_
+
+struct FSInfo {};
+
+namespace fs {
+class FS {
+ public:
+  bool info(FSInfo& info) { (void)(info); return false; }
+};
+class SPIFFSFS : public FS {};
+class LittleFSFS : public FS {};
+class SDFS : public FS {};
+}
+
+class File {};
+class SDFile {};
+class SDClass {};
+
+#endif  // _CREDTOOL_FS_H_
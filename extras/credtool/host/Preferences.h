@@ -0,0 +1,51 @@
+/**
+ * Preferences shim that keeps the NVS blobs in memory.
+ * @file Preferences.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _CREDTOOL_PREFERENCES_H_
+#define _CREDTOOL_PREFERENCES_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+namespace credtool {
+extern std::map<std::string, std::vector<uint8_t>>  nvs;  /**< namespace/key and blob */
+}
+
+class Preferences {
+ public:
+  bool begin(const char* name, bool readOnly = false) {
+    (void)(readOnly);
+    _name = name;
+    return true;
+  }
+  void end(void) {}
+  size_t getBytesLength(const char* key) {
+    auto  it = credtool::nvs.find(_name + '/' + key);
+    return it != credtool::nvs.end() ? it->second.size() : 0;
+  }
+  size_t getBytes(const char* key, void* buf, size_t len) {
+    auto  it = credtool::nvs.find(_name + '/' + key);
+    if (it == credtool::nvs.end() || len < it->second.size())
+      return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+  size_t putBytes(const char* key, const void* value, size_t len) {
+    const uint8_t*  bp = static_cast<const uint8_t*>(value);
+    credtool::nvs[_name + '/' + key].assign(bp, bp + len);
+    return len;
+  }
+
+ private:
+  std::string _name;
+};
+
+#endif  // _CREDTOOL_PREFERENCES_H_
@@ -0,0 +1 @@
+#include "FS.h"
@@ -0,0 +1 @@
+inline bool esp_spiffs_mounted(const char* label) { (void)(label); return false; }
@@ -0,0 +1,10 @@
+#ifndef _CREDTOOL_NVS_H_
+#define _CREDTOOL_NVS_H_
+// AutoConnectCredential refers to the nvs API only if Preferences lacks
+// getBytesLength, which the Preferences shim has.
+typedef int esp_err_t;
+#define NVS_READONLY  0
+inline esp_err_t nvs_open(const char*, int, uint32_t*) { return -1; }
+inline esp_err_t nvs_get_blob(uint32_t, const char*, void*, size_t*) { return -1; }
+inline void nvs_close(uint32_t) {}
+#endif  // _CREDTOOL_NVS_H_
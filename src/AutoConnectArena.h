@@ -0,0 +1,122 @@
+/**
+ * Declaration of AutoConnectArena class, an allocator that places the
+ * objects in a few blocks and releases them all at once.
+ * @file AutoConnectArena.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTARENA_H_
+#define _AUTOCONNECTARENA_H_
+
+#include <algorithm>
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+#include "AutoConnectDefs.h"
+
+/**
+ * AutoConnectArena constructs the objects in the blocks that it takes
+ * from the heap, and destructs them in the reverse order of creation
+ * when cleared. The objects cannot be freed individually. Since the
+ * objects that are released together are adjacent in the blocks, the
+ * heap has no holes left between the allocations that survive them.
+ */
+class AutoConnectArena {
+ public:
+  explicit AutoConnectArena(const size_t blockSize = AUTOCONNECT_AUXARENA_BLOCKSIZE) : _blockSize(blockSize), _blocks(nullptr), _finalizers(nullptr) {}
+  AutoConnectArena(const AutoConnectArena&) = delete;
+  AutoConnectArena& operator=(const AutoConnectArena&) = delete;
+  ~AutoConnectArena() { clear(); }
+
+  /**
+   * Construct an object of the type in the arena.
+   * @param  T  Type of the object to be constructed.
+   * @return A pointer of the constructed object, nullptr if the arena
+   * could not take a block from the heap.
+   */
+  template<typename T>
+  T* create(void) {
+    _Finalizer* finalizer = static_cast<_Finalizer*>(allocate(sizeof(_Finalizer), alignof(_Finalizer)));
+    void* storage = finalizer ? allocate(sizeof(T), alignof(T)) : nullptr;
+    if (!storage)
+      return nullptr;
+    T* obj = new (storage) T;
+    finalizer->obj = obj;
+    finalizer->destroy = &_destroy<T>;
+    finalizer->prev = _finalizers;
+    _finalizers = finalizer;
+    return obj;
+  }
+
+  /**
+   * Allocate the storage from the current block. If the block has no
+   * room, a new block is taken from the heap, which is sized to the
+   * storage if it exceeds the block size.
+   * @param  size   Size of the storage.
+   * @param  align  Alignment of the storage.
+   * @return A pointer of the storage, nullptr if the heap is exhausted.
+   */
+  void* allocate(const size_t size, const size_t align) {
+    if (_blocks) {
+      uintptr_t top = _align(reinterpret_cast<uintptr_t>(_blocks->data()) + _blocks->used, align);
+      if (top + size <= reinterpret_cast<uintptr_t>(_blocks->data()) + _blocks->size) {
+        _blocks->used = top + size - reinterpret_cast<uintptr_t>(_blocks->data());
+        return reinterpret_cast<void*>(top);
+      }
+    }
+    const size_t  blockSize = std::max(_blockSize, size + align);
+    _Block* block = static_cast<_Block*>(malloc(sizeof(_Block) + blockSize));
+    if (!block) {
+      AC_DBG("Arena %u bytes exhausted\n", (unsigned int)blockSize);
+      return nullptr;
+    }
+    block->next = _blocks;
+    block->size = blockSize;
+    block->used = 0;
+    _blocks = block;
+    return allocate(size, align);
+  }
+
+  /**
+   * Destruct all objects in the reverse order of creation and return
+   * the blocks to the heap.
+   */
+  void clear(void) {
+    while (_finalizers) {
+      _finalizers->destroy(_finalizers->obj);
+      _finalizers = _finalizers->prev;
+    }
+    while (_blocks) {
+      _Block* next = _blocks->next;
+      free(_blocks);
+      _blocks = next;
+    }
+  }
+
+ protected:
+  typedef struct _Block {
+    struct _Block*  next; /**< The block taken earlier */
+    size_t  size;         /**< Size of the storage area */
+    size_t  used;         /**< Bytes in use from the top of the storage */
+    uint8_t* data(void) { return reinterpret_cast<uint8_t*>(this + 1); }
+  } _Block;
+
+  typedef struct _Finalizer {
+    struct _Finalizer*  prev;   /**< The finalizer of the object created earlier */
+    void* obj;                  /**< The object to be destructed */
+    void  (*destroy)(void*);    /**< Destructor of the object type */
+  } _Finalizer;
+
+  template<typename T>
+  static void _destroy(void* obj) { static_cast<T*>(obj)->~T(); }
+  static uintptr_t _align(const uintptr_t addr, const size_t align) { return (addr + align - 1) & ~static_cast<uintptr_t>(align - 1); }
+
+  size_t  _blockSize;       /**< Size of the block to be taken from the heap */
+  _Block* _blocks;          /**< The latest block */
+  _Finalizer* _finalizers;  /**< The finalizer of the latest object */
+};
+
+#endif // !_AUTOCONNECTARENA_H_
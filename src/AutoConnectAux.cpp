@@ -114,12 +114,7 @@ const char AutoConnectAux::_PAGE_SCRIPT_FE[] PROGMEM = {
       "if (res.status!==200) {"
         "throw `response.status:${res.status} ${res.statusText}`;"
       "}"
-      "const json=await res.json();"
-      "json.forEach(re=>{"
-        "let elm=document.getElementById(re.id);"
-        "if (elm!==null)"
-          "_ite(elm, re);"
-      "});"
+      "_re(await res.json());"
       "return true;"
     "} catch (e) {"
 #ifdef AC_DEBUG
@@ -128,6 +123,16 @@ const char AutoConnectAux::_PAGE_SCRIPT_FE[] PROGMEM = {
       "console.log(e);"
     "}"
   "}"
+};
+
+const char AutoConnectAux::_PAGE_SCRIPT_RE[] PROGMEM = {
+  "function _re(json) {"
+    "json.forEach(re=>{"
+      "let elm=document.getElementById(re.id);"
+      "if (elm!==null)"
+        "_ite(elm, re);"
+    "});"
+  "}"
   "function _ite(tag, elr) {"
     "for (const prop in elr) {"
       "if (prop!=='id') {"
@@ -139,6 +144,22 @@ const char AutoConnectAux::_PAGE_SCRIPT_FE[] PROGMEM = {
   "}"
 };
 
+#ifdef AUTOCONNECT_USE_AUXEVENT
+const char AutoConnectAux::_PAGE_SCRIPT_ES[] PROGMEM = {
+  "function _es(uri) {"
+    "const es=new EventSource('" AUTOCONNECT_URI_EVENT "?" AUTOCONNECT_AUXURI_PARAM "='+encodeURIComponent(uri));"
+    "es.onmessage=e=>{"
+      "try {"
+        "_re(JSON.parse(e.data));"
+      "}"
+      "catch(e) {"
+        "console.log(e);"
+      "}"
+    "};"
+  "}"
+};
+#endif
+
 /**
  * AutoConnectAux default constructor.
  * @param uri     URI of the page.
@@ -166,6 +187,9 @@ AutoConnectAux::AutoConnectAux(const String& uri, const String& title, const boo
  */
 AutoConnectAux::~AutoConnectAux() {
   _addonElm.clear();
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  _elmIndex.clear();
+#endif
 }
 
 /**
@@ -183,7 +207,16 @@ AutoConnectElement& AutoConnectAux::_nullElement() {
  * @param  addon A reference of AutoConnectElement.
  */
 void AutoConnectAux::add(AutoConnectElement& addon) {
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  _currentGeneration();
+#endif
   _addonElm.push_back(addon);
+  _generation++;
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  if (_exposed)
+    _exposedPrint = _printElements();
+  _indexElement(addon);
+#endif
   AC_DBG("%s placed on %s\n", addon.name.length() ? addon.name.c_str() : "*noname", uri());
 }
 
@@ -206,15 +239,11 @@ void AutoConnectAux::fetchElement(void) {
     _ac->_auxUri = _webServer->arg(String(F(AUTOCONNECT_AUXURI_PARAM)));
     _ac->_auxUri.replace("&#47;", "/");
     AC_DBG("fetch %s", _ac->_auxUri.c_str());
-    AutoConnectAux* aux = _ac->_aux;
-    while (aux) {
-      if (aux->_uri == _ac->_auxUri) {
-        // Save the value owned by each element contained in the POST body
-        // of a current HTTP request to AutoConnectElements.
-        aux->_storeElements(_webServer);
-        break;
-      }
-      aux = aux->_next;
+    AutoConnectAux* aux = _ac->_findAux(_ac->_auxUri);
+    if (aux) {
+      // Save the value owned by each element contained in the POST body
+      // of a current HTTP request to AutoConnectElements.
+      aux->_storeElements(_webServer);
     }
   }
 }
@@ -225,18 +254,10 @@ void AutoConnectAux::fetchElement(void) {
  * @return A pointer to the registered AutoConnectElement.
  */
 AutoConnectElement* AutoConnectAux::getElement(const char* name) {
-  for (AutoConnectElement& elm : _addonElm) {
-    if (elm.name.length() == strlen(name)) {
-      const char* p = name;
-      const char* elmName = elm.name.c_str();
-      while (tolower(*p++) == tolower(*elmName++)) {
-        if (!*p)
-          return &elm;
-      }
-    }
-  }
-  AC_DBG("Element<%s> not registered\n", name);
-  return nullptr;
+  AutoConnectElement* elm = _findElement(name, false);
+  if (!elm)
+    AC_DBG("Element<%s> not registered\n", name);
+  return elm;
 }
 
 /**
@@ -245,18 +266,10 @@ AutoConnectElement* AutoConnectAux::getElement(const char* name) {
  * @return A pointer to the registered AutoConnectElement.
  */
 AutoConnectElement* AutoConnectAux::getElement(const __FlashStringHelper* name) {
-  for (AutoConnectElement& elm : _addonElm) {
-    if (elm.name.length() == strlen_P(reinterpret_cast<PGM_P>(name))) {
-      PGM_P p = reinterpret_cast<PGM_P>(name);
-      const char* elmName = elm.name.c_str();
-      while (tolower(pgm_read_byte(p++)) == tolower(*elmName++)) {
-        if (!pgm_read_byte(p))
-          return &elm;
-      }
-    }
-  }
-  AC_DBG("Element<%s> not registered\n", String(name).c_str());
-  return nullptr;
+  AutoConnectElement* elm = _findElement(reinterpret_cast<PGM_P>(name), true);
+  if (!elm)
+    AC_DBG("Element<%s> not registered\n", String(name).c_str());
+  return elm;
 }
 
 /**
@@ -265,13 +278,150 @@ AutoConnectElement* AutoConnectAux::getElement(const __FlashStringHelper* name)
  * @return A pointer to the registered AutoConnectElement.
  */
 AutoConnectElement* AutoConnectAux::getElement(const String& name) {
+  AutoConnectElement* elm = _findElement(name.c_str(), false);
+  if (!elm)
+    AC_DBG("Element<%s> not registered\n", name.c_str());
+  return elm;
+}
+
+/**
+ * Look up the element with the name that matches case-insensitively.
+ * The index narrows down the candidates by the hash of the name. If the
+ * index has no match, the elements are scanned linearly as a safeguard
+ * against the element whose name has been rewritten after it was added,
+ * and the index is rebuilt when found.
+ * @param  name     Element name.
+ * @param  progmem  The name is placed in PROGMEM.
+ * @return A pointer to the registered AutoConnectElement.
+ */
+AutoConnectElement* AutoConnectAux::_findElement(PGM_P name, const bool progmem) {
+  auto  match = [&](const AutoConnectElement& elm) {
+    return !(progmem ? strcasecmp_P(elm.name.c_str(), name) : strcasecmp(elm.name.c_str(), name));
+  };
+
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  // The elements have been added, released or changed through
+  // getElements since the index was built.
+  if (_indexGeneration != _currentGeneration())
+    _indexElements();
+
+  const uint32_t  hash = _hashName(name, progmem);
+  auto  itr = std::lower_bound(_elmIndex.begin(), _elmIndex.end(), hash,
+    [](const AC_ELEMENTINDEX_t& index, const uint32_t hash) {
+      return index.first < hash;
+    });
+  for (; itr != _elmIndex.end() && itr->first == hash; ++itr)
+    if (match(*itr->second))
+      return itr->second;
+#endif
+
   for (AutoConnectElement& elm : _addonElm)
-    if (elm.name.equalsIgnoreCase(name))
+    if (match(elm)) {
+#ifdef AUTOCONNECT_USE_AUXINDEX
+      // The element has been renamed.
+      _generation++;
+      _indexElements();
+#endif
       return &elm;
-  AC_DBG("Element<%s> not registered\n", name.c_str());
+    }
   return nullptr;
 }
 
+#ifdef AUTOCONNECT_USE_AUXINDEX
+/**
+ * Calculate the FNV-1a hash of the lower-cased element name.
+ * @param  name     Element name.
+ * @param  progmem  The name is placed in PROGMEM.
+ * @return The hash value.
+ */
+uint32_t AutoConnectAux::_hashName(PGM_P name, const bool progmem) {
+  uint32_t  hash = 2166136261UL;
+  uint8_t   c;
+
+  while ((c = progmem ? pgm_read_byte(name) : *name)) {
+    hash = (hash ^ static_cast<uint8_t>(tolower(c))) * 16777619UL;
+    name++;
+  }
+  return hash;
+}
+
+/**
+ * Register an element to the index. The element is placed after the
+ * elements with the same hash so that the element added earlier takes
+ * precedence as well as the order of the elements vector.
+ * @param  element  A reference of the added AutoConnectElement.
+ */
+void AutoConnectAux::_indexElement(AutoConnectElement& element) {
+  // The index that was stale before this addition is left to be
+  // rebuilt at the next lookup.
+  if (_indexGeneration + 1 != _generation)
+    return;
+  const uint32_t  hash = _hashName(element.name.c_str(), false);
+  auto  itr = std::upper_bound(_elmIndex.begin(), _elmIndex.end(), hash,
+    [](const uint32_t hash, const AC_ELEMENTINDEX_t& index) {
+      return hash < index.first;
+    });
+  _elmIndex.insert(itr, AC_ELEMENTINDEX_t(hash, &element));
+  _indexGeneration = _generation;
+}
+
+/**
+ * Rebuild the index with all elements.
+ */
+void AutoConnectAux::_indexElements(void) {
+  _elmIndex.clear();
+  _elmIndex.reserve(_addonElm.size());
+  for (AutoConnectElement& elm : _addonElm)
+    _elmIndex.push_back(AC_ELEMENTINDEX_t(_hashName(elm.name.c_str(), false), &elm));
+  std::stable_sort(_elmIndex.begin(), _elmIndex.end(),
+    [](const AC_ELEMENTINDEX_t& a, const AC_ELEMENTINDEX_t& b) {
+      return a.first < b.first;
+    });
+  _indexGeneration = _generation;
+}
+
+/**
+ * Start tracking the elements vector handed out by getElements. The
+ * Sketch may only read it, so the generation is not advanced here. The
+ * change made through the vector is detected by its fingerprint when
+ * the generation is referred to.
+ */
+void AutoConnectAux::_exposeElements(void) {
+  if (!_exposed) {
+    _exposed = true;
+    _exposedPrint = _printElements();
+  }
+}
+
+/**
+ * Calculate the fingerprint of the elements vector from the addresses
+ * of the elements in order. It costs no string comparison.
+ * @return The fingerprint.
+ */
+uint32_t AutoConnectAux::_printElements(void) const {
+  uint32_t  print = 2166136261UL;
+  for (const AutoConnectElement& elm : _addonElm)
+    print = (print ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&elm))) * 16777619UL;
+  return print ^ static_cast<uint32_t>(_addonElm.size());
+}
+
+/**
+ * Returns the generation of the elements. If the vector handed out by
+ * getElements has been changed, the generation is advanced here.
+ * @return The generation.
+ */
+uint32_t AutoConnectAux::_currentGeneration(void) {
+  if (_exposed) {
+    const uint32_t  print = _printElements();
+    if (print != _exposedPrint) {
+      _exposedPrint = print;
+      _generation++;
+    }
+  }
+  return _generation;
+}
+#endif
+
 /**
  * Validate all AutoConnectInputs value.
  * @return true  Validation successfull
@@ -310,11 +460,22 @@ void AutoConnectAux::redirect(const char* url) {
  * @return false The specified AutoConnectElement not found in AutoConnectAux.
  */
 bool AutoConnectAux::release(const String& name) {
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  _currentGeneration();
+#endif
   auto itr = std::remove_if(_addonElm.begin(), _addonElm.end(),
     [&](std::reference_wrapper<AutoConnectElement> const elm) {
       return elm.get().name.equalsIgnoreCase(name);
     });
-  return _addonElm.erase(itr, _addonElm.end()) != _addonElm.end();
+  bool  rc = _addonElm.erase(itr, _addonElm.end()) != _addonElm.end();
+  if (rc) {
+    _generation++;
+#ifdef AUTOCONNECT_USE_AUXINDEX
+    if (_exposed)
+      _exposedPrint = _printElements();
+#endif
+  }
+  return rc;
 }
 
 /**
@@ -327,30 +488,40 @@ bool AutoConnectAux::release(const String& name) {
  */
 bool AutoConnectAux::setElementValue(const String& name, const String value) {
   AutoConnectElement* elm = getElement(name);
-  if (elm) {
-    if (elm->typeOf() == AC_Select) {
-      AutoConnectSelect* elmSelect = reinterpret_cast<AutoConnectSelect*>(elm);
-      elmSelect->select(value);
-    }
-    else {
-      if (elm->typeOf() == AC_Checkbox) {
-        if (value == "checked") {
-          AutoConnectCheckbox* elmCheckbox = reinterpret_cast<AutoConnectCheckbox*>(elm);
-          elmCheckbox->checked = true;
-        }
-      }
-      else if (elm->typeOf() == AC_Radio) {
-        AutoConnectRadio* elmRadio = reinterpret_cast<AutoConnectRadio*>(elm);
-        elmRadio->check(value);
-      }
-      else if (elm->typeOf() == AC_Range) {
-        AutoConnectRange* elmRange = reinterpret_cast<AutoConnectRange*>(elm);
-        elmRange->value = value.toInt();
+  return elm ? _setValue(*elm, value) : false;
+}
+
+/**
+ * Set the value to the element according to its type.
+ * @param  element  A reference of the element to set the value.
+ * @param  value    Setting value. (String)
+ * @return true  The value was set.
+ * @return false The element value does not match storage type.
+ */
+bool AutoConnectAux::_setValue(AutoConnectElement& element, const String& value) {
+  AutoConnectElement* elm = &element;
+  if (elm->typeOf() == AC_Select) {
+    AutoConnectSelect* elmSelect = reinterpret_cast<AutoConnectSelect*>(elm);
+    elmSelect->select(value);
+  }
+  else {
+    if (elm->typeOf() == AC_Checkbox) {
+      if (value == "checked") {
+        AutoConnectCheckbox* elmCheckbox = reinterpret_cast<AutoConnectCheckbox*>(elm);
+        elmCheckbox->checked = true;
       }
-      else
-        elm->value = value;
-      return true;
     }
+    else if (elm->typeOf() == AC_Radio) {
+      AutoConnectRadio* elmRadio = reinterpret_cast<AutoConnectRadio*>(elm);
+      elmRadio->check(value);
+    }
+    else if (elm->typeOf() == AC_Range) {
+      AutoConnectRange* elmRange = reinterpret_cast<AutoConnectRange*>(elm);
+      elmRange->value = value.toInt();
+    }
+    else
+      elm->value = value;
+    return true;
   }
   return false;
 }
@@ -409,18 +580,11 @@ void AutoConnectAux::upload(const String& requestUri, const HTTPUpload& upload)
     AC_DBG("ACFile %s ", upload.name.c_str());
     String  logContext = "missing";
 
+    AutoConnectAux* aux = _ac->_findAux(requestUri);
     AutoConnectElementVT  addons;
-    AutoConnectAux* aux = _ac->_aux;
-    while (aux) {
-      if (aux->_uri == requestUri) {
-        addons = aux->_addonElm;
-        break;
-      }
-      aux = aux->_next;
-    }
 
     _currentUpload = nullptr;
-    for (AutoConnectElement& elm : addons) {
+    for (AutoConnectElement& elm : aux ? aux->_addonElm : addons) {
       if (elm.typeOf() == AC_File) {
         _currentUpload = reinterpret_cast<AutoConnectFile*>(&elm);
         // Reset previous value
@@ -442,9 +606,11 @@ void AutoConnectAux::upload(const String& requestUri, const HTTPUpload& upload)
     // AutoConnectUpload (i.e. the store attribute is AC_File_Ex),
     // enable the user-owned upload handler activated by the onUpload.
     _upload = nullptr;
+    AutoConnectUploadHandler* handler = nullptr;
     if (_currentUpload)
       if (_currentUpload->attach(_currentUpload->store)) {
-        _upload = std::bind(&AutoConnectUploadHandler::upload, _currentUpload->upload(), std::placeholders::_1, std::placeholders::_2);
+        handler = _currentUpload->upload();
+        _upload = std::bind(&AutoConnectUploadHandler::upload, handler, std::placeholders::_1, std::placeholders::_2);
         if (_currentUpload->exitStart())
           _currentUpload->upload()->onStart(_currentUpload->exitStart());
         if (_currentUpload->exitEnd())
@@ -459,12 +625,44 @@ void AutoConnectAux::upload(const String& requestUri, const HTTPUpload& upload)
     if (!_upload) {
       if (_uploadHandler) {
         _upload = _uploadHandler;
+        handler = _uploadClass;
         AC_DBG_DUMB("enabled\n");
       }
       else {
         AC_DBG_DUMB("missing\n");
       }
     }
+
+#ifdef AUTOCONNECT_USE_UPLOADDIGEST
+    // The digest for verifying the uploaded data is given by the query
+    // parameter or the request header, since the form fields posted
+    // with the file are not available until the upload ends.
+    if (handler) {
+      static const struct {
+        AutoConnectDigest::AC_DIGEST_t  type;
+        const char* arg;
+        const char* header;
+      } digests[] = {
+        { AutoConnectDigest::AC_DIGEST_SHA256, AUTOCONNECT_UPLOAD_SHA256, AUTOCONNECT_UPLOAD_SHA256_HEADER },
+        { AutoConnectDigest::AC_DIGEST_MD5, AUTOCONNECT_UPLOAD_MD5, AUTOCONNECT_UPLOAD_MD5_HEADER }
+      };
+      AutoConnectDigest::AC_DIGEST_t  type = AutoConnectDigest::AC_DIGEST_NONE;
+      String  digest;
+      for (const auto& d : digests) {
+        digest = _ac->_webServer->arg(d.arg);
+        if (!digest.length())
+          digest = _ac->_webServer->header(d.header);
+        if (digest.length()) {
+          type = d.type;
+          AC_DBG("Upload verified by %s %s\n", d.arg, digest.c_str());
+          break;
+        }
+      }
+      handler->verify(type, digest);
+    }
+#else
+    AC_UNUSED(handler);
+#endif
   }
 
   // Invokes upload handler
@@ -510,10 +708,10 @@ AutoConnectAux& AutoConnectAux::referer(void) {
  * @param  aux   A reference of AutoConnectAux.
  */
 void AutoConnectAux::_concat(AutoConnectAux& aux) {
-  if (_next)
-    _next->_concat(aux);
-  else
-    _next = &aux;
+  AutoConnectAux* tail = this;
+  while (tail->_next)
+    tail = tail->_next;
+  tail->_next = &aux;
 }
 
 /**
@@ -524,11 +722,9 @@ void AutoConnectAux::_concat(AutoConnectAux& aux) {
  * @param  ac    A reference of AutoConnect.
  */
 void AutoConnectAux::_join(AutoConnectExt<AutoConnectConfigExt>& ac) {
-  _ac = &ac;
-
   // Chain to subsequent AutoConnectAux in the list.
-  if (_next)
-    _next->_join(ac);
+  for (AutoConnectAux* aux = this; aux; aux = aux->_next)
+    aux->_ac = &ac;
 }
 
 /**
@@ -536,16 +732,15 @@ void AutoConnectAux::_join(AutoConnectExt<AutoConnectConfigExt>& ac) {
  * for implementing the AutoConnect menu.
  * @param  args  A reference of PageArgument but it's only used for
  * interface alignment and is not actually used.
- * @return A concatenated string of <li> elements for the menu item of
- * AutoConnect.
+ * @return A <li> element for the menu item of this page. AutoConnect
+ * concatenates them for all pages.
  */
 const String AutoConnectAux::_injectMenu(PageArgument& args) {
   String  menuItem;
 
+  AC_UNUSED(args);
   if (_menu)
     menuItem = String(FPSTR("<li class=\"lb-item\"><a href=\"")) + String(_uri) + String("\">") + _title + String(FPSTR("</a></li>"));
-  if (_next)
-    menuItem += _next->_injectMenu(args);
   return menuItem;
 }
 
@@ -640,7 +835,8 @@ const String AutoConnectAux::_insertElement(PageArgument& args) {
  * AutoConnectRange and AutoConnectFile require JavaScript; if an AutoConnectAux
  * page has these elements, the AutoConnectAux handler will automatically insert
  * the JavaScript necessary for its operation.
- * @param  args  A reference of PageArgument but unused.
+ * The page that enables eventSource subscribes to its event stream.
+ * @param  args  A reference of PageArgument.
  * @return HTML string that should be inserted.
  */
 const String AutoConnectAux::_insertScript(PageArgument& args) {
@@ -652,12 +848,26 @@ const String AutoConnectAux::_insertScript(PageArgument& args) {
     postscript += String(FPSTR(_PAGE_SCRIPT_MA));
 
   // Insert Fetch
+  bool  respond = false;
   for (AutoConnectElement& elm : _addonElm)
     if (elm.canHandle()) {
       postscript += String(FPSTR(_PAGE_SCRIPT_FE));
+      respond = true;
       break;
     }
 
+#ifdef AUTOCONNECT_USE_AUXEVENT
+  // Insert the subscription to the event stream of this page
+  if (_eventSource) {
+    postscript += String(FPSTR(_PAGE_SCRIPT_ES)) + String(F("_es('")) + _indicateUri(args) + String(F("');"));
+    respond = true;
+  }
+#endif
+
+  // Both apply the responses of the elements to the page
+  if (respond)
+    postscript += String(FPSTR(_PAGE_SCRIPT_RE));
+
   return postscript;
 }
 
@@ -713,11 +923,7 @@ PageElement* AutoConnectAux::_setupPage(const String& uri) {
   PageElement*  elm = nullptr;
 
   if (_ac) {
-    if (uri != _uri) {
-      if (_next) {
-        elm = _next->_setupPage(uri);
-      }
-    } else {
+    if (uri == _uri) {
       AutoConnectExt<AutoConnectConfigExt>*  mother = _ac;
       // Overwrite actual AutoConnectMenu title to the Aux. page title
       if (_title.length())
@@ -790,9 +996,8 @@ PageElement* AutoConnectAux::_setupPage(const String& uri) {
  * @return An empty string.
  */
 String AutoConnectAux::_fetchEndpoint(PageArgument& args) {
-  int responseCode = 500;
-  PGM_P responseContent;
-  char* res = nullptr;
+  char  buffer[AUTOCONNECT_FETCH_BUFFERSIZE];
+  PGM_P responseContent = buffer;
 
   String  auxPath = args.arg(String(F(AUTOCONNECT_AUXURI_PARAM)));
   // After identifying the AutoConnectAux that should respond to the endpoint
@@ -801,12 +1006,13 @@ String AutoConnectAux::_fetchEndpoint(PageArgument& args) {
   if (auxPath.length()) {
     auxPath.replace("&#47;", "/");
     if (_uri != auxPath) {
-      if (_next) {
-        _next->_fetchEndpoint(args);
+      AutoConnectAux* aux = _ac->_findAux(auxPath);
+      if (aux && aux != this) {
+        aux->_fetchEndpoint(args);
         return String();
       }
       else
-        responseContent = String(String(F("No AutoConnectAux - ")) + auxPath).c_str();
+        snprintf_P(buffer, sizeof(buffer), PSTR("No AutoConnectAux - %s"), auxPath.c_str());
     }
     else {
       AC_DBG("Ep %s accepted\n", auxPath.c_str());
@@ -822,54 +1028,260 @@ String AutoConnectAux::_fetchEndpoint(PageArgument& args) {
       AutoConnectElement* srcElm = getElement(currentTarget);
       if (srcElm) {
         srcElm->reply(*this);
+        _ac->_webServer->enableCORS(true);
+        size_t  size_n = _sendResponse(buffer, sizeof(buffer));
+        AC_DBG(AUTOCONNECT_URI_FETCH "(200) %u bytes\n", (unsigned int)size_n);
+        AC_UNUSED(size_n);
+        _ac->_responsePage->cancel();
+        return String();
+      }
+      else
+        snprintf_P(buffer, sizeof(buffer), PSTR("No endpoints with " AUTOCONNECT_FETCHELEMENT_PARAM ":%s"), currentTarget.c_str());
+    }
+  }
+  else
+    responseContent = PSTR("Invalid interface");
+
+  AC_DBG(AUTOCONNECT_URI_FETCH "(500) %s\n", responseContent);
+  _ac->_webServer->send(500, "text/plain", responseContent);
+  _ac->_responsePage->cancel();
+  return String();
+}
+
+/**
+ * Send back the responses of the elements on this page as the JSON
+ * array to the Fetch request. The response is sent in chunks each time
+ * the buffer fills up.
+ * @param  buffer  The buffer to assemble the response.
+ * @param  size    Size of the buffer.
+ * @return The number of bytes of the JSON sent.
+ */
+size_t AutoConnectAux::_sendResponse(char* buffer, const size_t size) {
+  _ac->_webServer->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  _ac->_webServer->send(200, "application/json", "");
+  size_t  size_n = _writeResponse(buffer, size, [&](const char* content, const size_t len) {
+    _ac->_webServer->sendContent(content, len);
+  });
+  _ac->_webServer->sendContent("");
+  return size_n;
+}
 
-        // Construct the JSON message that will serve as the response.
-        size_t  jbSize = sizeof("[]");
-        for (AutoConnectElement& elm : _addonElm)
-          jbSize += elm.responseLength() + sizeof(',');
+/**
+ * Write the responses of the elements on this page as the JSON array.
+ * Only the elements that have responded since the last write are
+ * visited, and their responses are cleared after being written. The
+ * JSON is assembled in the buffer given by the caller and passed to
+ * the writer each time the buffer fills up, so the response of any
+ * length does not take the heap. An element whose response exceeds
+ * the buffer alone borrows a temporary buffer.
+ * @param  buffer  The buffer to assemble the response.
+ * @param  size    Size of the buffer.
+ * @param  write   The writer that sends the assembled content.
+ * @return The number of bytes of the JSON written.
+ */
+size_t AutoConnectAux::_writeResponse(char* buffer, const size_t size, const std::function<void(const char*, const size_t)>& write) {
+  size_t  len = 0;
+  size_t  size_n = 0;
+  bool    first = true;
+  auto  flush = [&]() {
+    if (len) {
+      write(buffer, len);
+      size_n += len;
+      len = 0;
+    }
+  };
+
+  buffer[len++] = '[';
+  auto  itr = AutoConnectElementBasis::_responded.begin();
+  while (itr != AutoConnectElementBasis::_responded.end()) {
+    AutoConnectElementBasis* elm = *itr;
+    // The elements that responded on the other pages are left for their
+    // own Fetch.
+    AutoConnectElementBasis* own = _findElement(elm->name.c_str(), false);
+    if (own != elm) {
+      ++itr;
+      continue;
+    }
 
-        res = new char[jbSize];
+    if (elm->responses.size()) {
+      // Reserve a comma followed by the element and the closing bracket.
+      const size_t  elmLen = elm->responseLength();
+      if (len + sizeof(',') + elmLen + sizeof(']') > size)
+        flush();
+      if (!first)
+        buffer[len++] = ',';
+      if (len + elmLen + sizeof('\0') <= size) {
+        len += elm->responseJSON(buffer + len);
+        first = false;
+      }
+      else {
+        char* res = new char[elmLen + sizeof('\0')];
         if (res) {
-          char* bp = res;
-          *bp++ = '[';
-          char* tp = bp;
-          for (AutoConnectElement& elm : _addonElm) {
-            char* np = bp;
-            if ((bp += elm.responseJSON(bp)) > np)
-              *bp++ = ',';
-
-            // After exiting the `on` handler, all response data given by the
-            // user sketch is cleared.
-            elm.responses.clear();
-          }
-          if (tp == bp)
-            bp++;
-          *(--bp)++ = ']';
-          *bp = '\0';
-          _ac->_webServer->enableCORS(true);
-          responseCode = 200;
-          responseContent = res;
+          flush();
+          size_t  resLen = elm->responseJSON(res);
+          write(res, resLen);
+          size_n += resLen;
+          delete[] res;
+          first = false;
+        }
+        else {
+          AC_DBG("%s response %u bytes allocation failed\n", elm->name.c_str(), (unsigned int)elmLen);
+          if (!first)
+            len--;
         }
-        else
-          responseContent = PSTR("Response buffer allocation failed");
       }
-      else {
-        res = new char[currentTarget.length() + sizeof('\0')];
-        sprintf_P(res, PSTR("No endpoints with " AUTOCONNECT_FETCHELEMENT_PARAM ":%s"), currentTarget.c_str());
-        responseContent = res;
+      // After exiting the `on` handler, all response data given by the
+      // user sketch is cleared.
+      elm->responses.clear();
+    }
+    itr = AutoConnectElementBasis::_responded.erase(itr);
+  }
+  buffer[len++] = ']';
+  flush();
+  return size_n;
+}
+
+#ifdef AUTOCONNECT_USE_AUXEVENT
+/**
+ * Push the responses of the elements on this page to the browsers that
+ * subscribe to the event stream of the page. The event carries the same
+ * JSON array as the response to the Fetch request, and the page applies
+ * it in the same way. The responses are kept for the next Fetch or push
+ * if no browser subscribes to the page.
+ * @return The number of browsers to which the responses were pushed.
+ */
+size_t AutoConnectAux::push(void) {
+  // Leave the browsers that have left the page
+  _subscribers.erase(std::remove_if(_subscribers.begin(), _subscribers.end(), [](WiFiClient& client) {
+    return !client.connected();
+  }), _subscribers.end());
+  if (!_subscribers.size())
+    return 0;
+
+  bool  responded = false;
+  for (AutoConnectElementBasis* elm : AutoConnectElementBasis::_responded)
+    if (elm->responses.size() && _findElement(elm->name.c_str(), false) == elm) {
+      responded = true;
+      break;
+    }
+  if (!responded)
+    return 0;
+
+  // A line break in the JSON would end the data field of the event, so
+  // it continues the data on the next field. The browser joins the
+  // fields with the line break and gets the JSON as it is.
+  char  buffer[AUTOCONNECT_FETCH_BUFFERSIZE];
+  auto  write = [&](const char* content, const size_t len) {
+    size_t  top = 0;
+    for (size_t pos = 0; pos < len; pos++)
+      if (content[pos] == '\n' || content[pos] == '\r') {
+        _writeEvent(content + top, pos - top);
+        _writeEvent("\ndata: ", sizeof("\ndata: ") - sizeof('\0'));
+        top = pos + 1;
       }
+    _writeEvent(content + top, len - top);
+  };
+  _writeEvent("data: ", sizeof("data: ") - sizeof('\0'));
+  size_t  size_n = _writeResponse(buffer, sizeof(buffer), write);
+  _writeEvent("\n\n", sizeof("\n\n") - sizeof('\0'));
+  _heartbeat = millis();
+  size_t  sent = std::count_if(_subscribers.begin(), _subscribers.end(), [](WiFiClient& client) {
+    return client.connected();
+  });
+  AC_DBG("%s pushed %u bytes to %u\n", _uri.c_str(), (unsigned int)size_n, (unsigned int)sent);
+  AC_UNUSED(size_n);
+  return sent;
+}
+
+/**
+ * Write the content of the event to every subscriber. A subscriber
+ * whose connection cannot take the content without blocking is closed,
+ * so that a slow browser does not stall the loop of the sketch. The
+ * browser reconnects after AUTOCONNECT_AUXEVENT_RETRY and receives the
+ * subsequent events.
+ * @param  content  The content to be written.
+ * @param  len      Length of the content.
+ */
+void AutoConnectAux::_writeEvent(const char* content, const size_t len) {
+  if (!len)
+    return;
+  for (WiFiClient& client : _subscribers) {
+    if (!client.connected())
+      continue;
+#if defined(ARDUINO_ARCH_ESP8266)
+    // The ESP8266 core blocks the write until the send buffer has room.
+    if (client.availableForWrite() < static_cast<int>(len)) {
+      AC_DBG(AUTOCONNECT_URI_EVENT " %s subscriber stalled\n", _uri.c_str());
+      client.stop();
+      continue;
+    }
+#endif
+    if (client.write(reinterpret_cast<const uint8_t*>(content), len) != len) {
+      AC_DBG(AUTOCONNECT_URI_EVENT " %s subscriber stalled\n", _uri.c_str());
+      client.stop();
     }
   }
-  else
-    responseContent = PSTR("Invalid interface");
+}
 
-  AC_DBG(AUTOCONNECT_URI_FETCH "(%d) %s\n", responseCode, responseContent);
-  _ac->_webServer->send(responseCode, responseCode == 200 ? "application/json" : "text/plain", responseContent);
+/**
+ * Keep the event stream connections alive while the page does not
+ * push. A comment line is written to the subscribers at intervals of
+ * AUTOCONNECT_AUXEVENT_HEARTBEAT, which prevents the proxies and the
+ * browser from closing an idle connection and reveals the subscribers
+ * that have left the page.
+ */
+void AutoConnectAux::_keepAlive(void) {
+  if (!_subscribers.size() || millis() - _heartbeat < AUTOCONNECT_AUXEVENT_HEARTBEAT)
+    return;
+  _heartbeat = millis();
+  _writeEvent(":\n\n", sizeof(":\n\n") - sizeof('\0'));
+  _subscribers.erase(std::remove_if(_subscribers.begin(), _subscribers.end(), [](WiFiClient& client) {
+    return !client.connected();
+  }), _subscribers.end());
+}
+
+/**
+ * An exit for the endpoint accepting the subscription to the event
+ * stream of the AutoConnectAux page that enables eventSource. The
+ * connection is kept by the page after the response header is sent,
+ * and the events are written to it by push. The oldest subscriber is
+ * dropped when the page has AUTOCONNECT_AUXEVENT_CLIENTS subscribers.
+ * @param  args  Request arguments from the Web client.
+ * @return An empty string.
+ */
+String AutoConnectAux::_eventEndpoint(PageArgument& args) {
+  String  auxPath = args.arg(String(F(AUTOCONNECT_AUXURI_PARAM)));
+  auxPath.replace("&#47;", "/");
+  AutoConnectAux* aux = _ac->_findAux(auxPath);
+
+  if (aux && aux->_eventSource) {
+    WiFiClient& client = _ac->_webServer->client();
+    client.setNoDelay(true);
+    client.print(F("HTTP/1.1 200 OK\r\n"
+      "Content-Type: text/event-stream\r\n"
+      "Cache-Control: no-cache\r\n"
+      "Connection: keep-alive\r\n"));
+    if (aux->_cors)
+      client.print(F("Access-Control-Allow-Origin: *\r\n"));
+    client.print(F("\r\nretry: "));
+    client.print(AUTOCONNECT_AUXEVENT_RETRY);
+    client.print(F("\n\n"));
+    if (aux->_subscribers.size() >= AUTOCONNECT_AUXEVENT_CLIENTS) {
+      aux->_subscribers.front().stop();
+      aux->_subscribers.erase(aux->_subscribers.begin());
+    }
+    aux->_subscribers.push_back(client);
+    aux->_heartbeat = millis();
+    AC_DBG(AUTOCONNECT_URI_EVENT " %s subscribed by %u\n", auxPath.c_str(), (unsigned int)aux->_subscribers.size());
+  }
+  else {
+    AC_DBG(AUTOCONNECT_URI_EVENT " %s not available\n", auxPath.c_str());
+    _ac->_webServer->send(404, "text/plain", String(F("No event stream - ")) + auxPath);
+  }
   _ac->_responsePage->cancel();
-  if (res)
-    delete[] res;
   return String();
 }
+#endif // !AUTOCONNECT_USE_AUXEVENT
 
 /**
  * Store element values owned by AutoConnectAux that caused the request.
@@ -878,105 +1290,324 @@ String AutoConnectAux::_fetchEndpoint(PageArgument& args) {
  * @param webServer A pointer to the class object of WebServerClass
  */
 void AutoConnectAux::_storeElements(WebServer* webServer) {
-  // Retrieve each element value, Overwrites the value of all cataloged
-  // AutoConnectElements with arguments inherited from last http request.
-  for (AutoConnectElement& elm : _addonElm) {
+  // Relies on AutoConnectRadio, it restores to false at the being
+  // because the checkbox argument will not pass if it is not checked.
+  for (AutoConnectElement& elm : _addonElm)
+    if (elm.typeOf() == AC_Checkbox)
+      reinterpret_cast<AutoConnectCheckbox&>(elm).checked = false;
+
+  // Retrieve each argument inherited from last http request in a single
+  // pass and overwrite the value of the element with the same name.
+  for (int n = 0; n < webServer->args(); n++) {
+    AutoConnectElement* elm = _findElement(webServer->argName(n).c_str(), false);
+    if (!elm)
+      continue;
 
     // The POST body does not contain the value of the AutoConnectFile,
     // so it can not be obtained with the WebServerClass::arg function.
     // The AutoConnectFile value will be restored from least recent
     // upload request.
-    if (elm.typeOf() == AC_File)
+    if (elm->typeOf() == AC_File)
       continue;
 
-    // Relies on AutoConnectRadio, it restores to false at the being
-    // because the checkbox argument will not pass if it is not checked.
-    if (elm.typeOf() == AC_Checkbox)
-      reinterpret_cast<AutoConnectCheckbox&>(elm).checked = false;
-
-    // Seek by argument, store the value to its element.
-    for (int8_t n = 0; n < static_cast<int8_t>(webServer->args()); n++) {
-      if (webServer->argName(n).equalsIgnoreCase(elm.name)) {
-        String  elmValue = webServer->arg(n);
-        if (elm.typeOf() == AC_Checkbox)
-          elmValue = "checked";
-        setElementValue(elm.name, elmValue);
-
-        // Copy a value to other elements declared as global.
-        if (elm.global) {
-          AutoConnectAux* aux = _ac->_aux;
-          while (aux) {
-            if (aux != this)
-              aux->setElementValue(elm.name, elmValue);
-            aux = aux->_next;
-          }
-        }
+    String  elmValue = elm->typeOf() == AC_Checkbox ? String(F("checked")) : webServer->arg(n);
+    _setValue(*elm, elmValue);
+
+    // Copy a value to other elements declared as global.
+    if (elm->global) {
+#ifdef AUTOCONNECT_USE_AUXINDEX
+      _ac->_propagateGlobal(*this, *elm, elmValue);
+#else
+      AutoConnectAux* aux = _ac->_aux;
+      while (aux) {
+        if (aux != this)
+          aux->setElementValue(elm->name, elmValue);
+        aux = aux->_next;
       }
+#endif
     }
   }
   AC_DBG_DUMB(", elements stored\n");
 }
 
-#ifdef AUTOCONNECT_USE_JSON
+/**
+ * Construct an element of the type which the page owns. The element
+ * is placed in the arena of the page and destructed together with the
+ * page. If the arena is not available, the element is allocated from
+ * the heap as it is.
+ * @param  T  Type of the element.
+ * @return A pointer of the constructed element.
+ */
+template<typename T>
+T* AutoConnectAux::_newElement(void) {
+#ifdef AUTOCONNECT_USE_AUXARENA
+  T* elm = _arena.create<T>();
+  if (elm)
+    return elm;
+#endif
+  return new T;
+}
 
 /**
- * Create an instance from the AutoConnectElement of the JSON object.
- * @param  json  A reference of JSON
+ * Create an instance of the AutoConnectElement of the type.
+ * @param  type  Type of the element to be created.
  * @return A pointer of created AutoConnectElement instance.
  */
-AutoConnectElement* AutoConnectAux::_createElement(const JsonObject& json) {
+AutoConnectElement* AutoConnectAux::_createElement(const ACElement_t type) {
   AutoConnectElement* elm = nullptr;
-  String  type = json[F(AUTOCONNECT_JSON_KEY_TYPE)].as<String>();
 
-  switch (_asElementType(type)) {
+  switch (type) {
   case AC_Element:
   case AC_Unknown:
-    elm = new AutoConnectElement;
+    elm = _newElement<AutoConnectElement>();
     break;
   case AC_Button: {
-    AutoConnectButton*  cert_elm = new AutoConnectButton;
+    AutoConnectButton*  cert_elm = _newElement<AutoConnectButton>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   case AC_Checkbox: {
-    AutoConnectCheckbox*  cert_elm = new AutoConnectCheckbox;
+    AutoConnectCheckbox*  cert_elm = _newElement<AutoConnectCheckbox>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   case AC_File: {
-    AutoConnectFile* cert_elm = new AutoConnectFile;
+    AutoConnectFile* cert_elm = _newElement<AutoConnectFile>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   case AC_Input: {
-    AutoConnectInput* cert_elm = new AutoConnectInput;
+    AutoConnectInput* cert_elm = _newElement<AutoConnectInput>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   case AC_Radio: {
-    AutoConnectRadio*  cert_elm = new AutoConnectRadio;
+    AutoConnectRadio*  cert_elm = _newElement<AutoConnectRadio>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   case AC_Range: {
-    AutoConnectRange*  cert_elm = new AutoConnectRange;
+    AutoConnectRange*  cert_elm = _newElement<AutoConnectRange>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   case AC_Select: {
-    AutoConnectSelect*  cert_elm = new AutoConnectSelect;
+    AutoConnectSelect*  cert_elm = _newElement<AutoConnectSelect>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   case AC_Style: {
-    AutoConnectStyle*  cert_elm = new AutoConnectStyle;
+    AutoConnectStyle*  cert_elm = _newElement<AutoConnectStyle>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   case AC_Submit: {
-    AutoConnectSubmit*  cert_elm = new AutoConnectSubmit;
+    AutoConnectSubmit*  cert_elm = _newElement<AutoConnectSubmit>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   case AC_Text: {
-    AutoConnectText*  cert_elm = new AutoConnectText;
+    AutoConnectText*  cert_elm = _newElement<AutoConnectText>();
     return reinterpret_cast<AutoConnectElement*>(cert_elm);
   }
   }
   return elm;
 }
 
+/**
+ * Load the AutoConnectAux page from the descriptor that the
+ * extras/auxcompiler tool generated from the JSON definition. The
+ * elements are built directly from the descriptors in PROGMEM without
+ * parsing JSON, and the result is the same as loading the original
+ * JSON definition with the load function.
+ * @param  page  The page descriptor placed in PROGMEM.
+ * @return true  Successfully loaded.
+ */
+bool AutoConnectAux::load(const ACPageDesc_t& page) {
+  ACPageDesc_t  desc;
+  memcpy_P(&desc, &page, sizeof(ACPageDesc_t));
+
+  if (desc.title)
+    _title = String(FPSTR(desc.title));
+  if (desc.uri)
+    _uri = String(FPSTR(desc.uri));
+  else if (!_uri.length()) {
+    AC_DBG("Warn. %s loaded null uri\n", _title.c_str());
+  }
+  if (desc.attr & AC_DESC_CORS)
+    _cors = desc.cors;
+  if (desc.attr & AC_DESC_MENU)
+    _menu = desc.menu;
+  if (desc.attr & AC_DESC_RESPONSE)
+    _responsive = desc.responsive;
+  if (desc.attr & AC_DESC_AUTH)
+    _httpAuth = static_cast<AC_AUTH_t>(desc.auth);
+  for (size_t n = 0; n < desc.elementNum; n++)
+    (void)_loadElement(desc.element[n]);
+  return true;
+}
+
+/**
+ * Load an element from the descriptor in PROGMEM. The element that
+ * already exists with the same name is updated by the descriptor.
+ * @param  desc  The element descriptor placed in PROGMEM.
+ * @return A reference of loaded AutoConnectElement instance.
+ */
+AutoConnectElement& AutoConnectAux::_loadElement(const ACElementDesc_t& desc) {
+  ACElementDesc_t element;
+  memcpy_P(&element, &desc, sizeof(ACElementDesc_t));
+
+  String  elmName = String(FPSTR(element.name));
+  AutoConnectElement* auxElm = getElement(elmName);
+  if (!auxElm) {
+    if (!elmName.length()) {
+      AC_DBG("Element name missing\n");
+      return _nullElement();
+    }
+    auxElm = _createElement(element.type);
+    AC_DBG("%s<%d> of %s created\n", elmName.c_str(), (int)(auxElm->typeOf()), uri());
+    // Insert to AutoConnect after applying the attributes so that the
+    // name index holds the loaded name.
+    _applyDesc(*auxElm, element);
+    add(*auxElm);
+  }
+  else if (!_applyDesc(*auxElm, element)) {
+    AC_DBG("Type of %s element mismatched\n", elmName.c_str());
+  }
+  return *auxElm;
+}
+
+/**
+ * Apply the attributes of the descriptor to the element, as well as
+ * the loadMember function applies the JSON object.
+ * @param  element  The element to be applied.
+ * @param  desc     The element descriptor copied from PROGMEM.
+ * @return true  The attributes are applied.
+ * @return false Type of the element is mismatched.
+ */
+bool AutoConnectAux::_applyDesc(AutoConnectElement& element, const ACElementDesc_t& desc) {
+  AutoConnectElement* elm = &element;
+  if (elm->typeOf() != desc.type)
+    return false;
+
+  elm->name = String(FPSTR(desc.name));
+  if (desc.value)
+    elm->value = String(FPSTR(desc.value));
+  if (desc.attr & AC_DESC_POST)
+    elm->post = static_cast<ACPosterior_t>(desc.post);
+  if (desc.attr & AC_DESC_GLOBAL)
+    elm->global = desc.global;
+
+  switch (desc.type) {
+  case AC_Button: {
+    AutoConnectButton*  elmButton = reinterpret_cast<AutoConnectButton*>(elm);
+    if (desc.peculiar)
+      elmButton->action = String(FPSTR(desc.peculiar));
+    break;
+  }
+  case AC_Checkbox: {
+    AutoConnectCheckbox*  elmCheckbox = reinterpret_cast<AutoConnectCheckbox*>(elm);
+    if (desc.label)
+      elmCheckbox->label = String(FPSTR(desc.label));
+    if (desc.attr & AC_DESC_CHECKED)
+      elmCheckbox->checked = desc.checked;
+    if (desc.attr & AC_DESC_OPTION)
+      elmCheckbox->labelPosition = static_cast<ACPosition_t>(desc.option);
+    break;
+  }
+  case AC_File: {
+    AutoConnectFile*  elmFile = reinterpret_cast<AutoConnectFile*>(elm);
+    if (desc.label)
+      elmFile->label = String(FPSTR(desc.label));
+    if (desc.attr & AC_DESC_OPTION)
+      elmFile->store = static_cast<ACFile_t>(desc.option);
+    break;
+  }
+  case AC_Input: {
+    AutoConnectInput* elmInput = reinterpret_cast<AutoConnectInput*>(elm);
+    if (desc.label)
+      elmInput->label = String(FPSTR(desc.label));
+    if (desc.peculiar)
+      elmInput->pattern = String(FPSTR(desc.peculiar));
+    if (desc.placeholder)
+      elmInput->placeholder = String(FPSTR(desc.placeholder));
+    if (desc.style)
+      elmInput->style = String(FPSTR(desc.style));
+    if (desc.attr & AC_DESC_OPTION)
+      elmInput->apply = static_cast<ACInput_t>(desc.option);
+    break;
+  }
+  case AC_Radio: {
+    AutoConnectRadio* elmRadio = reinterpret_cast<AutoConnectRadio*>(elm);
+    if (desc.label)
+      elmRadio->label = String(FPSTR(desc.label));
+    if (desc.attr & AC_DESC_ITEMS) {
+      elmRadio->empty(desc.items);
+      PGM_P item = desc.peculiar;
+      for (uint16_t n = 0; n < desc.items; n++, item += strlen_P(item) + sizeof('\0'))
+        elmRadio->add(String(FPSTR(item)));
+    }
+    if (desc.attr & AC_DESC_CHECKED)
+      elmRadio->checked = desc.checked;
+    if (desc.attr & AC_DESC_OPTION)
+      elmRadio->order = static_cast<ACArrange_t>(desc.option);
+    break;
+  }
+  case AC_Select: {
+    AutoConnectSelect*  elmSelect = reinterpret_cast<AutoConnectSelect*>(elm);
+    if (desc.label)
+      elmSelect->label = String(FPSTR(desc.label));
+    if (desc.attr & AC_DESC_ITEMS) {
+      elmSelect->empty(desc.items);
+      PGM_P item = desc.peculiar;
+      for (uint16_t n = 0; n < desc.items; n++, item += strlen_P(item) + sizeof('\0'))
+        elmSelect->add(String(FPSTR(item)));
+    }
+    if (desc.attr & AC_DESC_CHECKED)
+      elmSelect->selected = desc.checked;
+    break;
+  }
+  case AC_Range: {
+    AutoConnectRange* elmRange = reinterpret_cast<AutoConnectRange*>(elm);
+    if (desc.label)
+      elmRange->label = String(FPSTR(desc.label));
+    if (desc.attr & AC_DESC_VALUE)
+      elmRange->value = desc.range[0];
+    if (desc.attr & AC_DESC_MIN)
+      elmRange->min = desc.range[1];
+    if (desc.attr & AC_DESC_MAX)
+      elmRange->max = desc.range[2];
+    if (desc.attr & AC_DESC_STEP)
+      elmRange->step = desc.range[3];
+    if (desc.attr & AC_DESC_OPTION)
+      elmRange->magnify = static_cast<ACPosition_t>(desc.option);
+    if (desc.style)
+      elmRange->style = String(FPSTR(desc.style));
+    break;
+  }
+  case AC_Submit: {
+    AutoConnectSubmit*  elmSubmit = reinterpret_cast<AutoConnectSubmit*>(elm);
+    if (desc.peculiar)
+      elmSubmit->uri = String(FPSTR(desc.peculiar));
+    break;
+  }
+  case AC_Text: {
+    AutoConnectText*  elmText = reinterpret_cast<AutoConnectText*>(elm);
+    if (desc.style)
+      elmText->style = String(FPSTR(desc.style));
+    if (desc.peculiar)
+      elmText->format = String(FPSTR(desc.peculiar));
+    break;
+  }
+  default:
+    break;
+  }
+  return true;
+}
+
+#ifdef AUTOCONNECT_USE_JSON
+
+/**
+ * Create an instance from the AutoConnectElement of the JSON object.
+ * @param  json  A reference of JSON
+ * @return A pointer of created AutoConnectElement instance.
+ */
+AutoConnectElement* AutoConnectAux::_createElement(const JsonObject& json) {
+  String  type = json[F(AUTOCONNECT_JSON_KEY_TYPE)].as<String>();
+  return _createElement(_asElementType(type));
+}
+
 /**
  * Constructs an AutoConnectAux instance by reading all the
  * AutoConnectElements of the specified URI from the elements defined 
@@ -1020,13 +1651,16 @@ bool AutoConnectAux::load(const __FlashStringHelper* in, const size_t size) {
  * Constructs an AutoConnectAux instance by reading all the
  * AutoConnectElements of the specified URI from the elements defined
  * JSON stored in a Stream.
+ * The stream is not deserialized as a whole. Each element is parsed
+ * and loaded one at a time, so the JsonDocument only needs to hold the
+ * largest element of the page.
  * @param  in    AutoConnectAux element data which is described by JSON.
- * @param  size  JsonDocument buffer size.
+ * @param  size  Upper limit of the JsonDocument capacity for an element.
  * @return true  The element collection successfully loaded.
  * @return false Invalid JSON data occurred. 
  */
 bool AutoConnectAux::load(Stream& in, const size_t size) {
-  return _parseJson<Stream&>(in, size);
+  return _streamPage(in, size);
 }
 
 /**
@@ -1063,6 +1697,264 @@ bool AutoConnectAux::_load(JsonObject& jb) {
   return true;
 }
 
+/**
+ * Load the AutoConnectAux page from the stream without deserializing
+ * the whole JSON document. The members of the page other than the
+ * elements are collected as raw text and loaded together at the end,
+ * and the elements are loaded one by one as they appear in the stream.
+ * The stream is consumed up to the closing brace of the page.
+ * @param  in    Stream that contains the JSON description of a page.
+ * @param  size  Upper limit of the JsonDocument capacity for an element.
+ * @return true  Successfully loaded.
+ * @return false The stream is not a valid JSON object.
+ */
+bool AutoConnectAux::_streamPage(Stream& in, const size_t size) {
+  if (_peekJson(in) != '{') {
+    AC_DBG("JSON parse error\n");
+    return false;
+  }
+  _timedRead(in);
+
+  String  header;
+  String  key;
+  String  value;
+  int     c = _peekJson(in);
+  while (c != '}') {
+    if (c != '"' || !_readJson(in, key) || _peekJson(in) != ':') {
+      AC_DBG("JSON parse error\n");
+      return false;
+    }
+    _timedRead(in);
+    if (key.equals(F("\"" AUTOCONNECT_JSON_KEY_ELEMENT "\""))) {
+      if (!_streamElement(in, size, [&](JsonVariant& element) {
+        (void)_loadElement(element, String(""));
+        return false;
+      }))
+        return false;
+    }
+    else {
+      if (!_readJson(in, value)) {
+        AC_DBG("JSON parse error\n");
+        return false;
+      }
+      if (header.length())
+        header += ',';
+      header += key;
+      header += ':';
+      header += value;
+    }
+    c = _peekJson(in);
+    if (c == ',') {
+      _timedRead(in);
+      c = _peekJson(in);
+    }
+    else if (c != '}') {
+      AC_DBG("JSON parse error\n");
+      return false;
+    }
+  }
+  _timedRead(in);
+
+  header = String('{') + header + String('}');
+  ArduinoJsonBuffer jsonBuffer(AUTOCONNECT_JSONBUFFER_SIZE + header.length() * 2);
+#if ARDUINOJSON_VERSION_MAJOR<=5
+  JsonObject& jb = jsonBuffer.parseObject(header);
+  if (!jb.success()) {
+    AC_DBG("JSON parse error\n");
+    return false;
+  }
+#else
+  DeserializationError  err = deserializeJson(jsonBuffer, header.c_str(), header.length());
+  if (err) {
+    AC_DBG("Deserialize:%s\n", err.c_str());
+    return false;
+  }
+  JsonObject jb = jsonBuffer.as<JsonObject>();
+#endif
+  return _load(jb);
+}
+
+/**
+ * Parse the elements in the stream one at a time and hand each of them
+ * over to the loader. The stream can be either an array of elements or
+ * a single element object. The raw text of an element is read from the
+ * stream first and the JsonDocument is sized to it, then released
+ * before the next element is read.
+ * @param  in    Stream that contains the JSON description of elements.
+ * @param  size  Upper limit of the JsonDocument capacity for an element.
+ * @param  load  Loader of the parsed element. It returns true to stop
+ * reading the rest of the elements.
+ * @return true  The elements are valid JSON.
+ * @return false JSON parsing error occurred.
+ */
+bool AutoConnectAux::_streamElement(Stream& in, const size_t size, const std::function<bool(JsonVariant&)>& load) {
+  const bool  array = _peekJson(in) == '[';
+  if (array)
+    _timedRead(in);
+
+  String  text;
+  int     c = _peekJson(in);
+  while (!array || c != ']') {
+    if (c != '{' || !_readJson(in, text)) {
+      AC_DBG("JSON parse error\n");
+      return false;
+    }
+#if ARDUINOJSON_VERSION_MAJOR<=5
+    ArduinoJsonBuffer jsonBuffer(text.length());
+    JsonVariant element = jsonBuffer.parse(text);
+    if (!element.success()) {
+      AC_DBG("JSON parse error\n");
+      return false;
+    }
+    if (load(element))
+      return true;
+#else
+    // A copy of the strings goes into the JsonDocument, so the capacity
+    // starts at twice the text and grows until it reaches the limit.
+    size_t  capacity = std::min(size, static_cast<size_t>(text.length() * 2 + AUTOCONNECT_JSONBUFFER_SIZE));
+    DeserializationError  err;
+    do {
+      ArduinoJsonBuffer jsonBuffer(capacity);
+      err = deserializeJson(jsonBuffer, text.c_str(), text.length());
+      if (!err) {
+        JsonVariant element = jsonBuffer.as<JsonVariant>();
+        if (load(element))
+          return true;
+        break;
+      }
+      if (err != DeserializationError::NoMemory || capacity >= size)
+        break;
+      capacity = std::min(size, capacity * 2);
+    } while (true);
+    if (err) {
+      AC_DBG("Deserialize:%s\n", err.c_str());
+      return false;
+    }
+#endif
+    if (!array)
+      break;
+    c = _peekJson(in);
+    if (c == ',') {
+      _timedRead(in);
+      c = _peekJson(in);
+    }
+    else if (c != ']') {
+      AC_DBG("JSON parse error\n");
+      return false;
+    }
+  }
+  if (array)
+    _timedRead(in);
+  return true;
+}
+
+namespace {
+/**
+ * Stream::timedPeek and Stream::timedRead are protected. A derived class
+ * can take their member pointers and apply them to any Stream.
+ */
+class AutoConnectTimedStream : public Stream {
+ public:
+  static int  peek(Stream& in) { return (in.*(&AutoConnectTimedStream::timedPeek))(); }
+  static int  read(Stream& in) { return (in.*(&AutoConnectTimedStream::timedRead))(); }
+};
+}
+
+/**
+ * Peek a character from the stream. A stream such as the network client
+ * may have no data available for a moment in the middle of the text, so
+ * it waits up to the stream timeout before regarding it as the end.
+ * @param  in  Stream that contains JSON text.
+ * @return The next character, -1 if the stream has timed out.
+ */
+int AutoConnectAux::_timedPeek(Stream& in) {
+  return AutoConnectTimedStream::peek(in);
+}
+
+/**
+ * Read a character from the stream waiting up to the stream timeout.
+ * @param  in  Stream that contains JSON text.
+ * @return The character read, -1 if the stream has timed out.
+ */
+int AutoConnectAux::_timedRead(Stream& in) {
+  return AutoConnectTimedStream::read(in);
+}
+
+/**
+ * Peek the next character of JSON text with skipping whitespace.
+ * @param  in  Stream that contains JSON text.
+ * @return The next character, -1 if the stream has timed out.
+ */
+int AutoConnectAux::_peekJson(Stream& in) {
+  int c;
+  while ((c = _timedPeek(in)) >= 0 && isspace(c))
+    _timedRead(in);
+  return c;
+}
+
+/**
+ * Read a JSON value from the stream as raw text without parsing it.
+ * It tracks the string literals and the nesting of objects and arrays
+ * to find the end of the value, which is a string, an object, an array
+ * or a primitive that ends with a delimiter.
+ * @param  in    Stream that contains JSON text.
+ * @param  text  Raw text of the value that was read.
+ * @return true  A value was read.
+ * @return false The stream ended or the brackets were unbalanced.
+ */
+bool AutoConnectAux::_readJson(Stream& in, String& text) {
+  char    buf[32];
+  size_t  len = 0;
+  int     depth = 0;
+  bool    quoted = false;
+  bool    escaped = false;
+  bool    rc = false;
+  int     c;
+
+  text = String();
+  (void)_peekJson(in);
+  while ((c = _timedPeek(in)) >= 0) {
+    if (!quoted && !depth && (text.length() || len) && (c == ',' || c == ':' || c == '}' || c == ']' || isspace(c))) {
+      rc = true;
+      break;
+    }
+    _timedRead(in);
+    buf[len++] = static_cast<char>(c);
+    if (len == sizeof(buf) - 1) {
+      buf[len] = '\0';
+      text += buf;
+      len = 0;
+    }
+    if (quoted) {
+      if (escaped)
+        escaped = false;
+      else if (c == '\\')
+        escaped = true;
+      else if (c == '"')
+        quoted = false;
+    }
+    else if (c == '"')
+      quoted = true;
+    else if (c == '{' || c == '[')
+      depth++;
+    else if (c == '}' || c == ']') {
+      if (!depth--)
+        break;
+    }
+    // A closed string or a closed bracket at the top level completes the value.
+    if (!quoted && !depth && (c == '"' || c == '}' || c == ']')) {
+      rc = true;
+      break;
+    }
+  }
+  buf[len] = '\0';
+  text += buf;
+  // A primitive value ends at the end of the stream.
+  if (c < 0)
+    rc = !quoted && !depth && text.length();
+  return rc;
+}
+
 /**
  * Load element specified by the name parameter from the stream
  * described by JSON. Usually, the Stream is specified a storm file of
@@ -1086,7 +1978,16 @@ bool AutoConnectAux::loadElement(const String& in, const String& name, const siz
   return _parseElement<const String&, const String&>(in, name, docSize);
 }
 bool AutoConnectAux::loadElement(Stream& in, const String& name, const size_t docSize) {
-  return _parseElement<Stream&, const String&>(in, name, docSize);
+  bool  rc = false;
+  bool  parsed = _streamElement(in, docSize, [&](JsonVariant& element) {
+    if (_loadElement(element, name)) {
+      rc = true;
+      // The named element is unique, no need to read the rest.
+      return name.length() > 0;
+    }
+    return false;
+  });
+  return parsed && rc;
 }
 
 bool AutoConnectAux::loadElement(PGM_P in, std::vector<String> const& names, const size_t docSize) {
@@ -1102,7 +2003,20 @@ bool AutoConnectAux::loadElement(const String& in, std::vector<String> const& na
 }
 
 bool AutoConnectAux::loadElement(Stream& in, std::vector<String> const& names, const size_t docSize) {
-  return _parseElement<Stream&, std::vector<String> const&>(in, names, docSize);
+  std::vector<bool> loaded(names.size(), false);
+  size_t  remains = names.size();
+  bool  parsed = true;
+  if (remains) {
+    parsed = _streamElement(in, docSize, [&](JsonVariant& element) {
+      for (size_t n = 0; n < names.size(); n++)
+        if (!loaded[n] && _loadElement(element, names[n])) {
+          loaded[n] = true;
+          remains--;
+        }
+      return !remains;
+    });
+  }
+  return parsed && !remains;
 }
 
 bool AutoConnectAux::_loadElement(JsonVariant& jb, std::vector<String> const& names) {
@@ -1150,7 +2064,12 @@ AutoConnectElement& AutoConnectAux::_loadElement(JsonObject& element, const Stri
       if (elmName.length()) {
         if ((auxElm = _createElement(element))) {
           AC_DBG("%s<%d> of %s created\n", elmName.c_str(), (int)(auxElm->typeOf()), uri());
-          add(*auxElm);   // Insert to AutoConnect
+          // Insert to AutoConnect after loading the members so that the
+          // name index holds the loaded name.
+          if (auxElm->loadMember(element))
+            AC_DBG("%s<%d> of %s loaded\n", auxElm->name.c_str(), (int)auxElm->typeOf(), uri());
+          add(*auxElm);
+          return *auxElm;
         }
         else {
           AC_DBG("%s unknown element type\n", elmName.c_str());
@@ -1173,82 +2092,184 @@ AutoConnectElement& AutoConnectAux::_loadElement(JsonObject& element, const Stri
 }
 
 /**
- * Serialize an element specified the name into the stream.
- * @param  name  An element name to be output.
+ * Print adapter that indents every line of the pretty-printed JSON by
+ * the nesting depth at which the output is placed, and counts the
+ * bytes that reached the stream.
+ */
+class AutoConnectJsonIndent : public Print {
+ public:
+  AutoConnectJsonIndent(Print& out, const uint8_t depth) : written(0), _out(out), _depth(depth) {}
+  size_t write(uint8_t c) override {
+    size_t  n = _out.write(c);
+    if (c == '\n')
+      for (uint8_t d = 0; d < _depth; d++)
+        n += _out.print(F("  "));
+    written += n;
+    return n ? 1 : 0;
+  }
+  size_t  written;
+
+ private:
+  Print&  _out;
+  uint8_t _depth;
+};
+
+/**
+ * Serialize elements into the stream. Each element is serialized into
+ * its own JsonDocument sized to the element and written out at once,
+ * and the enclosing structure is written directly. The memory used
+ * is bounded by the largest element regardless of the number of the
+ * elements.
+ * @param  out     Stream to be output.
+ * @param  names   Names of the elements to be output. If not specified,
+ * the whole page including its attributes is output.
+ * @param  compact Output without the indentation and the line breaks.
+ * A single specified element is always output compactly.
  * @return Number of bytes output
  */
-size_t AutoConnectAux::saveElement(Stream& out, std::vector<String> const& names) {
-  size_t  bufferSize = 0;
-  size_t  amount = names.size();
+size_t AutoConnectAux::saveElement(Stream& out, std::vector<String> const& names, const bool compact) {
   size_t  size_n = 0;
+  bool    first = true;
 
-  // Calculate JSON buffer size
-  if (amount == 0) {
-    bufferSize += JSON_OBJECT_SIZE(4);
-    bufferSize += sizeof(AUTOCONNECT_JSON_KEY_TITLE) + _title.length() + 1 + sizeof(AUTOCONNECT_JSON_KEY_URI) + _uri.length() + 1 + sizeof(AUTOCONNECT_JSON_KEY_RESPONSE) + sizeof(AUTOCONNECT_JSON_KEY_MENU) + sizeof(AUTOCONNECT_JSON_KEY_ELEMENT) + sizeof(AUTOCONNECT_JSON_KEY_AUTH) + sizeof(AUTOCONNECT_JSON_VALUE_DIGEST);
-    bufferSize += JSON_ARRAY_SIZE(_addonElm.size());
+  if (names.size() == 1) {
+    AutoConnectElement* elm = getElement(names[0]);
+    return elm ? _saveElement(out, *elm, 0, true) : out.print(F("{}"));
   }
-  else
-    bufferSize += JSON_ARRAY_SIZE(amount);
-
-  for (AutoConnectElement& elmEach : _addonElm) {
-    AutoConnectElement* elm = &elmEach;
-    if (amount > 0) {
-      String& elmName = elm->name;
-      auto aim = std::find_if(names.begin(), names.end(), [&](const String& n) { return n.equalsIgnoreCase(elmName); });
-      if (aim == names.end())
-        continue;
+
+  if (names.size() == 0) {
+    size_n += out.print('{');
+    size_n += _saveMember(out, F(AUTOCONNECT_JSON_KEY_TITLE), 1, compact, true);
+    size_n += _saveString(out, _title);
+    size_n += _saveMember(out, F(AUTOCONNECT_JSON_KEY_URI), 1, compact);
+    size_n += _saveString(out, _uri);
+    if (_cors) {
+      size_n += _saveMember(out, F(AUTOCONNECT_JSON_KEY_CORS), 1, compact);
+      size_n += out.print(F("true"));
     }
-    bufferSize += elm->getObjectSize();
-  }
-  // Round up to 16 boundary
-  bufferSize = bufferSize > 0 ? ((bufferSize + 16) & (~0xf)) : bufferSize;
-  AC_DBG("JSON buffer size:%d\n", bufferSize);
-
-  // Serialization
-  if (bufferSize > 0) {
-    ArduinoJsonBuffer jb(bufferSize);
-    if (amount == 1) {
-      ArduinoJsonObject element = ARDUINOJSON_CREATEOBJECT(jb);
-      for (AutoConnectElement& elm : _addonElm)
-        if (elm.name.equalsIgnoreCase(names[0])) {
-          elm.serialize(element);
-          break;
-        }
-      size_n = ARDUINOJSON_PRINT(element, out);
+    if (_responsive) {
+      size_n += _saveMember(out, F(AUTOCONNECT_JSON_KEY_RESPONSE), 1, compact);
+      size_n += out.print(F("true"));
     }
-    else if (amount == 0) {
-      ArduinoJsonObject json = ARDUINOJSON_CREATEOBJECT(jb);
-      json[F(AUTOCONNECT_JSON_KEY_TITLE)] = _title;
-      json[F(AUTOCONNECT_JSON_KEY_URI)] = _uri;
-      if (_cors)
-        json[F(AUTOCONNECT_JSON_KEY_CORS)] = _cors;
-      if (_responsive)
-        json[F(AUTOCONNECT_JSON_KEY_RESPONSE)] = _responsive;
-      json[F(AUTOCONNECT_JSON_KEY_MENU)] = _menu;
-      if (_httpAuth == AC_AUTH_BASIC)
-        json[F(AUTOCONNECT_JSON_KEY_AUTH)] = String(F(AUTOCONNECT_JSON_VALUE_BASIC));
-      else if (_httpAuth == AC_AUTH_DIGEST)
-        json[F(AUTOCONNECT_JSON_KEY_AUTH)] = String(F(AUTOCONNECT_JSON_VALUE_DIGEST));
-      ArduinoJsonArray  elements = json.createNestedArray(F(AUTOCONNECT_JSON_KEY_ELEMENT));
-      for (AutoConnectElement& elm : _addonElm) {
-        ArduinoJsonObject element = elements.createNestedObject();
-        elm.serialize(element);
+    size_n += _saveMember(out, F(AUTOCONNECT_JSON_KEY_MENU), 1, compact);
+    size_n += _menu ? out.print(F("true")) : out.print(F("false"));
+    if (_httpAuth == AC_AUTH_BASIC || _httpAuth == AC_AUTH_DIGEST) {
+      size_n += _saveMember(out, F(AUTOCONNECT_JSON_KEY_AUTH), 1, compact);
+      size_n += _saveString(out, _httpAuth == AC_AUTH_BASIC ? String(F(AUTOCONNECT_JSON_VALUE_BASIC)) : String(F(AUTOCONNECT_JSON_VALUE_DIGEST)));
+    }
+    size_n += _saveMember(out, F(AUTOCONNECT_JSON_KEY_ELEMENT), 1, compact);
+    size_n += out.print('[');
+    for (AutoConnectElement& elm : _addonElm) {
+      size_n += _saveBreak(out, 2, compact, first);
+      size_n += _saveElement(out, elm, 2, compact);
+      first = false;
+    }
+    if (!first)
+      size_n += _saveBreak(out, 1, compact, true);
+    size_n += out.print(']');
+    size_n += _saveBreak(out, 0, compact, true);
+    size_n += out.print('}');
+  }
+  else {
+    size_n += out.print('[');
+    for (const String& name : names) {
+      AutoConnectElement* elm = getElement(name);
+      if (elm) {
+        size_n += _saveBreak(out, 1, compact, first);
+        size_n += _saveElement(out, *elm, 1, compact);
+        first = false;
       }
-      size_n = ARDUINOJSON_PRETTYPRINT(json, out);
     }
-    else if (amount >= 2) {
-      ArduinoJsonArray  elements = ARDUINOJSON_CREATEARRAY(jb);
-      for (String name : names)
-        for (AutoConnectElement& elm : _addonElm)
-          if (elm.name.equalsIgnoreCase(name)) {
-            ArduinoJsonObject element = elements.createNestedObject();
-            elm.serialize(element);
-            break;
-          }
-      size_n = ARDUINOJSON_PRETTYPRINT(elements, out);
+    if (!first)
+      size_n += _saveBreak(out, 0, compact, true);
+    size_n += out.print(']');
+  }
+  return size_n;
+}
+
+/**
+ * Serialize an element into the stream through the JsonDocument that
+ * only holds the element.
+ * @param  out     Stream to be output.
+ * @param  elm     The element to be output.
+ * @param  depth   Nesting depth at which the element is placed.
+ * @param  compact Output without the indentation and the line breaks.
+ * @return Number of bytes output
+ */
+size_t AutoConnectAux::_saveElement(Print& out, AutoConnectElement& elm, const uint8_t depth, const bool compact) {
+  // Round up to 16 boundary
+  ArduinoJsonBuffer jb((elm.getObjectSize() + 16) & (~0xf));
+  ArduinoJsonObject element = ARDUINOJSON_CREATEOBJECT(jb);
+  elm.serialize(element);
+  if (compact)
+    return ARDUINOJSON_PRINT(element, out);
+  AutoConnectJsonIndent indent(out, depth);
+  (void)ARDUINOJSON_PRETTYPRINT(element, indent);
+  return indent.written;
+}
+
+/**
+ * Write the separator preceding a value in an object or an array, and
+ * the line break with the indentation if not compact.
+ * @param  out     Stream to be output.
+ * @param  depth   Nesting depth of the following value.
+ * @param  compact Output without the indentation and the line breaks.
+ * @param  first   The following value is the first of the container,
+ * or the closing bracket follows.
+ * @return Number of bytes output
+ */
+size_t AutoConnectAux::_saveBreak(Print& out, const uint8_t depth, const bool compact, const bool first) {
+  size_t  size_n = first ? 0 : out.print(',');
+  if (!compact) {
+    size_n += out.print(F(AUTOCONNECT_JSON_NEWLINE));
+    for (uint8_t d = 0; d < depth; d++)
+      size_n += out.print(F("  "));
+  }
+  return size_n;
+}
+
+/**
+ * Write the key of an object member.
+ * @param  out     Stream to be output.
+ * @param  key     The key of the member.
+ * @param  depth   Nesting depth of the member.
+ * @param  compact Output without the indentation and the line breaks.
+ * @param  first   The member is the first of the object.
+ * @return Number of bytes output
+ */
+size_t AutoConnectAux::_saveMember(Print& out, const __FlashStringHelper* key, const uint8_t depth, const bool compact, const bool first) {
+  size_t  size_n = _saveBreak(out, depth, compact, first);
+  size_n += out.print('"');
+  size_n += out.print(key);
+  size_n += compact ? out.print(F("\":")) : out.print(F("\": "));
+  return size_n;
+}
+
+/**
+ * Write a string as a JSON string literal with escaping the characters
+ * in the same manner as ArduinoJson.
+ * @param  out   Stream to be output.
+ * @param  str   The string to be output.
+ * @return Number of bytes output
+ */
+size_t AutoConnectAux::_saveString(Print& out, const String& str) {
+  static const char escapes[] PROGMEM = "\"\"\\\\b\bf\fn\nr\rt\t";
+  size_t  size_n = out.print('"');
+  for (unsigned int i = 0; i < str.length(); i++) {
+    char  c = str[i];
+    char  escaped = 0;
+    for (uint8_t e = 0; e < sizeof(escapes) - 1; e += 2)
+      if (static_cast<char>(pgm_read_byte(escapes + e + 1)) == c) {
+        escaped = static_cast<char>(pgm_read_byte(escapes + e));
+        break;
+      }
+    if (escaped) {
+      size_n += out.print('\\');
+      size_n += out.print(escaped);
     }
+    else
+      size_n += out.print(c);
   }
+  size_n += out.print('"');
   return size_n;
 }
 
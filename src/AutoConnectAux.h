@@ -19,8 +19,12 @@
 #endif // !AUTOCONNECT_USE_JSON
 #include <PageBuilder.h>
 #include "AutoConnectDefs.h"
+#ifdef AUTOCONNECT_USE_AUXEVENT
+#include <WiFiClient.h>
+#endif
 #include "AutoConnectTypes.h"
 #include "AutoConnectElement.h"
+#include "AutoConnectArena.h"
 #include "AutoConnectConfigExt.h"
 
 // Reference to avoid circular.
@@ -55,6 +59,12 @@ class AutoConnectAux : public PageBuilder {
  public:
   explicit AutoConnectAux(const String& uri = String(""), const String& title = String(""), const bool menu = true, const AutoConnectElementVT addons = AutoConnectElementVT(), const bool responsive = true, const bool CORS = false);
   ~AutoConnectAux();
+#ifdef AUTOCONNECT_USE_AUXARENA
+  // The elements in the arena are destructed with the page, so a copy
+  // would refer to them after the original has gone.
+  AutoConnectAux(const AutoConnectAux&) = delete;
+  AutoConnectAux& operator=(const AutoConnectAux&) = delete;
+#endif
   AutoConnectElement& operator[](const char* name) { return *getElement(name); }
   AutoConnectElement& operator[](const __FlashStringHelper* name) { return *getElement(name); }
   AutoConnectElement& operator[](const String& name) { return *getElement(name); }
@@ -73,7 +83,12 @@ class AutoConnectAux : public PageBuilder {
   AutoConnectElement*   getElement(const char* name);                   /**< Get registered AutoConnectElement as specified name */
   AutoConnectElement*   getElement(const __FlashStringHelper* name);    /**< Get registered AutoConnectElement as specified name */
   AutoConnectElement*   getElement(const String& name);                 /**< Get registered AutoConnectElement as specified name */
-  AutoConnectElementVT& getElements(void) { return _addonElm; }         /**< Get vector of all elements */
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  AutoConnectElementVT& getElements(void) { _exposeElements(); return _addonElm; } /**< Get vector of all elements, it may be modified */
+#else
+  AutoConnectElementVT& getElements(void) { return _addonElm; }         /**< Get vector of all elements, it may be modified */
+#endif
+  const AutoConnectElementVT& getElements(void) const { return _addonElm; } /**< Get vector of all elements */
   void  menu(const bool post) { _menu = post; }                         /**< Set or reset the display as menu item for this aux */
   bool  isMenu(void) { return _menu; }                                  /**< Return whether embedded in the menu or not */
   bool  isValid(void) const;                                            /**< Validate all AutoConnectInput value */
@@ -83,13 +98,18 @@ class AutoConnectAux : public PageBuilder {
   bool  setElementValue(const String& name, std::vector<String> const& values);  /**< Set values collection to specified element */
   void  setTitle(const String& title) { _title = title; }               /**< Set a title of the auxiliary page */
   void  on(const AuxHandlerFunctionT handler, const AutoConnectExitOrder_t order = AC_EXIT_AHEAD) { _handler = handler; _order = order; }   /**< Set user handler */
-  void  onUpload(PageBuilder::UploadFuncT uploadFunc) override { _uploadHandler = uploadFunc; }
+  void  onUpload(PageBuilder::UploadFuncT uploadFunc) override { _uploadHandler = uploadFunc; _uploadClass = nullptr; }
   template<typename T>
   void  onUpload(T& uploadClass) {
     static_assert(std::is_base_of<AutoConnectUploadHandler, T>::value, "onUpload type must be inherited AutoConnectUploadHandler");
     _uploadHandler = std::bind(&T::upload, &uploadClass, std::placeholders::_1, std::placeholders::_2);
+    _uploadClass = &uploadClass;
   }
   AutoConnectAux& referer(void);
+#ifdef AUTOCONNECT_USE_AUXEVENT
+  void  eventSource(const bool enable) { _eventSource = enable; }       /**< Let the page subscribe to its event stream */
+  size_t  push(void);                                                   /**< Push the element responses to the subscribed browsers */
+#endif
 
 #ifdef AUTOCONNECT_USE_JSON
   bool  load(PGM_P in, const size_t docSize = AUTOCONNECT_JSONDOCUMENT_SIZE);                       /**< Load whole elements to AutoConnectAux Page */
@@ -104,7 +124,7 @@ class AutoConnectAux : public PageBuilder {
   bool  loadElement(const String& in, std::vector<String> const& names, const size_t docSize = AUTOCONNECT_JSONDOCUMENT_SIZE);/**< Load any specified elements */
   bool  loadElement(Stream& in, const String& name = String(""), const size_t docSize = AUTOCONNECT_JSONDOCUMENT_SIZE);       /**< Load specified element */
   bool  loadElement(Stream& in, std::vector<String> const& names, const size_t docSize = AUTOCONNECT_JSONDOCUMENT_SIZE);      /**< Load any specified elements */
-  size_t  saveElement(Stream& out, std::vector<String> const& names = {});  /**< Write elements of AutoConnectAux to the stream */
+  size_t  saveElement(Stream& out, std::vector<String> const& names = {}, const bool compact = false);  /**< Write elements of AutoConnectAux to the stream */
 #endif // !AUTOCONNECT_USE_JSON
 
   // Attribute definition of the element to be placed on the update page.
@@ -123,10 +143,69 @@ class AutoConnectAux : public PageBuilder {
     const ACElementProp_t* element;
   } ACPage_t;
 
+  // Bits of the attributes that the descriptors compiled from JSON
+  // specify, the attribute without the bit keeps the current value.
+  typedef enum {
+    AC_DESC_POST     = 0x0001,  /**< post */
+    AC_DESC_GLOBAL   = 0x0002,  /**< global */
+    AC_DESC_OPTION   = 0x0004,  /**< apply, store, arrange, labelposition or magnify */
+    AC_DESC_CHECKED  = 0x0008,  /**< checked or selected */
+    AC_DESC_ITEMS    = 0x0010,  /**< value of Radio, option of Select */
+    AC_DESC_VALUE    = 0x0020,  /**< value of Range */
+    AC_DESC_MIN      = 0x0040,  /**< min of Range */
+    AC_DESC_MAX      = 0x0080,  /**< max of Range */
+    AC_DESC_STEP     = 0x0100,  /**< step of Range */
+    AC_DESC_MENU     = 0x0200,  /**< menu of the page */
+    AC_DESC_CORS     = 0x0400,  /**< cors of the page */
+    AC_DESC_RESPONSE = 0x0800,  /**< response of the page */
+    AC_DESC_AUTH     = 0x1000   /**< auth of the page */
+  } ACDescAttr_t;
+
+  // Attribute definition of the element compiled from JSON by the
+  // extras/auxcompiler tool. The strings are nullptr if omitted.
+  typedef struct {
+    ACElement_t  type;
+    const char*  name;        /**< Name to assign to AutoConnectElement */
+    const char*  value;       /**< Value owned by an element */
+    const char*  label;       /**< Label of the element */
+    const char*  peculiar;    /**< Button action, Input pattern, Submit uri, Text format or NUL-separated items of Radio and Select */
+    const char*  placeholder; /**< Placeholder of Input */
+    const char*  style;       /**< Style of Input, Range and Text */
+    uint16_t     items;       /**< Number of the items of Radio and Select */
+    uint16_t     attr;        /**< Bits of ACDescAttr_t that are specified */
+    uint8_t      post;        /**< ACPosterior_t */
+    uint8_t      option;      /**< ACInput_t, ACFile_t, ACArrange_t or ACPosition_t */
+    uint8_t      checked;     /**< Checked state or index, selected index */
+    bool         global;      /**< The value available in global scope */
+    int          range[4];    /**< Value, min, max and step of Range */
+  } ACElementDesc_t;
+
+  // Attributes of the page compiled from JSON by extras/auxcompiler.
+  typedef struct {
+    const char*  uri;         /**< URI for the page */
+    const char*  title;       /**< Menu title of the page */
+    uint16_t     attr;        /**< Bits of ACDescAttr_t that are specified */
+    bool         menu;        /**< Whether to display in menu */
+    bool         cors;        /**< Allow CORS */
+    bool         responsive;  /**< Whether to make HTTP response */
+    uint8_t      auth;        /**< AC_AUTH_t */
+    size_t       elementNum;  /**< Number of the elements */
+    const ACElementDesc_t* element;
+  } ACPageDesc_t;
+
+  bool  load(const ACPageDesc_t& page);                                 /**< Load the page compiled into PROGMEM */
+
  protected:
   void  upload(const String& requestUri, const HTTPUpload& upload);     /**< Uploader wrapper */
   void  _concat(AutoConnectAux& aux);                                   /**< Make up chain of AutoConnectAux */
   String  _fetchEndpoint(PageArgument& args);
+  size_t  _sendResponse(char* buffer, const size_t size);                /**< Send the element responses to the Fetch request */
+  size_t  _writeResponse(char* buffer, const size_t size, const std::function<void(const char*, const size_t)>& write);  /**< Write the element responses as JSON array */
+#ifdef AUTOCONNECT_USE_AUXEVENT
+  String  _eventEndpoint(PageArgument& args);                           /**< Accept the subscription to the event stream */
+  void  _writeEvent(const char* content, const size_t len);             /**< Write the event to the subscribers */
+  void  _keepAlive(void);                                               /**< Send the heartbeat to the subscribers */
+#endif
   const String  _indicateEncType(PageArgument& args);                   /**< Inject the ENCTYPE attribute */
   const String  _indicateUri(PageArgument& args);                       /**< Inject the uri that caused the request */
   const String  _injectMenu(PageArgument& args);                        /**< Inject menu title of this page to PageBuilder */
@@ -141,6 +220,21 @@ class AutoConnectAux : public PageBuilder {
   template<typename T>
   bool  _isCompatible(const AutoConnectElement* element) const;         /**< Validate a type of AutoConnectElement entity conformity */
   static AutoConnectElement&  _nullElement(void);                       /**< A static returning value as invalid */
+  AutoConnectElement* _findElement(PGM_P name, const bool progmem);    /**< Look up an element by the name either in RAM or PROGMEM */
+  static bool _setValue(AutoConnectElement& element, const String& value);  /**< Set the value to the element according to its type */
+  AutoConnectElement* _createElement(const ACElement_t type);           /**< Create an AutoConnectElement instance of the type */
+  template<typename T>
+  T*    _newElement(void);                                              /**< Construct an element of the type owned by the page */
+  AutoConnectElement& _loadElement(const ACElementDesc_t& desc);        /**< Load an element from the descriptor in PROGMEM */
+  static bool _applyDesc(AutoConnectElement& element, const ACElementDesc_t& desc);  /**< Apply the descriptor attributes to the element */
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  void  _indexElement(AutoConnectElement& element);                     /**< Register an element to the name index */
+  void  _indexElements(void);                                           /**< Rebuild the name index of all elements */
+  void  _exposeElements(void);                                          /**< Start tracking the vector handed out by getElements */
+  uint32_t  _printElements(void) const;                                 /**< Fingerprint of the elements vector */
+  uint32_t  _currentGeneration(void);                                   /**< The generation including the changes through getElements */
+  static uint32_t _hashName(PGM_P name, const bool progmem);            /**< Case-insensitive hash of the element name */
+#endif
 
 #ifdef AUTOCONNECT_USE_JSON
   bool  _load(JsonObject& in);                                          /**< Load all elements from JSON object */
@@ -149,6 +243,16 @@ class AutoConnectAux : public PageBuilder {
   AutoConnectElement& _loadElement(JsonObject& in, const String& name); /**< Load an element as specified name from JSON object */
   AutoConnectElement* _createElement(const JsonObject& json);           /**< Create an AutoConnectElement instance from JSON object */
   static ACElement_t  _asElementType(const String& type);               /**< Convert a string of element type to the enumeration value */
+  bool  _streamPage(Stream& in, const size_t size = AUTOCONNECT_JSONBUFFER_PRIMITIVE_SIZE); /**< Load a page from the stream element by element */
+  bool  _streamElement(Stream& in, const size_t size, const std::function<bool(JsonVariant&)>& load); /**< Parse the elements of the stream one at a time */
+  static int  _peekJson(Stream& in);                                    /**< Peek the next JSON character skipping whitespace */
+  static int  _timedPeek(Stream& in);                                   /**< Peek a character waiting for the stream timeout */
+  static int  _timedRead(Stream& in);                                   /**< Read a character waiting for the stream timeout */
+  static bool _readJson(Stream& in, String& text);                      /**< Read one JSON value from the stream as raw text */
+  static size_t _saveElement(Print& out, AutoConnectElement& elm, const uint8_t depth, const bool compact);  /**< Serialize an element through its own JsonDocument */
+  static size_t _saveBreak(Print& out, const uint8_t depth, const bool compact, const bool first);  /**< Write the separator and the indentation */
+  static size_t _saveMember(Print& out, const __FlashStringHelper* key, const uint8_t depth, const bool compact, const bool first = false);  /**< Write the key of an object member */
+  static size_t _saveString(Print& out, const String& str);             /**< Write a string as JSON string literal */
   /**
    * Parse and load a JSON document which marks up a custom web page.
    * The compiler instantiates this template according to the stored data
@@ -213,19 +317,41 @@ class AutoConnectAux : public PageBuilder {
   String  _title;                             /**< A title of the page */
   bool    _menu;                              /**< Switch for menu displaying */
   bool    _deletable = false;                 /**< Allow deleting itself. */
+  bool    _disposable = false;                /**< Created by AutoConnect::load, deleted by detach on request */
   bool    _responsive;                        /**< Whether suppress the sending of HTTP response in PageBuilder */
   uint16_t  _contains;                        /**< Bitmask the type of elements this page contains */
   AC_AUTH_t _httpAuth = AC_AUTH_NONE;         /**< Applying HTTP authentication */
   AutoConnectElementVT  _addonElm;            /**< A vector set of AutoConnectElements placed on this auxiliary page */
+  uint32_t  _generation = 1;                  /**< Bumped whenever the elements may have changed */
+#ifdef AUTOCONNECT_USE_AUXARENA
+  AutoConnectArena      _arena;               /**< Storage of the elements created by loading */
+#endif
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  typedef std::pair<uint32_t, AutoConnectElement*>  AC_ELEMENTINDEX_t;  /**< Hash of the element name and the element */
+  std::vector<AC_ELEMENTINDEX_t>  _elmIndex;  /**< Elements sorted by the name hash */
+  uint32_t  _indexGeneration = 0;             /**< The generation that _elmIndex reflects */
+  bool      _exposed = false;                 /**< The elements vector has been handed out by getElements */
+  uint32_t  _exposedPrint = 0;                /**< Fingerprint of the elements vector at the current generation */
+#endif
   AutoConnectAux*       _next = nullptr;      /**< Auxiliary pages chain list */
   AutoConnectExt<AutoConnectConfigExt>* _ac = nullptr;  /**< Hosted AutoConnect instance */
   AuxHandlerFunctionT   _handler;             /**< User sketch callback function when AutoConnectAux page requested. */
   AutoConnectExitOrder_t  _order;             /**< The order in which callback functions are called. */
   PageBuilder::UploadFuncT  _uploadHandler;   /**< The AutoConnectFile corresponding to current upload */
   AutoConnectFile*      _currentUpload;       /**< AutoConnectFile handling the current upload */
+  AutoConnectUploadHandler* _uploadClass = nullptr; /**< The upload handler class registered by onUpload */
+#ifdef AUTOCONNECT_USE_AUXEVENT
+  bool  _eventSource = false;                 /**< The page subscribes to its event stream */
+  std::vector<WiFiClient> _subscribers;       /**< Browsers subscribing to the event stream */
+  unsigned long _heartbeat = 0;               /**< Time of the last event written */
+#endif
   static const char _PAGE_AUX[] PROGMEM;      /**< Auxiliary page template */
   static const char _PAGE_SCRIPT_MA[] PROGMEM; /**< Auxiliary page javascript for ACRange */
   static const char _PAGE_SCRIPT_FE[] PROGMEM; /**< Auxiliary page javascript for Fetch */
+  static const char _PAGE_SCRIPT_RE[] PROGMEM; /**< Auxiliary page javascript applying the responses */
+#ifdef AUTOCONNECT_USE_AUXEVENT
+  static const char _PAGE_SCRIPT_ES[] PROGMEM; /**< Auxiliary page javascript for the event stream */
+#endif
 
   // Protected members can be used from AutoConnect which handles AutoConnectAux pages.
   friend class AutoConnectExt<AutoConnectConfigExt>;
@@ -273,6 +273,7 @@ class AutoConnectCore {
   virtual inline void _enableUpdate(void) {}
   virtual inline bool _handleOTA(void) { return false; }
   virtual inline bool _handleUpdate(void) { return false; }
+  virtual inline void _handleEvent(void) {}
   virtual inline void _registerOnUpload(PageBuilder* page) { AC_UNUSED(page); }
   virtual inline void _releaseAux(const String& uri) { AC_UNUSED(uri); }
   virtual inline void _saveCurrentUri(const String& uri) { AC_UNUSED(uri); }
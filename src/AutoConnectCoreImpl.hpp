@@ -517,8 +517,12 @@ bool AutoConnectCore<T>::getCurrentCredential(station_config_t* staConfig) {
 template<typename T>
 uint16_t AutoConnectCore<T>::getEEPROMUsedSize(void) {
 #if defined(ARDUINO_ARCH_ESP8266)
+#if AC_CREDENTIAL_PREFERENCES == 0
   AutoConnectCredential credentials(_apConfig.boundaryOffset);
   return _apConfig.boundaryOffset + credentials.dataSize();
+#else
+  return _apConfig.boundaryOffset;
+#endif
 #elif defined(ARDUINO_ARCH_ESP32)
   return 0;
 #endif
@@ -767,6 +771,9 @@ void AutoConnectCore<T>::handleRequest(void) {
   // Post-process for AutoConnectOTA
   skipPostTicker = _handleOTA();
 
+  // Keep the event streams of AutoConnectAux pages alive.
+  _handleEvent();
+
   // Post-process for ticker
   // Adjust the ticker cycle to the latest WiFi connection state.
   if (_ticker && !skipPostTicker) {
@@ -990,8 +997,8 @@ bool AutoConnectCore<T>::_seekCredential(const AC_PRINCIPLE_t principle, const A
     else {
       // Seek valid configuration according to the WiFi connection principle.
       // Verify that an available SSIDs meet AC_PRINCIPLE_t requirements.
-      for (uint8_t i = 0; i < credential.entries(); i++) {
-        credential.load(i, &_credential);
+      for (const station_config_t& entry : credential) {
+        memcpy(&_credential, &entry, sizeof(station_config_t));
         // The access point collation key is determined at compile time
         // according to the AUTOCONNECT_APKEY_SSID definition, which is
         // either BSSID or SSID.
@@ -7,8 +7,168 @@
  *	@copyright	MIT license.
  */
 
+#include <new>
 #include "AutoConnectCredential.h"
 
+/**
+ *  Calculate CRC-32 (IEEE 802.3) of the data. It can be calculated
+ *  continuously by passing the previous result to crc.
+ *  @param  data    Data to be calculated.
+ *  @param  length  Length of the data.
+ *  @param  crc     The previous CRC to continue the calculation.
+ *  @return CRC-32
+ */
+uint32_t AutoConnectCredentialBase::_crc32(const void* data, const size_t length, const uint32_t crc) {
+  const uint8_t*  dp = static_cast<const uint8_t*>(data);
+  uint32_t  cr = ~crc;
+
+  for (size_t n = 0; n < length; n++) {
+    cr ^= *dp++;
+    for (uint8_t b = 0; b < 8; b++)
+      cr = (cr >> 1) ^ (0xedb88320U & (0U - (cr & 1U)));
+  }
+  return ~cr;
+}
+
+/**
+ *  Export all credentials to the stream in the exchange format that is
+ *  independent of the storage backend. The entries are streamed one by
+ *  one without buffering the whole credentials.
+ *   0      7 8 9a                                  (t)
+ *  +--------+-+--+-+----+-+----+-----+-+---------+--+----+
+ *  |AC_CREDT|v|nn|l|ssid|l|pass|bssid|d|ip..dns2 |..|crc |
+ *  +--------+-+--+-+----+-+----+-----+-+---------+--+----+
+ *  AC_CREDT : Identifier. 8 characters.
+ *  v  : Version of the exchange format, AC_CREDT_EXCHANGE(uint8_t).
+ *  nn : Number of entries(uint16_t, little endian).
+ *  l  : Length of the following ssid or password without '\0'(uint8_t).
+ *  bssid : BSSID 6 bytes.
+ *  d  : DHCP is in available. 0:DHCP 1:Static IP
+ *  ip - dns2 : Static IPs(uint32_t, little endian), only for d=1.
+ *  crc : CRC-32 of the whole stream before it(uint32_t, little endian).
+ *  @param  out   Output destination stream.
+ *  @retval true  All credentials exported.
+ *  @retval false Could not export.
+ */
+bool AutoConnectCredentialBase::exportTo(Stream& out) {
+  uint32_t  crc = 0;
+  bool      rc = true;
+  auto put = [&](const void* data, const size_t len) {
+    rc &= out.write(static_cast<const uint8_t*>(data), len) == len;
+    crc = _crc32(data, len, crc);
+  };
+  auto putInt = [&](uint32_t value, const size_t len) {
+    uint8_t le[sizeof(uint32_t)];
+    for (uint8_t b = 0; b < len; b++, value >>= 8)
+      le[b] = static_cast<uint8_t>(value);
+    put(le, len);
+  };
+
+  const uint16_t  count = entries();
+  uint16_t  n = 0;
+  put(AC_IDENTIFIER, sizeof(AC_IDENTIFIER) - sizeof('\0'));
+  putInt(AC_CREDT_EXCHANGE, sizeof(uint8_t));
+  putInt(count, sizeof(uint16_t));
+  // Every exit from the loop goes through the destruction of the
+  // iterator, which releases the storage even if the output fails.
+  for (iterator it = begin(); rc && n < count && it != end(); ++it, n++) {
+    const station_config_t& config = *it;
+    const size_t  ssidLen = strnlen(reinterpret_cast<const char*>(config.ssid), sizeof(station_config_t::ssid));
+    const size_t  passLen = strnlen(reinterpret_cast<const char*>(config.password), sizeof(station_config_t::password));
+    putInt(ssidLen, sizeof(uint8_t));
+    put(config.ssid, ssidLen);
+    putInt(passLen, sizeof(uint8_t));
+    put(config.password, passLen);
+    put(config.bssid, sizeof(station_config_t::bssid));
+    put(&config.dhcp, sizeof(station_config_t::dhcp));
+    if (config.dhcp == (uint8_t)STA_STATIC) {
+      for (uint8_t e = 0; e < sizeof(station_config_t::_config::addr) / sizeof(uint32_t); e++)
+        putInt(config.config.addr[e], sizeof(uint32_t));
+    }
+  }
+  putInt(crc, sizeof(uint32_t));
+
+  if (n != count) {
+    AC_DBG("Exported %" PRIu16 " of %" PRIu16 " credentials\n", n, count);
+    rc = false;
+  }
+  return rc;
+}
+
+/**
+ *  Import credentials from the stream in the exchange format and save
+ *  them with a single commit. Nothing is saved unless the whole stream
+ *  is verified with its CRC. The stream that has more entries than the
+ *  storage can hold, or than the heap allows, is rejected.
+ *  @param  in    Input stream.
+ *  @retval true  Credentials imported.
+ *  @retval false Could not import.
+ */
+bool AutoConnectCredentialBase::importFrom(Stream& in) {
+  uint32_t  crc = 0;
+  auto get = [&](void* data, const size_t len) -> bool {
+    if (in.readBytes(static_cast<char*>(data), len) != len)
+      return false;
+    crc = _crc32(data, len, crc);
+    return true;
+  };
+  auto getInt = [&](uint32_t* value, const size_t len) -> bool {
+    uint8_t le[sizeof(uint32_t)];
+    if (!get(le, len))
+      return false;
+    *value = 0;
+    for (size_t b = len; b > 0; b--)
+      *value = (*value << 8) | le[b - 1];
+    return true;
+  };
+
+  char      id[sizeof(AC_IDENTIFIER) - sizeof('\0')];
+  uint32_t  version, count;
+  if (!get(id, sizeof(id)) || memcmp(id, AC_IDENTIFIER, sizeof(id)) ||
+      !getInt(&version, sizeof(uint8_t)) || version != AC_CREDT_EXCHANGE ||
+      !getInt(&count, sizeof(uint16_t))) {
+    AC_DBG("Credentials stream has no " AC_IDENTIFIER "\n");
+    return false;
+  }
+
+  // Reject the count that the storage cannot hold before allocating
+  // the entries, and fail without aborting if the heap runs short.
+  if (count > _capacity()) {
+    AC_DBG("Credentials stream has %u entries, exceeds %u\n", count, _capacity());
+    return false;
+  }
+  std::unique_ptr<station_config_t[]>  configs(new (std::nothrow) station_config_t[count]);
+  if (!configs) {
+    AC_DBG("Credentials %u entries allocation failed\n", count);
+    return false;
+  }
+  for (uint32_t n = 0; n < count; n++) {
+    station_config_t& config = configs[n];
+    uint32_t  len;
+    memset(&config, 0x00, sizeof(station_config_t));
+    bool  rc = getInt(&len, sizeof(uint8_t)) && len <= sizeof(station_config_t::ssid) && get(config.ssid, len) &&
+               getInt(&len, sizeof(uint8_t)) && len <= sizeof(station_config_t::password) && get(config.password, len) &&
+               get(config.bssid, sizeof(station_config_t::bssid)) &&
+               get(&config.dhcp, sizeof(station_config_t::dhcp));
+    if (rc && config.dhcp == (uint8_t)STA_STATIC) {
+      for (uint8_t e = 0; rc && e < sizeof(station_config_t::_config::addr) / sizeof(uint32_t); e++)
+        rc = getInt(&config.config.addr[e], sizeof(uint32_t));
+    }
+    if (!rc) {
+      AC_DBG("Credentials stream corrupted at #%u\n", n);
+      return false;
+    }
+  }
+
+  const uint32_t  sum = crc;
+  uint32_t  streamCrc;
+  if (!getInt(&streamCrc, sizeof(uint32_t)) || streamCrc != sum) {
+    AC_DBG("Credentials stream CRC mismatch\n");
+    return false;
+  }
+  return count ? saveAll(configs.get(), count) : true;
+}
+
 #if AC_CREDENTIAL_PREFERENCES == 0
 
 #define AC_HEADERSIZE ((int)(_offset + sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t) + sizeof(uint16_t)))
@@ -37,6 +197,10 @@
  *  The AC_CREDT identifier is at the beginning of the area.
  *  SSID and PASSWORD are terminated by '\ 0'.
  *  Free area are filled with FF, which is reused as an area for insertion.
+ *  The EEPROM container keeps the version 1 layout. When it holds 255
+ *  entries or more, 'e' is AC_CREDT_EXTENDED and the number of entries
+ *  is counted from the container instead. A container of exactly 255
+ *  entries saved by earlier versions is read in the same way.
  */
 AutoConnectCredential::AutoConnectCredential() {
   _offset = AC_IDENTIFIER_OFFSET;
@@ -71,6 +235,14 @@ void AutoConnectCredential::_allocateEntry(void) {
     _containSize = 0;
   }
   _eeprom->end();
+
+  // The 8-bit header saturates, count the entries in the container.
+  if (_entries == AC_CREDT_EXTENDED) {
+    _eeprom->begin(AC_HEADERSIZE + _containSize);
+    _entries = _countEntry();
+    _eeprom->end();
+  }
+  _seeking = false;
 }
 
 /**
@@ -110,18 +282,17 @@ bool AutoConnectCredential::del(const char* ssid) {
     for (uint8_t i = 0; i < sizeof(station_config_t::bssid); i++)
       _eeprom->write(_dp++, 0xff);
 
-    // Erase ip configuration extention
+    // Erase dhcp flag and ip configuration extention
     uint8_t dhcp = _eeprom->read(_dp);
+    _eeprom->write(_dp++, 0xff);
     if (dhcp == (uint8_t)STA_STATIC) {
       for (uint8_t i = 0; i < sizeof(station_config_t::_config); i++)
         _eeprom->write(_dp++, 0xff);
     }
-    else if (dhcp == (uint8_t)STA_DHCP)
-        _eeprom->write(_dp++, 0xff);
 
     // End 0xff writing, update headers.
     _entries--;
-    _eeprom->write(_offset + static_cast<int>(sizeof(AC_IDENTIFIER)) - 1, _entries);
+    _writeEntries();
 
     // commit it.
     rc = _eeprom->commit();
@@ -140,19 +311,13 @@ bool AutoConnectCredential::del(const char* ssid) {
  *  @retval The entry number of the SSID in EEPROM. If the number less than 0,
  *  the specified SSID was not found.
  */
-int8_t AutoConnectCredential::load(const char* ssid, station_config_t* config) {
-  int8_t  entry = -1;
+int32_t AutoConnectCredential::load(const char* ssid, station_config_t* config) {
+  int32_t entry = -1;
 
   _dp = AC_HEADERSIZE;
   if (_entries) {
     _eeprom->begin(AC_HEADERSIZE + _containSize);
-    for (uint8_t i = 0; i < _entries; i++) {
-      _retrieveEntry(config);
-      if (!strcmp(ssid, reinterpret_cast<const char*>(config->ssid))) {
-        entry = i;
-        break;
-      }
-    }
+    entry = _locate(ssid, config);
     _eeprom->end();
   }
   return entry;
@@ -167,12 +332,13 @@ int8_t AutoConnectCredential::load(const char* ssid, station_config_t* config) {
  *  @retval true    The entry number of the SSID in EEPROM.
  *          false   The number is not available.
  */
-bool AutoConnectCredential::load(int8_t entry, station_config_t* config) {
+bool AutoConnectCredential::load(uint16_t entry, station_config_t* config) {
   _dp = AC_HEADERSIZE;
-  if (_entries && entry < _entries) {
+  if (entry < _entries) {
     _eeprom->begin(AC_HEADERSIZE + _containSize);
-    while (entry-- >= 0)
+    do {
       _retrieveEntry(config);
+    } while (entry--);
     _eeprom->end();
     return true;
   }
@@ -191,17 +357,117 @@ bool AutoConnectCredential::load(int8_t entry, station_config_t* config) {
  *  @retval false   EEPROM commit failed.
  */
 bool AutoConnectCredential::save(const station_config_t* config) {
+  return saveAll(config, 1);
+}
+
+/**
+ *  Save multiple credentials to EEPROM with a single commit. If any
+ *  of them cannot be stored, the EEPROM image is reverted before the
+ *  end of the access, since EEPROMClass::end commits the changes.
+ *  @param  configs An array of the station_config structure.
+ *  @param  n       Number of the elements in configs.
+ *  @retval true    Successfully saved.
+ *  @retval false   EEPROM commit failed.
+ */
+bool AutoConnectCredential::saveAll(const station_config_t* configs, const size_t n) {
+  // The EEPROM area is extended by the size of the entries to be saved.
+  size_t  stSize = AC_HEADERSIZE + _containSize + sizeof('\0');
+  for (size_t i = 0; i < n; i++)
+    stSize += _entrySize(&configs[i]);
+
+  // Saving start.
+  bool  rc = true;
+  _eeprom->begin(stSize);
+
+  // Keep the original image to revert. A single entry fails before
+  // writing anything, so it needs no copy.
+  std::unique_ptr<uint8_t[]>  image;
+  if (n > 1) {
+    image.reset(new (std::nothrow) uint8_t[stSize - _offset]);
+    if (!image) {
+      AC_DBG("Credential image %u bytes allocation failed\n", stSize - _offset);
+      _eeprom->end();
+      return false;
+    }
+    for (size_t dp = _offset; dp < stSize; dp++)
+      image[dp - _offset] = _eeprom->read(dp);
+  }
+
+  for (size_t i = 0; rc && i < n; i++)
+    rc = _store(&configs[i]);
+  if (rc) {
+    rc = _eeprom->commit();
+    delay(10);
+  }
+  else if (image) {
+    for (size_t dp = _offset; dp < stSize; dp++)
+      _eeprom->write(dp, image[dp - _offset]);
+  }
+  _eeprom->end();
+
+  // Revert the header with EEPROM if failed.
+  if (!rc)
+    _allocateEntry();
+  return rc;
+}
+
+/**
+ *  Seek the entry for the specified SSID in the EEPROM which has already
+ *  begun. _ep has the entry location when found.
+ *  @param  ssid    A SSID character string to be found.
+ *  @param  config  A station_config structure pointer.
+ *  @retval The entry number of the SSID in EEPROM. If the number less than 0,
+ *  the specified SSID was not found.
+ */
+int32_t AutoConnectCredential::_locate(const char* ssid, station_config_t* config) {
+  _dp = AC_HEADERSIZE;
+  for (uint16_t i = 0; i < _entries; i++) {
+    _retrieveEntry(config);
+    if (!strcmp(ssid, reinterpret_cast<const char*>(config->ssid)))
+      return i;
+  }
+  return -1;
+}
+
+#if defined(ARDUINO_ARCH_ESP8266)
+/**
+ *  The EEPROM of ESP8266 is a single flash sector, so it can hold the
+ *  entries of the minimum size as many as fit in the sector.
+ *  @return Maximum number of the entries.
+ */
+uint16_t AutoConnectCredential::_capacity(void) const {
+  return (SPI_FLASH_SEC_SIZE - AC_HEADERSIZE - sizeof('\0')) / (sizeof('\0') + sizeof('\0') + sizeof(station_config_t::bssid) + sizeof(station_config_t::dhcp));
+}
+#endif
+
+/**
+ *  Calculate the size of an entry to be stored in EEPROM.
+ *  @param  config  A pointer to the station_config structure.
+ *  @return Size of the entry.
+ */
+uint16_t AutoConnectCredential::_entrySize(const station_config_t* config) {
+  uint16_t eSize = strlen(reinterpret_cast<const char*>(config->ssid)) + strlen(reinterpret_cast<const char*>(config->password)) + sizeof(station_config_t::bssid) + sizeof(station_config_t::dhcp);
+  if (config->dhcp == (uint8_t)STA_STATIC)
+    eSize += sizeof(station_config_t::_config);
+  eSize += sizeof('\0') + sizeof('\0');
+  return eSize;
+}
+
+/**
+ *  Store SSID and password to the EEPROM which has already begun without
+ *  commit.
+ *  @param  config  A pointer to the station_config structure storing SSID and password.
+ *  @retval true    Successfully stored.
+ *  @retval false   No room for the entry.
+ */
+bool AutoConnectCredential::_store(const station_config_t* config) {
   static const char _id[] = AC_IDENTIFIER;
   station_config_t  stage;
-  int8_t  entry;
+  int32_t entry;
   bool    rep = false;
-  bool    rc;
 
   // Detect same entry for replacement.
-  entry = load(reinterpret_cast<const char*>(config->ssid), &stage);
-
-  // Saving start.
-  _eeprom->begin(AC_HEADERSIZE + _containSize + sizeof(station_config_t));
+  entry = _locate(reinterpret_cast<const char*>(config->ssid), &stage);
 
   // Determine insertion or replacement.
   if (entry >= 0) {
@@ -223,24 +489,22 @@ bool AutoConnectCredential::save(const station_config_t* config) {
     }
   }
   else {
+    // The iterator reserves the last index as the end.
+    if (_entries >= iterator::npos - 1) {
+      AC_DBG("Credentials full, %.*s cannot be saved\n", sizeof(station_config_t::ssid), reinterpret_cast<const char*>(config->ssid));
+      return false;
+    }
     // Same entry not found. increase the entry.
     _entries++;
-    int i;
-    for (i = 0; i < static_cast<int>(sizeof(_id)) - 1; i++)
+    for (int i = 0; i < static_cast<int>(sizeof(_id)) - 1; i++)
       _eeprom->write(i + _offset, (uint8_t)_id[i]);
-    _eeprom->write(i + _offset, _entries);
+    _writeEntries();
   }
 
-  rc = _eeprom->commit();
-  delay(10);
-
   // Seek insertion point, evaluate capacity to insert the new entry.
-  uint16_t eSize = strlen(reinterpret_cast<const char*>(config->ssid)) + strlen(reinterpret_cast<const char*>(config->password)) + sizeof(station_config_t::bssid) + sizeof(station_config_t::dhcp);
-  if (config->dhcp == (uint8_t)STA_STATIC)
-    eSize += sizeof(station_config_t::_config);
-  eSize += sizeof('\0') + sizeof('\0');
+  uint16_t eSize = _entrySize(config);
 
-  for (_dp = AC_HEADERSIZE; _dp < _containSize + AC_HEADERSIZE; _dp++) {
+  for (_dp = AC_HEADERSIZE; _dp < static_cast<int>(_containSize) + AC_HEADERSIZE; _dp++) {
     uint8_t c = _eeprom->read(_dp);
     if (c == 0xff) {
       uint16_t fp = _dp;
@@ -289,11 +553,16 @@ bool AutoConnectCredential::save(const station_config_t* config) {
     _eeprom->write(_offset + sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t) + 1, (uint8_t)(_containSize >> 8));
   }
 
-  rc &= _eeprom->commit();
-  delay(10);
-  _eeprom->end();
+  return true;
+}
 
-  return rc;
+/**
+ *  Write the number of entries to the header of the EEPROM which has
+ *  already begun. The number saturates at AC_CREDT_EXTENDED.
+ */
+void AutoConnectCredential::_writeEntries(void) {
+  uint8_t e = _entries < AC_CREDT_EXTENDED ? static_cast<uint8_t>(_entries) : AC_CREDT_EXTENDED;
+  _eeprom->write(_offset + static_cast<int>(sizeof(AC_IDENTIFIER)) - 1, e);
 }
 
 /**
@@ -377,6 +646,71 @@ bool  AutoConnectCredential::restore(Stream& in) {
   return rc;
 }
 
+/**
+ *  Retrieve an entry sequentially for the iterator. The EEPROM stays open
+ *  from the first entry to the last one so that the traversal reads the
+ *  flash only once.
+ *  @param  index   The number of the entry to be retrieved.
+ *  @param  cursor  EEPROM address of the entry, it advances to the next.
+ *  @param  config  A station_config structure pointer.
+ *  @retval true    The entry is retrieved.
+ *          false   No more entries.
+ */
+bool AutoConnectCredential::_seek(const uint16_t index, size_t& cursor, station_config_t* config) {
+  if (index >= _entries) {
+    _release();
+    return false;
+  }
+
+  if (!index)
+    cursor = AC_HEADERSIZE;
+  if (!_seeking) {
+    _eeprom->begin(AC_HEADERSIZE + _containSize);
+    _seeking = true;
+  }
+  _dp = cursor;
+  _retrieveEntry(config);
+  cursor = _dp;
+  if (index == _entries - 1)
+    _release();
+  return true;
+}
+
+/**
+ *  End the EEPROM access that the iterator has begun. It is called when
+ *  the traversal reaches the end or the iterator is destroyed halfway.
+ */
+void AutoConnectCredential::_release(void) {
+  if (_seeking) {
+    _eeprom->end();
+    _seeking = false;
+  }
+}
+
+/**
+ *  Count the entries in the container of the EEPROM which has already
+ *  begun, skipping the released area.
+ *  @return The number of entries.
+ */
+uint16_t AutoConnectCredential::_countEntry(void) {
+  station_config_t  config;
+  uint16_t  count = 0;
+
+  _dp = AC_HEADERSIZE;
+  while (_dp < AC_HEADERSIZE + static_cast<int>(_containSize)) {
+    uint8_t c = _eeprom->read(_dp);
+    if (c == '\0')
+      break;
+    if (c == 0xff)
+      _dp++;
+    else {
+      _retrieveEntry(&config);
+      count++;
+    }
+  }
+  return count;
+}
+
 /**
  *  Get the SSID and password from EEPROM indicated by _dp as the pointer
  *  of current read address. FF is skipped as unavailable area.
@@ -421,6 +755,451 @@ void AutoConnectCredential::_retrieveEntry(station_config_t* config) {
   }
 }
 
+#elif AC_CREDENTIAL_PREFERENCES == 2
+
+/**
+ *  AutoConnectCredential constructor takes the available count of saved
+ *  entries.
+ *  A stored credential file structure in the file system.
+ *   0      7 8 9a b c  f 10                                     8c   90
+ *  +--------+--+--+----+---------------------------------------+----+-
+ *  |AC_CREDT|vv|nn|hcrc|ssid|pass|bssid|d|r|ip|gw|nm|dns1|dns2|rcrc|...
+ *  +--------+--+--+----+---------------------------------------+----+-
+ *  AC_CREDT : Identifier. 8 characters.
+ *  vv : Version of the file(uint16_t).
+ *  nn : Number of records including free slots(uint16_t).
+ *  hcrc : CRC-32 of the header.
+ *  Each record has a fixed size of 128 bytes, it consists of ssid(32),
+ *  password(64), bssid(6), dhcp flag(1), reserved(1), static IPs(20) and
+ *  CRC-32 of the record(4). A record with an empty SSID is a free slot
+ *  to be reused. A record with a wrong CRC is also regarded as free.
+ *  The whole file is read sequentially once at the instantiation to
+ *  make the index of SSIDs sorted, and the records are updated in place.
+ */
+uint16_t AutoConnectCredential::_holders = 0;
+
+AutoConnectCredential::AutoConnectCredential() {
+  _allocateEntry();
+}
+
+AutoConnectCredential::AutoConnectCredential(uint16_t offset) {
+  // The offset parameter is invalid with the file system but preserved
+  // for the compatibility.
+  (void)(offset);
+  _allocateEntry();
+}
+
+void AutoConnectCredential::_allocateEntry(void) {
+  AutoConnectFS::FS*  fs = &AUTOCONNECT_APPLIED_FILESYSTEM;
+
+  _slots = 0;
+  _index.clear();
+  _free.clear();
+  // The file system mounted by the library is shared among instances
+  // and unmounted when the last of them is destroyed. The file system
+  // mounted by the sketch is left as it is.
+  if (!_holder) {
+    if (!AutoConnectFS::_isMounted(fs)) {
+      if (!fs->begin(AC_CREDENTIAL_FSINITIALIZATION)) {
+        AC_DBG("%s mount failed\n", AUTOCONNECT_STRING_DEPLOY(AUTOCONNECT_APPLIED_FILESYSTEM));
+        return;
+      }
+      _holders = 0;
+      _holder = true;
+    }
+    else
+      _holder = _holders > 0;
+    if (_holder)
+      _holders++;
+  }
+  if (!fs->exists(AC_CREDENTIAL_FILE))
+    return;
+
+  _file = fs->open(AC_CREDENTIAL_FILE, "r+");
+  if (!_file) {
+    AC_DBG(AC_CREDENTIAL_FILE " open failed\n");
+    return;
+  }
+
+  AC_CREDTFILEHEADER_t  hdr;
+  if (_file.read(reinterpret_cast<uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr) ||
+      memcmp(hdr.ac_credt, AC_IDENTIFIER, sizeof(AC_CREDTFILEHEADER_t::ac_credt)) ||
+      hdr.version != _version ||
+      hdr.crc != _crc32(&hdr, sizeof(hdr) - sizeof(AC_CREDTFILEHEADER_t::crc))) {
+    AC_DBG(AC_CREDENTIAL_FILE " has no " AC_IDENTIFIER "\n");
+    _file.close();
+    return;
+  }
+
+  // Read all records sequentially to make the index.
+  AC_CREDTRECORD_t  records[AC_CREDENTIAL_BULKREAD];
+  _index.reserve(hdr.slots);
+  while (_slots < hdr.slots) {
+    size_t  rn = std::min<size_t>(hdr.slots - _slots, AC_CREDENTIAL_BULKREAD);
+    rn = _file.read(reinterpret_cast<uint8_t*>(records), rn * sizeof(AC_CREDTRECORD_t)) / sizeof(AC_CREDTRECORD_t);
+    if (!rn) {
+      AC_DBG(AC_CREDENTIAL_FILE " truncated at #%" PRIu16 "\n", _slots);
+      break;
+    }
+    for (size_t n = 0; n < rn; n++, _slots++) {
+      const AC_CREDTRECORD_t& rec = records[n];
+      if (rec.ssid[0] != '\0' && rec.crc == _crc32(&rec, sizeof(AC_CREDTRECORD_t) - sizeof(AC_CREDTRECORD_t::crc))) {
+        char  ssid[sizeof(AC_CREDTRECORD_t::ssid) + sizeof('\0')];
+        memcpy(ssid, rec.ssid, sizeof(AC_CREDTRECORD_t::ssid));
+        ssid[sizeof(AC_CREDTRECORD_t::ssid)] = '\0';
+        _index.push_back(std::make_pair(String(ssid), _slots));
+      }
+      else {
+        if (rec.ssid[0] != '\0')
+          AC_DBG(AC_CREDENTIAL_FILE " #%" PRIu16 " CRC error, discarded\n", _slots);
+        _free.push_back(_slots);
+      }
+    }
+  }
+  std::sort(_index.begin(), _index.end(), [](const AC_CREDTINDEX_t& a, const AC_CREDTINDEX_t& b) { return _less(a, b.first.c_str()); });
+  _entries = _index.size();
+  _containSize = _slots * sizeof(AC_CREDTRECORD_t);
+}
+
+/**
+ *  The destructor closes the credential file and unmounts the file
+ *  system if it is the last instance holding the mount by the library.
+ */
+AutoConnectCredential::~AutoConnectCredential() {
+  if (_file)
+    _file.close();
+  if (_holder && !--_holders)
+    AUTOCONNECT_APPLIED_FILESYSTEM.end();
+}
+
+/**
+ *  Returns the size of the credential file.
+ *  @retval Size of the file.
+ */
+size_t AutoConnectCredential::dataSize(void) const {
+  return sizeof(AC_CREDTFILEHEADER_t) + _containSize;
+}
+
+/**
+ *  Delete the credential entry for the specified SSID in the file.
+ *  The record is erased in place and its slot will be reused.
+ *  @param  ssid    A SSID character string to be deleted.
+ *  @retval true    The entry successfully delete.
+ *          false   Could not deleted.
+ */
+bool AutoConnectCredential::del(const char* ssid) {
+  AC_CREDTINDEXES_t::iterator it = _find(ssid);
+  if (it == _index.end())
+    return false;
+
+  station_config_t  config;
+  memset(&config, 0x00, sizeof(station_config_t));
+  if (!_writeRecord(it->second, &config))
+    return false;
+  _file.flush();
+  _free.push_back(it->second);
+  _index.erase(it);
+  _entries = _index.size();
+  return true;
+}
+
+/**
+ *  Load the credential entry for the specified SSID from the file.
+ *  @param  ssid    A SSID character string to be loaded.
+ *  @param  config  A station_config structure pointer.
+ *  @retval The entry number of the SSID in the sorted order. If the
+ *  number less than 0, the specified SSID was not found.
+ */
+int32_t AutoConnectCredential::load(const char* ssid, station_config_t* config) {
+  AC_CREDTINDEXES_t::iterator it = _find(ssid);
+  if (it != _index.end()) {
+    if (_readRecord(it->second, config))
+      return static_cast<int32_t>(it - _index.begin());
+  }
+  return -1;
+}
+
+/**
+ *  Load the credential entry for the specified number in the sorted
+ *  order of SSID from the file.
+ *  @param  entry   A number of entry to be loaded.
+ *  @param  config  A station_config structure pointer.
+ *  @retval true    The entry number of the SSID in the file.
+ *          false   The number is not available.
+ */
+bool AutoConnectCredential::load(uint16_t entry, station_config_t* config) {
+  if (entry < _index.size())
+    return _readRecord(_index[entry].second, config);
+  return false;
+}
+
+/**
+ *  Save a credential to the file. When the same SSID already exists, the
+ *  record will be replaced in place. Otherwise, it occupies a free slot
+ *  or is appended to the end of the file.
+ *  @param  config  A pointer to the station_config structure storing SSID and password.
+ *  @retval true    Successfully saved.
+ *  @retval false   The file could not be written.
+ */
+bool AutoConnectCredential::save(const station_config_t* config) {
+  return saveAll(config, 1);
+}
+
+/**
+ *  Save multiple credentials to the file. The header is updated and the
+ *  file is flushed only once after all records have been put.
+ *  @param  configs An array of the station_config structure.
+ *  @param  n       Number of the elements in configs.
+ *  @retval true    Successfully saved.
+ *  @retval false   The file could not be written.
+ */
+bool AutoConnectCredential::saveAll(const station_config_t* configs, const size_t n) {
+  const uint16_t  slots = _slots;
+  bool  rc = true;
+
+  for (size_t i = 0; rc && i < n; i++)
+    rc = _put(&configs[i]);
+  if (_slots != slots)
+    rc &= _writeHeader();
+  if (_file)
+    _file.flush();
+  return rc;
+}
+
+/**
+ * Save AutoConnectCredentials to the stream. The credential file is
+ * output as it is.
+ * @param  out    Output destination stream.
+ * @return true   All credentials successfully saved.
+ * @return false  Could not save.
+ */
+bool AutoConnectCredential::backup(Stream& out) {
+  if (!_file) {
+    AC_DBG("No " AC_CREDENTIAL_FILE " storage\n");
+    return false;
+  }
+
+  uint8_t buffer[sizeof(AC_CREDTRECORD_t)];
+  size_t  remain = dataSize();
+  _file.seek(0);
+  while (remain) {
+    size_t  rsz = _file.read(buffer, std::min<size_t>(remain, sizeof(buffer)));
+    if (!rsz || out.write(buffer, rsz) != rsz) {
+      AC_DBG(AC_CREDENTIAL_FILE " backup failed\n");
+      return false;
+    }
+    remain -= rsz;
+  }
+  AC_DBG("Credentials %u bytes saved\n", dataSize());
+  return true;
+}
+
+/**
+ * Restore all credentials from the stream. The stream must be the
+ * credential file saved by the backup function.
+ * @param  in     Input stream.
+ * @return true   Credentials successfully restored.
+ * @return false  Could not restore.
+ */
+bool AutoConnectCredential::restore(Stream& in) {
+  AC_CREDTFILEHEADER_t  hdr;
+
+  if (in.readBytes(reinterpret_cast<char*>(&hdr), sizeof(hdr)) != sizeof(hdr) ||
+      memcmp(hdr.ac_credt, AC_IDENTIFIER, sizeof(AC_CREDTFILEHEADER_t::ac_credt)) ||
+      hdr.crc != _crc32(&hdr, sizeof(hdr) - sizeof(AC_CREDTFILEHEADER_t::crc))) {
+    AC_DBG("Credentials file has no %s\n", AC_IDENTIFIER);
+    return false;
+  }
+
+  if (_file)
+    _file.close();
+  _file = AUTOCONNECT_APPLIED_FILESYSTEM.open(AC_CREDENTIAL_FILE, "w");
+  if (!_file) {
+    AC_DBG(AC_CREDENTIAL_FILE " open failed\n");
+    return false;
+  }
+
+  bool  rc = _file.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) == sizeof(hdr);
+  uint8_t buffer[sizeof(AC_CREDTRECORD_t)];
+  size_t  remain = hdr.slots * sizeof(AC_CREDTRECORD_t);
+  while (rc && remain) {
+    size_t  rsz = in.readBytes(reinterpret_cast<char*>(buffer), std::min<size_t>(remain, sizeof(buffer)));
+    if (!rsz) {
+      AC_DBG("Credentials file was unexpectedly EOF, corrupted.\n");
+      rc = false;
+      break;
+    }
+    rc = _file.write(buffer, rsz) == rsz;
+    remain -= rsz;
+  }
+  _file.close();
+
+  // Rebuild the index from the restored file.
+  _allocateEntry();
+  if (rc)
+    AC_DBG("Credentials restored\n");
+  return rc;
+}
+
+/**
+ *  Create an empty credential file.
+ *  @retval true    The file is created.
+ *  @retval false   The file could not be created.
+ */
+bool AutoConnectCredential::_create(void) {
+  _file = AUTOCONNECT_APPLIED_FILESYSTEM.open(AC_CREDENTIAL_FILE, "w+");
+  if (!_file) {
+    AC_DBG(AC_CREDENTIAL_FILE " create failed\n");
+    return false;
+  }
+  _slots = 0;
+  _containSize = 0;
+  _free.clear();
+  return _writeHeader();
+}
+
+/**
+ *  Find an entry that exactly matches the SSID by the binary search.
+ *  @param  ssid  A SSID character string to be found.
+ *  @return An iterator to the index, or end of the index if not found.
+ */
+AutoConnectCredential::AC_CREDTINDEXES_t::iterator AutoConnectCredential::_find(const char* ssid) {
+  AC_CREDTINDEXES_t::iterator it = std::lower_bound(_index.begin(), _index.end(), ssid, _less);
+  if (it != _index.end() && !strcmp(it->first.c_str(), ssid))
+    return it;
+  return _index.end();
+}
+
+/**
+ *  Put a credential record to the file without updating the header.
+ *  @param  config  A pointer to the station_config structure storing SSID and password.
+ *  @retval true    The record is put.
+ *  @retval false   The file could not be written.
+ */
+bool AutoConnectCredential::_put(const station_config_t* config) {
+  char  ssid[sizeof(station_config_t::ssid) + sizeof('\0')];
+  memcpy(ssid, config->ssid, sizeof(station_config_t::ssid));
+  ssid[sizeof(station_config_t::ssid)] = '\0';
+  if (!strlen(ssid))
+    return false;
+
+  AC_CREDTINDEXES_t::iterator it = _find(ssid);
+  if (it != _index.end())
+    return _writeRecord(it->second, config);
+
+  if (!_file && !_create())
+    return false;
+
+  uint16_t  slot;
+  if (_free.size()) {
+    slot = _free.back();
+    if (!_writeRecord(slot, config))
+      return false;
+    _free.pop_back();
+  }
+  else {
+    if (_slots >= AutoConnectCredentialBase::iterator::npos) {
+      AC_DBG("Credentials full, %s cannot be saved\n", ssid);
+      return false;
+    }
+    slot = _slots;
+    if (!_writeRecord(slot, config))
+      return false;
+    _slots++;
+    _containSize = _slots * sizeof(AC_CREDTRECORD_t);
+  }
+  _index.insert(std::lower_bound(_index.begin(), _index.end(), ssid, _less), std::make_pair(String(ssid), slot));
+  _entries = _index.size();
+  return true;
+}
+
+/**
+ *  Read a record at the slot and verify its CRC.
+ *  @param  slot    Slot number of the record.
+ *  @param  config  A station_config structure pointer.
+ *  @retval true    The record is loaded.
+ *          false   The record could not be read or is corrupted.
+ */
+bool AutoConnectCredential::_readRecord(const uint16_t slot, station_config_t* config) {
+  AC_CREDTRECORD_t  rec;
+
+  if (!_file.seek(sizeof(AC_CREDTFILEHEADER_t) + slot * sizeof(AC_CREDTRECORD_t)) ||
+      _file.read(reinterpret_cast<uint8_t*>(&rec), sizeof(rec)) != sizeof(rec) ||
+      rec.crc != _crc32(&rec, sizeof(AC_CREDTRECORD_t) - sizeof(AC_CREDTRECORD_t::crc))) {
+    AC_DBG(AC_CREDENTIAL_FILE " #%" PRIu16 " read failed\n", slot);
+    return false;
+  }
+  memcpy(config->ssid, rec.ssid, sizeof(station_config_t::ssid));
+  memcpy(config->password, rec.password, sizeof(station_config_t::password));
+  memcpy(config->bssid, rec.bssid, sizeof(station_config_t::bssid));
+  config->dhcp = rec.dhcp;
+  for (uint8_t e = 0; e < sizeof(station_config_t::_config::addr) / sizeof(uint32_t); e++)
+    config->config.addr[e] = rec.dhcp == (uint8_t)STA_STATIC ? rec.addr[e] : 0U;
+  return true;
+}
+
+/**
+ *  Write a record at the slot in place.
+ *  @param  slot    Slot number of the record.
+ *  @param  config  A station_config structure pointer.
+ *  @retval true    The record is written.
+ *          false   The record could not be written.
+ */
+bool AutoConnectCredential::_writeRecord(const uint16_t slot, const station_config_t* config) {
+  AC_CREDTRECORD_t  rec;
+
+  memcpy(rec.ssid, config->ssid, sizeof(AC_CREDTRECORD_t::ssid));
+  memcpy(rec.password, config->password, sizeof(AC_CREDTRECORD_t::password));
+  memcpy(rec.bssid, config->bssid, sizeof(AC_CREDTRECORD_t::bssid));
+  rec.dhcp = config->dhcp;
+  rec.reserved = 0;
+  for (uint8_t e = 0; e < sizeof(AC_CREDTRECORD_t::addr) / sizeof(uint32_t); e++)
+    rec.addr[e] = config->dhcp == (uint8_t)STA_STATIC ? config->config.addr[e] : 0U;
+  rec.crc = _crc32(&rec, sizeof(AC_CREDTRECORD_t) - sizeof(AC_CREDTRECORD_t::crc));
+
+  if (!_file.seek(sizeof(AC_CREDTFILEHEADER_t) + slot * sizeof(AC_CREDTRECORD_t)) ||
+      _file.write(reinterpret_cast<const uint8_t*>(&rec), sizeof(rec)) != sizeof(rec)) {
+    AC_DBG(AC_CREDENTIAL_FILE " #%" PRIu16 " write failed\n", slot);
+    return false;
+  }
+  return true;
+}
+
+/**
+ *  Write the header of the credential file.
+ *  @retval true    The header is written.
+ *          false   The header could not be written.
+ */
+bool AutoConnectCredential::_writeHeader(void) {
+  AC_CREDTFILEHEADER_t  hdr;
+
+  memcpy(hdr.ac_credt, AC_IDENTIFIER, sizeof(AC_CREDTFILEHEADER_t::ac_credt));
+  hdr.version = _version;
+  hdr.slots = _slots;
+  hdr.crc = _crc32(&hdr, sizeof(hdr) - sizeof(AC_CREDTFILEHEADER_t::crc));
+  if (!_file.seek(0) ||
+      _file.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) != sizeof(hdr)) {
+    AC_DBG(AC_CREDENTIAL_FILE " header write failed\n");
+    return false;
+  }
+  return true;
+}
+
+/**
+ *  Retrieve an entry in the sorted order for the iterator.
+ *  @param  index   The number of the entry to be retrieved.
+ *  @param  cursor  Index of the sorted SSIDs, it advances to the next.
+ *  @param  config  A station_config structure pointer.
+ *  @retval true    The entry is retrieved.
+ *          false   No more entries.
+ */
+bool AutoConnectCredential::_seek(const uint16_t index, size_t& cursor, station_config_t* config) {
+  AC_UNUSED(index);
+  if (cursor >= _index.size())
+    return false;
+  return _readRecord(_index[cursor++].second, config);
+}
+
 #else
 
 /**
@@ -447,6 +1226,19 @@ void AutoConnectCredential::_retrieveEntry(station_config_t* config) {
  *  dns2 : Secondary DNS (uint32_t)
  *  t  : The end of the container is a continuous '\0'.
  *  SSID and PASSWORD are terminated by '\ 0'.
+ *  Entries are sorted by SSID.
+ *  When the number of entries exceeds 255 or the container exceeds 64KB,
+ *  the header is extended to the version 2 layout as follows.
+ *   0 1  3  5    9
+ *  +-+--+--+----+-----------------+-
+ *  |X|vv|ee|ssss|ssid\0pass\0bssid|...
+ *  +-+--+--+----+-----------------+-
+ *  X  : AC_CREDT_EXTENDED (0xff)
+ *  vv : Format version, AC_CREDT_VERSION (uint16_t)
+ *  ee : Number of contained entries(uint16_t).
+ *  ssss : Container size(uint32_t).
+ *  The version 1 layout is kept as long as it can hold the credentials,
+ *  so that the earlier versions of AutoConnect can still read them.
  */
 AutoConnectCredential::AutoConnectCredential() {
   _allocateEntry();
@@ -484,7 +1276,7 @@ inline bool AutoConnectCredential::del(const char* ssid) {
  *  Refresh the number of stored credential entries.
  *  @retval A number of entries.
  */
-inline uint8_t AutoConnectCredential::entries(void) {
+inline uint16_t AutoConnectCredential::entries(void) {
   _entries = _credit.size();
   return _entries;
 }
@@ -498,17 +1290,12 @@ inline uint8_t AutoConnectCredential::entries(void) {
  *  @retval The entry number of the SSID. If the number less than 0,
  *  the specified SSID was not found.
  */
-int8_t AutoConnectCredential::load(const char* ssid, station_config_t* config) {
-  // Determine the number in entries
-  int8_t  en = 0;
+int32_t AutoConnectCredential::load(const char* ssid, station_config_t* config) {
   _entries = _import(); // Reload the saved credentials
-  for (decltype(_credit)::iterator it = _credit.begin(), e = _credit.end(); it != e; ++it) {
-    String  key = it->first;
-    if (!strcmp(ssid, key.c_str())) {
-      _obtain(it, config);
-      return en;
-    }
-    en++;
+  AC_CREDT_t::iterator  it = _find(ssid);
+  if (it != _credit.end()) {
+    _obtain(it, config);
+    return static_cast<int32_t>(it - _credit.begin());
   }
   return -1;
 }
@@ -522,13 +1309,11 @@ int8_t AutoConnectCredential::load(const char* ssid, station_config_t* config) {
  *  @retval true    The entry number of the SSID.
  *          false   The number is not available.
  */
-bool AutoConnectCredential::load(int8_t entry, station_config_t* config) {
+bool AutoConnectCredential::load(uint16_t entry, station_config_t* config) {
   _entries = _import();
-  for (decltype(_credit)::iterator it = _credit.begin(), e = _credit.end(); it != e; ++it) {
-    if (!entry--) {
-      _obtain(it, config);
-      return true;
-    }
+  if (entry < _credit.size()) {
+    _obtain(_credit.begin() + entry, config);
+    return true;
   }
   return false;
 }
@@ -543,10 +1328,25 @@ bool AutoConnectCredential::load(int8_t entry, station_config_t* config) {
  *  @retval false   Preferences commit failed.
  */
 bool AutoConnectCredential::save(const station_config_t* config) {
-  if (_add(config)) {
-    return _commit() > 0 ? true : false;
+  return saveAll(config, 1);
+}
+
+/**
+ *  Save multiple credentials to Preferences with a single commit.
+ *  If any of them cannot be added, nothing is committed.
+ *  @param  configs An array of the station_config structure.
+ *  @param  n       Number of the elements in configs.
+ *  @retval true    Successfully saved.
+ *  @retval false   Preferences commit failed.
+ */
+bool AutoConnectCredential::saveAll(const station_config_t* configs, const size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    if (!_add(&configs[i])) {
+      _entries = _import();   // Discard the added entries
+      return false;
+    }
   }
-  return false;
+  return _commit() > 0 ? true : false;
 }
 
 /**
@@ -640,9 +1440,9 @@ bool AutoConnectCredential::restore(Stream& in) {
 }
 
 /**
- *  Add an entry to internal dictionary that is std::map structure.
+ *  Add an entry to internal dictionary that is sorted by SSID.
  *  It adds an entry by the insert after will delete the same entry
- *  caused std:: map does not accept duplicate keys.
+ *  to keep SSID unique.
  *  @param  config  A pointer to the station_config structure storing SSID and password.
  *  @retval true    Successfully saved.
  *  @retval false   Preferences commit failed.
@@ -653,6 +1453,10 @@ bool AutoConnectCredential::_add(const station_config_t* config) {
 
     // Remove a same entry to insert a new one.
     _del(ssid.c_str(), false);
+    if (_credit.size() >= AutoConnectCredentialBase::iterator::npos) {
+      AC_DBG("Credentials full, %s cannot be saved\n", ssid.c_str());
+      return false;
+    }
 
     // Insert
     AC_CREDTBODY_t  credtBody;
@@ -661,14 +1465,9 @@ bool AutoConnectCredential::_add(const station_config_t* config) {
     credtBody.dhcp = config->dhcp;
     for (uint8_t e = 0; e < sizeof(AC_CREDTBODY_t::ip) / sizeof(uint32_t); e++)
       credtBody.ip[e] = credtBody.dhcp == (uint8_t)STA_STATIC ? config->config.addr[e] : 0U;
-    std::pair<AC_CREDT_t::iterator, bool> rc = _credit.insert(std::make_pair(ssid, credtBody));
+    _credit.insert(std::lower_bound(_credit.begin(), _credit.end(), ssid.c_str(), _less), std::make_pair(ssid, credtBody));
     _entries = _credit.size();
-    #ifdef AC_DBG
-    if (!rc.second) {
-      AC_DBG("Failed to save a credential %s\n", config->ssid);
-    }
-    #endif
-    return rc.second;
+    return true;
   }
   return false;
 }
@@ -695,14 +1494,29 @@ size_t AutoConnectCredential::_commit(void) {
   _containSize = sz + (_entries ? sizeof('\0') : 0);
   // Calculate the nvs pool size for saving to NVS. Add size of 'e' and 'ss' field.
   size_t  psz = _containSize + sizeof(uint8_t) + sizeof(uint16_t);
+  // Extend the header to the version 2 if the version 1 cannot hold it.
+  const bool  extended = _entries > UINT8_MAX || psz > UINT16_MAX;
+  if (extended)
+    psz += sizeof(uint16_t) + sizeof(uint32_t);
 
   // Dump container to serialization pool and write it back to NVS.
   uint8_t* credtPool = (uint8_t*)malloc(psz);
   if (credtPool) {
-    uint16_t dp = 0;
-    credtPool[dp++] = _entries;  // 'e'
-    credtPool[dp++] = (uint8_t)(psz & 0x00ff); // 'ss' low byte
-    credtPool[dp++] = (uint8_t)(psz >> 8);     // 'ss' high byte
+    size_t  dp = 0;
+    if (extended) {
+      credtPool[dp++] = AC_CREDT_EXTENDED;  // 'X'
+      credtPool[dp++] = (uint8_t)(AC_CREDT_VERSION & 0x00ff); // 'vv'
+      credtPool[dp++] = (uint8_t)(AC_CREDT_VERSION >> 8);
+      credtPool[dp++] = (uint8_t)(_entries & 0x00ff);         // 'ee'
+      credtPool[dp++] = (uint8_t)(_entries >> 8);
+      for (uint8_t b = 0; b < sizeof(uint32_t); b++)
+        credtPool[dp++] = (uint8_t)(psz >> (b * 8));          // 'ssss'
+    }
+    else {
+      credtPool[dp++] = _entries;  // 'e'
+      credtPool[dp++] = (uint8_t)(psz & 0x00ff); // 'ss' low byte
+      credtPool[dp++] = (uint8_t)(psz >> 8);     // 'ss' high byte
+    }
     // Starts dump of credential entries
     for (const auto& credt : _credit) {
       ssid = credt.first;       // Retrieve SSID
@@ -758,7 +1572,7 @@ size_t AutoConnectCredential::_commit(void) {
  *          false   Could not deleted.
  */
 bool AutoConnectCredential::_del(const char* ssid, const bool commit) {
-  decltype(_credit)::iterator it = _credit.find(String(ssid));
+  AC_CREDT_t::iterator  it = _find(ssid);
   if (it != _credit.end()) {
     _credit.erase(it);
     _entries = _credit.size();
@@ -769,12 +1583,24 @@ bool AutoConnectCredential::_del(const char* ssid, const bool commit) {
   return false;
 }
 
+/**
+ *  Find an entry that exactly matches the SSID by the binary search.
+ *  @param  ssid  A SSID character string to be found.
+ *  @return An iterator to the entry, or end of the dictionary if not found.
+ */
+AutoConnectCredential::AC_CREDT_t::iterator AutoConnectCredential::_find(const char* ssid) {
+  AC_CREDT_t::iterator  it = std::lower_bound(_credit.begin(), _credit.end(), ssid, _less);
+  if (it != _credit.end() && !strcmp(it->first.c_str(), ssid))
+    return it;
+  return _credit.end();
+}
+
 /**
  *  Import the credentials bulk data as Preferences from NVS.
  *  In ESP32, AutoConnect stores credentials in NVS from v1.0.0.
  */
-uint8_t AutoConnectCredential::_import(void) {
-  uint8_t cn = 0;
+uint16_t AutoConnectCredential::_import(void) {
+  uint16_t  cn = 0;
   if (_pref->begin(AC_CREDENTIAL_NVSNAME, true)) {
     size_t  psz = _getPrefBytesLength<Preferences>(_pref.get(), AC_CREDENTIAL_NVSKEY);
     if (psz) {
@@ -782,10 +1608,19 @@ uint8_t AutoConnectCredential::_import(void) {
       if (credtPool) {
         _pref->getBytes(AC_CREDENTIAL_NVSKEY, static_cast<void*>(credtPool), psz);
         _credit.clear();
-        uint16_t  dp = 0;
+        size_t  dp = 0;
         cn = credtPool[dp++];  // Retrieve 'e'
         _containSize = (uint16_t)credtPool[dp++];
         _containSize += (uint16_t)(credtPool[dp++] << 8); // Retrieve size of 'ss'
+        if (cn == AC_CREDT_EXTENDED && _containSize == AC_CREDT_VERSION) {
+          // Version 2 header has the 16-bit 'ee' and the 32-bit 'ssss'
+          cn = credtPool[dp++];
+          cn += (uint16_t)(credtPool[dp++] << 8);
+          _containSize = 0;
+          for (uint8_t b = 0; b < sizeof(uint32_t); b++)
+            _containSize += (uint32_t)credtPool[dp++] << (b * 8);
+        }
+        _credit.reserve(cn);
         // Starts import
         while (dp < psz - sizeof('\0')) {
           AC_CREDTBODY_t  credtBody;
@@ -812,8 +1647,11 @@ uint8_t AutoConnectCredential::_import(void) {
             }
           }
           // Make an entry
-          _credit.insert(std::make_pair(ssid, credtBody));
+          _credit.push_back(std::make_pair(ssid, credtBody));
         }
+        // The binary search requires sorted entries.
+        if (!std::is_sorted(_credit.begin(), _credit.end(), [](const AC_CREDTENTRY_t& a, const AC_CREDTENTRY_t& b) { return _less(a, b.first.c_str()); }))
+          std::sort(_credit.begin(), _credit.end(), [](const AC_CREDTENTRY_t& a, const AC_CREDTENTRY_t& b) { return _less(a, b.first.c_str()); });
         free(credtPool);
       }
       #ifdef AC_DBG
@@ -832,10 +1670,28 @@ uint8_t AutoConnectCredential::_import(void) {
   return cn;
 }
 
+/**
+ *  Retrieve an entry sequentially for the iterator. The credentials are
+ *  imported only once at the first entry.
+ *  @param  index   The number of the entry to be retrieved.
+ *  @param  cursor  Index of the dictionary, it advances to the next.
+ *  @param  config  A station_config structure pointer.
+ *  @retval true    The entry is retrieved.
+ *          false   No more entries.
+ */
+bool AutoConnectCredential::_seek(const uint16_t index, size_t& cursor, station_config_t* config) {
+  if (!index)
+    _entries = _import();
+  if (cursor >= _credit.size())
+    return false;
+  _obtain(_credit.begin() + cursor++, config);
+  return true;
+}
+
 /**
  *  Obtains an entry pointed to by the specified iterator from the
- *  dictionary as the std::map that maintains the credentials into the
- *  station_config structure.
+ *  dictionary as the sorted vector that maintains the credentials into
+ *  the station_config structure.
  *  @param  it  An  iterator to an entry
  *  @param  config  the station_config structure storing SSID and password.
  */
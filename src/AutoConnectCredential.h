@@ -18,9 +18,18 @@
 // v1.0.2 and earlier.
 #define AUTOCONNECT_USE_PREFERENCES
 
+// The AUTOCONNECT_USE_CREDTFILE macro stores the credentials as a binary
+// file of fixed-size records in the file system that is applied by
+// AUTOCONNECT_APPLIED_FILESYSTEM, instead of EEPROM or Preferences.
+// It is valid for both ESP8266 and ESP32, and it takes precedence over
+// AUTOCONNECT_USE_PREFERENCES.
+//#define AUTOCONNECT_USE_CREDTFILE
+
 #include <Arduino.h>
+#include <iterator>
 #include <type_traits>
 #include <memory>
+#include <vector>
 #if defined(ARDUINO_ARCH_ESP8266)
 #define AC_CREDENTIAL_PREFERENCES 0
 extern "C" {
@@ -34,6 +43,10 @@ extern "C" {
 #endif
 #include <esp_wifi.h>
 #endif
+#ifdef AUTOCONNECT_USE_CREDTFILE
+#undef AC_CREDENTIAL_PREFERENCES
+#define AC_CREDENTIAL_PREFERENCES 2
+#endif
 #include <SD.h>
 #include "AutoConnectDefs.h"
 #include "AutoConnectFS.h"
@@ -77,25 +90,86 @@ typedef struct {
   } config;
 } station_config_t;
 
+/**
+ * Credential container format version. Version 1 has an 8-bit number of
+ * entries and a 16-bit container size; version 2 extends them to 16-bit
+ * and 32-bit. Version 2 is marked by AC_CREDT_EXTENDED in the 'e' field
+ * followed by the version number in the place of 'ss', which cannot be
+ * a valid container size for 255 entries in version 1.
+ */
+#define AC_CREDT_VERSION    2
+#define AC_CREDT_EXTENDED   0xff
+
+/**
+ * Version of the exchange format for exportTo and importFrom.
+ */
+#define AC_CREDT_EXCHANGE   1
+
 class AutoConnectCredentialBase {
  public:
+  /**
+   * A forward iterator that retrieves the saved credentials sequentially.
+   * Traversing with the iterator reads the storage only once, so it is
+   * cheaper than repeating the index-based load. Modifying the
+   * credentials during the traversal invalidates the iterator.
+   * Leaving the traversal before the end, such as breaking out of a
+   * range-based for loop, releases the storage when the iterator is
+   * destroyed.
+   */
+  class iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef station_config_t  value_type;
+    typedef std::ptrdiff_t    difference_type;
+    typedef const station_config_t* pointer;
+    typedef const station_config_t& reference;
+
+    iterator(AutoConnectCredentialBase* credt, const uint16_t index) : _credt(credt), _index(index), _cursor(0) { _fetch(); }
+    ~iterator() { if (_index != npos) _credt->_release(); }
+    reference operator*(void) const { return _config; }
+    pointer   operator->(void) const { return &_config; }
+    iterator& operator++(void) { _index++; _fetch(); return *this; }
+    bool operator==(const iterator& rhs) const { return _credt == rhs._credt && _index == rhs._index; }
+    bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+    static constexpr uint16_t npos = UINT16_MAX;  /**< Index of the end */
+
+   private:
+    void  _fetch(void) {
+      if (_index != npos && !_credt->_seek(_index, _cursor, &_config))
+        _index = npos;
+    }
+    AutoConnectCredentialBase*  _credt; /**< Traversing credentials */
+    uint16_t  _index;           /**< Index of the current entry */
+    size_t    _cursor;          /**< Storage position of the next entry */
+    station_config_t  _config;  /**< The current entry */
+  };
+
   // explicit AutoConnectCredentialBase() : _entries(0), _containSize(0), _ensureFS(false) {}
   explicit AutoConnectCredentialBase() : _entries(0), _containSize(0) {}
   virtual ~AutoConnectCredentialBase() {}
-  virtual uint8_t entries(void) { return _entries; }
-  virtual uint16_t dataSize(void) const { return sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t) + sizeof(uint16_t) + _containSize; }
+  virtual uint16_t  entries(void) { return _entries; }
+  virtual size_t  dataSize(void) const { return sizeof(AC_IDENTIFIER) - 1 + sizeof(uint8_t) + sizeof(uint16_t) + _containSize; }
   virtual bool    del(const char* ssid) = 0;
-  virtual int8_t  load(const char* ssid, station_config_t* config) = 0;
-  virtual bool    load(int8_t entry, station_config_t* config) = 0;
+  virtual int32_t load(const char* ssid, station_config_t* config) = 0;
+  virtual bool    load(uint16_t entry, station_config_t* config) = 0;
   virtual bool    save(const station_config_t* config) = 0;
+  virtual bool    saveAll(const station_config_t* configs, const size_t n) = 0;
   virtual bool    backup(Stream& out) = 0;
   virtual bool    restore(Stream& in) = 0;
+  bool      exportTo(Stream& out);
+  bool      importFrom(Stream& in);
+  iterator  begin(void) { return iterator(this, 0); }
+  iterator  end(void) { return iterator(this, iterator::npos); }
 
  protected:
   virtual void  _allocateEntry(void) = 0; /**< Initialize storage for credentials. */
+  virtual bool  _seek(const uint16_t index, size_t& cursor, station_config_t* config) = 0; /**< Retrieve an entry for the iterator */
+  virtual void  _release(void) {} /**< End the traversal of the iterator */
+  virtual uint16_t  _capacity(void) const { return iterator::npos - 1; } /**< Maximum number of the entries to be stored */
+  static uint32_t _crc32(const void* data, const size_t length, const uint32_t crc = 0);  /**< CRC-32 (IEEE 802.3) */
 
-  uint8_t   _entries;       /**< Count of the available entry */
-  uint16_t  _containSize;   /**< Container size */
+  uint16_t  _entries;       /**< Count of the available entry */
+  uint32_t  _containSize;   /**< Container size */
 };
 
 #if AC_CREDENTIAL_PREFERENCES == 0
@@ -110,14 +184,20 @@ class AutoConnectCredential : public AutoConnectCredentialBase {
   explicit AutoConnectCredential(uint16_t offset);
   ~AutoConnectCredential();
   bool    del(const char* ssid) override;
-  int8_t  load(const char* ssid, station_config_t* config) override;
-  bool    load(int8_t entry, station_config_t* config) override;
+  int32_t load(const char* ssid, station_config_t* config) override;
+  bool    load(uint16_t entry, station_config_t* config) override;
   bool    save(const station_config_t* config) override;
+  bool    saveAll(const station_config_t* configs, const size_t n) override;
   bool    backup(Stream& out) override;
   bool    restore(Stream& in) override;
 
  protected:
   void    _allocateEntry(void) override;  /**< Initialize storage for credentials. */
+  bool    _seek(const uint16_t index, size_t& cursor, station_config_t* config) override;
+  void    _release(void) override;
+#if defined(ARDUINO_ARCH_ESP8266)
+  uint16_t  _capacity(void) const override;
+#endif
 
  private:
   typedef struct __attribute__((__packed__)) {
@@ -126,18 +206,113 @@ class AutoConnectCredential : public AutoConnectCredentialBase {
     uint16_t ss;
   } AC_CREDTHEADER_t;       /**< Header of AutConnectCredential */
 
+  int32_t _locate(const char* ssid, station_config_t* config);  /**< Seek an entry of the SSID */
   void    _retrieveEntry(station_config_t* config);   /**< Read an available entry. */
+  uint16_t  _countEntry(void);                        /**< Count the entries in the container */
+  bool    _store(const station_config_t* config);     /**< Store an entry without commit */
+  void    _writeEntries(void);                        /**< Update the number of entries in the header */
+  static uint16_t _entrySize(const station_config_t* config); /**< Size of a stored entry */
 
   int       _dp;            /**< The current address in EEPROM */
   int       _ep;            /**< The current entry address in EEPROM */
   uint16_t  _offset;        /**< The offset for the saved area of credentials in EEPROM. */
+  bool      _seeking = false; /**< The iterator keeps the EEPROM open */
   std::unique_ptr<EEPROMClass>  _eeprom;  /**< shared EEPROM class */
 };
 
+#elif AC_CREDENTIAL_PREFERENCES == 2
+// #pragma message "AutoConnectCredential applies the file system"
+#include <algorithm>
+#include <vector>
+
+/**
+ * Path of the credential file in the AUTOCONNECT_APPLIED_FILESYSTEM.
+ */
+#ifndef AC_CREDENTIAL_FILE
+#define AC_CREDENTIAL_FILE    "/" AC_IDENTIFIER ".dat"
+#endif
+
+/**
+ * Whether to format the file system when it cannot be mounted. It is
+ * effective only with ESP32. ESP8266 follows the autoFormat of the
+ * configuration given to the file system with setConfig.
+ */
+#ifndef AC_CREDENTIAL_FORMATONFAIL
+#define AC_CREDENTIAL_FORMATONFAIL  false
+#endif
+#if defined(ARDUINO_ARCH_ESP8266)
+#define AC_CREDENTIAL_FSINITIALIZATION
+#elif defined(ARDUINO_ARCH_ESP32)
+#define AC_CREDENTIAL_FSINITIALIZATION  AC_CREDENTIAL_FORMATONFAIL
+#endif
+
+/**
+ * Number of records read at once while indexing the credential file.
+ */
+#ifndef AC_CREDENTIAL_BULKREAD
+#define AC_CREDENTIAL_BULKREAD  8
+#endif
+
+/** AutoConnectCredential class using the file system */
+class AutoConnectCredential : public AutoConnectCredentialBase {
+ public:
+  AutoConnectCredential();
+  explicit AutoConnectCredential(uint16_t offset);
+  ~AutoConnectCredential();
+  size_t  dataSize(void) const override;
+  bool    del(const char* ssid) override;
+  int32_t load(const char* ssid, station_config_t* config) override;
+  bool    load(uint16_t entry, station_config_t* config) override;
+  bool    save(const station_config_t* config) override;
+  bool    saveAll(const station_config_t* configs, const size_t n) override;
+  bool    backup(Stream& out) override;
+  bool    restore(Stream& in) override;
+
+ protected:
+  void    _allocateEntry(void) override;  /**< Initialize storage for credentials. */
+  bool    _seek(const uint16_t index, size_t& cursor, station_config_t* config) override;
+
+ private:
+  typedef struct __attribute__((__packed__)) {
+    uint8_t   ac_credt[sizeof(AC_IDENTIFIER) - sizeof('\0')];
+    uint16_t  version;
+    uint16_t  slots;        /**< Number of records including free slots */
+    uint32_t  crc;          /**< CRC-32 of the above */
+  } AC_CREDTFILEHEADER_t;   /**< Header of the credential file */
+  typedef struct __attribute__((__packed__)) {
+    uint8_t   ssid[32];     /**< Free slot if ssid[0] is '\0' */
+    uint8_t   password[64];
+    uint8_t   bssid[6];
+    uint8_t   dhcp;
+    uint8_t   reserved;
+    uint32_t  addr[5];
+    uint32_t  crc;          /**< CRC-32 of the above */
+  } AC_CREDTRECORD_t;       /**< A credential record in the file */
+  typedef std::pair<String, uint16_t> AC_CREDTINDEX_t;  /**< SSID and slot */
+  typedef std::vector<AC_CREDTINDEX_t>  AC_CREDTINDEXES_t;
+
+  bool    _create(void);    /**< Create an empty credential file */
+  AC_CREDTINDEXES_t::iterator _find(const char* ssid);  /**< Binary search for an entry */
+  bool    _put(const station_config_t* config); /**< Put a record without updating the header */
+  bool    _readRecord(const uint16_t slot, station_config_t* config); /**< Read a record at the slot */
+  bool    _writeRecord(const uint16_t slot, const station_config_t* config);  /**< Write a record in place */
+  bool    _writeHeader(void); /**< Update the header */
+  static bool _less(const AC_CREDTINDEX_t& index, const char* ssid) { return strcmp(index.first.c_str(), ssid) < 0; }
+  static constexpr uint16_t _version = 1; /**< Version of the credential file */
+
+  AC_CREDTINDEXES_t _index;   /**< SSIDs sorted with their slots */
+  std::vector<uint16_t> _free;  /**< Free slots to be reused */
+  uint16_t  _slots;         /**< Number of records in the file */
+  fs::File  _file;          /**< The credential file opened for read and write */
+  bool      _holder = false;  /**< The instance holds the mount made by the library */
+  static uint16_t _holders; /**< Number of instances holding the mount */
+};
+
 #else
 // #pragma message "AutoConnectCredential applies the Preferences"
+#include <algorithm>
 #include <type_traits>
-#include <map>
+#include <vector>
 #include <Preferences.h>
 #include <nvs.h>
 
@@ -156,15 +331,17 @@ class AutoConnectCredential : public AutoConnectCredentialBase {
   explicit AutoConnectCredential(uint16_t offset);
   ~AutoConnectCredential();
   bool    del(const char* ssid) override;
-  uint8_t entries(void) override;
-  int8_t  load(const char* ssid, station_config_t* config) override;
-  bool    load(int8_t entry, station_config_t* config) override;
+  uint16_t  entries(void) override;
+  int32_t load(const char* ssid, station_config_t* config) override;
+  bool    load(uint16_t entry, station_config_t* config) override;
   bool    save(const station_config_t* config) override;
+  bool    saveAll(const station_config_t* configs, const size_t n) override;
   bool    backup(Stream& out) override;
   bool    restore(Stream& in) override;
 
  protected:
   void    _allocateEntry(void) override;  /**< Initialize storage for credentials. */
+  bool    _seek(const uint16_t index, size_t& cursor, station_config_t* config) override;
 
  private:
   typedef struct {
@@ -173,12 +350,15 @@ class AutoConnectCredential : public AutoConnectCredentialBase {
     uint8_t  dhcp;   /**< 1:DHCP, 2:Static IP */
     uint32_t ip[5];
   } AC_CREDTBODY_t;         /**< Credential entry */
-  typedef std::map<String, AC_CREDTBODY_t>  AC_CREDT_t;
+  typedef std::pair<String, AC_CREDTBODY_t> AC_CREDTENTRY_t;
+  typedef std::vector<AC_CREDTENTRY_t>  AC_CREDT_t; /**< Entries sorted by SSID */
 
   bool    _add(const station_config_t* config); /**< Add an entry */
   size_t  _commit(void);    /**< Write back to the nvs */
   bool    _del(const char* ssid, const bool commit);  /**< Deletes an entry */
-  uint8_t _import(void);    /**< Import from the nvs */
+  AC_CREDT_t::iterator  _find(const char* ssid);  /**< Binary search for an entry */
+  static bool _less(const AC_CREDTENTRY_t& entry, const char* ssid) { return strcmp(entry.first.c_str(), ssid) < 0; }
+  uint16_t  _import(void);  /**< Import from the nvs */
   void    _obtain(AC_CREDT_t::iterator const& it, station_config_t* config);  /**< Obtain an entry from iterator */
   template<typename T>
   typename std::enable_if<AutoConnectUtil::has_func_getBytesLength<T>::value, size_t>::type _getPrefBytesLength(T* pref, const char* key) {
@@ -199,7 +379,7 @@ class AutoConnectCredential : public AutoConnectCredentialBase {
     return len;
   }
 
-  AC_CREDT_t  _credit;      /**< Dictionary to maintain the credentials */
+  AC_CREDT_t  _credit;      /**< Sorted dictionary to maintain the credentials */
   std::unique_ptr<Preferences>  _pref;  /**< Preferences class instance to access the nvs */
 };
 
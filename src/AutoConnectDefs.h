@@ -51,6 +51,39 @@
 #define AUTOCONNECT_USE_UPDATE
 #endif
 
+// AutoConnectAux indexes the elements it contains by the hash of the
+// lower-cased name to speed up getElement, and AutoConnect registers
+// the peers of global elements across the pages. Define
+// AUTOCONNECT_NOUSE_AUXINDEX to look up the elements by linear scan
+// without the index, which saves 8 bytes of heap per element.
+#ifndef AUTOCONNECT_NOUSE_AUXINDEX
+#define AUTOCONNECT_USE_AUXINDEX
+#endif
+
+// AutoConnectAux constructs the elements that it creates by loading in
+// an arena of the page, and releases them all at once with the page.
+// Define AUTOCONNECT_NOUSE_AUXARENA to allocate each element from the
+// heap individually.
+#ifndef AUTOCONNECT_NOUSE_AUXARENA
+#define AUTOCONNECT_USE_AUXARENA
+#endif
+
+// Size of the block that the arena of AutoConnectAux takes from the heap.
+#ifndef AUTOCONNECT_AUXARENA_BLOCKSIZE
+#define AUTOCONNECT_AUXARENA_BLOCKSIZE  1024
+#endif // !AUTOCONNECT_AUXARENA_BLOCKSIZE
+
+// Declaration to enable the event stream of AutoConnectAux pages.
+// AutoConnectAux::push sends the responses of the elements to the
+// browsers that subscribe to the page with Server-Sent Events, without
+// waiting for the Fetch request. The subscription holds a connection
+// for each browser, so it is enabled only by the explicit definition
+// of AC_USE_AUXEVENT.
+//#define AC_USE_AUXEVENT
+#ifdef AC_USE_AUXEVENT
+#define AUTOCONNECT_USE_AUXEVENT
+#endif
+
 // Declaration to enable AutoConnectConfigAux.
 // AC_USE_CONFIGAUX must be enabled along with AUTOCONNECT_USE_JSON
 // to enable AutoConnectConfigAux.
@@ -144,6 +177,7 @@
 #define AUTOCONNECT_URI_DISCON  AUTOCONNECT_URI "/disc"
 #define AUTOCONNECT_URI_FAIL    AUTOCONNECT_URI "/fail"
 #define AUTOCONNECT_URI_FETCH   AUTOCONNECT_URI "/worker"
+#define AUTOCONNECT_URI_EVENT   AUTOCONNECT_URI "/event"
 #define AUTOCONNECT_URI_OPEN    AUTOCONNECT_URI "/open"
 #define AUTOCONNECT_URI_RESET   AUTOCONNECT_URI "/reset"
 #define AUTOCONNECT_URI_RESULT  AUTOCONNECT_URI "/result"
@@ -286,6 +320,29 @@
 #define AUTOCONNECT_MIN_RSSI          -120  // No limit
 #endif // !AUTOCONNECT_MIN_RSSI
 
+// Size of the buffer on the stack that assembles the response to the
+// Fetch request. The response exceeding it is sent in chunks.
+#ifndef AUTOCONNECT_FETCH_BUFFERSIZE
+#define AUTOCONNECT_FETCH_BUFFERSIZE    256
+#endif // !AUTOCONNECT_FETCH_BUFFERSIZE
+
+// Number of browsers that can subscribe to the event stream of an
+// AutoConnectAux page. The oldest subscriber is dropped when exceeded.
+#ifndef AUTOCONNECT_AUXEVENT_CLIENTS
+#define AUTOCONNECT_AUXEVENT_CLIENTS    2
+#endif // !AUTOCONNECT_AUXEVENT_CLIENTS
+
+// Interval in milliseconds for the browser to reconnect the event stream.
+#ifndef AUTOCONNECT_AUXEVENT_RETRY
+#define AUTOCONNECT_AUXEVENT_RETRY      3000
+#endif // !AUTOCONNECT_AUXEVENT_RETRY
+
+// Interval in milliseconds of the comment line that keeps the event
+// stream connection alive while the page does not push.
+#ifndef AUTOCONNECT_AUXEVENT_HEARTBEAT
+#define AUTOCONNECT_AUXEVENT_HEARTBEAT  15000
+#endif // !AUTOCONNECT_AUXEVENT_HEARTBEAT
+
 // ArduinoJson buffer size
 #ifndef AUTOCONNECT_JSONBUFFER_SIZE
 #define AUTOCONNECT_JSONBUFFER_SIZE     256
@@ -340,9 +397,65 @@
 #define AUTOCONNECT_UPDATE_DOWNLOAD   "/"
 #endif // !AUTOCONNECT_UPDATE_DOWNLOAD
 #ifndef AUTOCONNECT_UPDATE_CATALOG_JSONBUFFER_SIZE
-#define AUTOCONNECT_UPDATE_CATALOG_JSONBUFFER_SIZE  256
+#define AUTOCONNECT_UPDATE_CATALOG_JSONBUFFER_SIZE  320
 #endif // !AUTOCONNECT_UPDATE_CATALOG_JSONBUFFER_SIZE
 
+// Number of retries to resume the interrupted download of the binary
+// with the HTTP Range request, and the interval between retries in ms.
+#ifndef AUTOCONNECT_UPDATE_RESUME_RETRY
+#define AUTOCONNECT_UPDATE_RESUME_RETRY     3
+#endif // !AUTOCONNECT_UPDATE_RESUME_RETRY
+#ifndef AUTOCONNECT_UPDATE_RESUME_INTERVAL
+#define AUTOCONNECT_UPDATE_RESUME_INTERVAL  2000
+#endif // !AUTOCONNECT_UPDATE_RESUME_INTERVAL
+
+// AutoConnectUpdate transfers the binary in chunks of this size. The
+// update started from the progress page runs in the background, in a
+// dedicated task on ESP32 or a chunk per AutoConnect::handleClient on
+// ESP8266. Define AUTOCONNECT_NOUSE_UPDATETASK to advance it with
+// handleClient on ESP32 as well.
+#ifndef AUTOCONNECT_UPDATE_CHUNKSIZE
+#define AUTOCONNECT_UPDATE_CHUNKSIZE  1024
+#endif // !AUTOCONNECT_UPDATE_CHUNKSIZE
+#if defined(ARDUINO_ARCH_ESP32) && !defined(AUTOCONNECT_NOUSE_UPDATETASK)
+#define AUTOCONNECT_USE_UPDATETASK
+#endif
+#ifndef AUTOCONNECT_UPDATETASK_STACKSIZE
+#define AUTOCONNECT_UPDATETASK_STACKSIZE  (8 * 1024)
+#endif // !AUTOCONNECT_UPDATETASK_STACKSIZE
+
+// AutoConnectUpdate applies the binary patch from the running firmware
+// which the update server catalogs as the patch type. Define
+// AUTOCONNECT_NOUSE_UPDATEPATCH to update with the full binary only.
+#ifndef AUTOCONNECT_NOUSE_UPDATEPATCH
+#define AUTOCONNECT_USE_UPDATEPATCH
+#endif
+// File name extension of the patch on the update server.
+#ifndef AUTOCONNECT_UPDATE_PATCH_EXTENSION
+#define AUTOCONNECT_UPDATE_PATCH_EXTENSION  ".acpatch"
+#endif // !AUTOCONNECT_UPDATE_PATCH_EXTENSION
+// The block size in which the running firmware is read to apply the patch.
+#ifndef AUTOCONNECT_UPDATE_PATCH_BLOCKSIZE
+#define AUTOCONNECT_UPDATE_PATCH_BLOCKSIZE  256
+#endif // !AUTOCONNECT_UPDATE_PATCH_BLOCKSIZE
+
+// The update scheduled with AutoConnectUpdate::schedule adds a random
+// delay of up to AUTOCONNECT_UPDATE_SCHEDULE_JITTER to each polling
+// interval, and doubles the interval up to AUTOCONNECT_UPDATE_SCHEDULE_BACKOFF
+// while the update server responds 429 or 503. [ms]
+#ifndef AUTOCONNECT_UPDATE_SCHEDULE_JITTER
+#define AUTOCONNECT_UPDATE_SCHEDULE_JITTER  300000
+#endif // !AUTOCONNECT_UPDATE_SCHEDULE_JITTER
+#ifndef AUTOCONNECT_UPDATE_SCHEDULE_BACKOFF
+#define AUTOCONNECT_UPDATE_SCHEDULE_BACKOFF (24UL * 60 * 60 * 1000)
+#endif // !AUTOCONNECT_UPDATE_SCHEDULE_BACKOFF
+// The binary sketch file in the catalog that the scheduled update
+// rolls out. Replacing this file on the update server releases a new
+// firmware to the fleet.
+#ifndef AUTOCONNECT_UPDATE_SCHEDULE_TARGET
+#define AUTOCONNECT_UPDATE_SCHEDULE_TARGET  "firmware.bin"
+#endif // !AUTOCONNECT_UPDATE_SCHEDULE_TARGET
+
 // HTTP authentication default realm
 #ifndef AUTOCONNECT_AUTH_REALM
 #define AUTOCONNECT_AUTH_REALM        "AUTOCONNECT"
@@ -361,6 +474,91 @@
 #endif
 #endif
 
+// With AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP, the regular expression
+// of the form ^.+SUFFIX$, ^.*SUFFIX$ or ^SUFFIX$ is evaluated by
+// comparing the suffix without the regex. On ESP32, the other regular
+// expressions are evaluated with std::regex in a thread of this stack
+// size, since it consumes much stack. The thread is created for the
+// compilation and for each uploaded file name, which costs the stack
+// allocation from the heap and a context switch every time.
+#ifndef AUTOCONNECT_OTAMATCH_STACKSIZE
+#define AUTOCONNECT_OTAMATCH_STACKSIZE  (10 * 1024)
+#endif // !AUTOCONNECT_OTAMATCH_STACKSIZE
+
+// The firmware compressed with gzip is uploaded with this file name
+// extension regardless of AUTOCONNECT_UPLOAD_ASFIRMWARE. On ESP8266,
+// the bootloader decompresses it. On ESP32, AutoConnectOTA decompresses
+// it while writing with the tinfl decompressor in the ROM, which needs
+// a window of 32KB from the heap. Define AUTOCONNECT_NOUSE_OTAINFLATE
+// to upload it as a regular file on ESP32.
+#ifndef AUTOCONNECT_UPLOAD_ASCOMPRESSED
+#define AUTOCONNECT_UPLOAD_ASCOMPRESSED ".bin.gz"
+#endif
+#if defined(ARDUINO_ARCH_ESP32) && !defined(AUTOCONNECT_NOUSE_OTAINFLATE)
+#define AUTOCONNECT_USE_OTAINFLATE
+#endif
+
+// AutoConnectOTA coalesces the uploaded data into the blocks of this
+// size before writing them to the flash or the file. It should be a
+// multiple of the flash sector size. Defining 0 writes each received
+// chunk as it is.
+#ifndef AUTOCONNECT_OTA_BUFFERSIZE
+#define AUTOCONNECT_OTA_BUFFERSIZE    4096
+#endif // !AUTOCONNECT_OTA_BUFFERSIZE
+
+// On ESP32, AutoConnectOTA writes the coalesced blocks in a writer
+// thread with two buffers, so that receiving the next block overlaps
+// with writing the previous one. Define AUTOCONNECT_NOUSE_OTAWRITER to
+// write the blocks within the loop task with a single buffer.
+#if defined(ARDUINO_ARCH_ESP32) && !defined(AUTOCONNECT_NOUSE_OTAWRITER)
+#define AUTOCONNECT_USE_OTAWRITER
+#endif
+#ifndef AUTOCONNECT_OTAWRITER_STACKSIZE
+#define AUTOCONNECT_OTAWRITER_STACKSIZE (4 * 1024)
+#endif // !AUTOCONNECT_OTAWRITER_STACKSIZE
+
+// The upload handlers verify the uploaded data against the MD5 or
+// SHA-256 digest given by the query parameter or the request header of
+// the following names in hexadecimal. The request headers are available
+// only if the sketch collects them with WebServer::collectHeaders.
+// Define AUTOCONNECT_NOUSE_UPLOADDIGEST to exclude the verification.
+#ifndef AUTOCONNECT_NOUSE_UPLOADDIGEST
+#define AUTOCONNECT_USE_UPLOADDIGEST
+#endif
+#ifndef AUTOCONNECT_UPLOAD_MD5
+#define AUTOCONNECT_UPLOAD_MD5        "_md5"
+#endif // !AUTOCONNECT_UPLOAD_MD5
+#ifndef AUTOCONNECT_UPLOAD_SHA256
+#define AUTOCONNECT_UPLOAD_SHA256     "_sha256"
+#endif // !AUTOCONNECT_UPLOAD_SHA256
+#ifndef AUTOCONNECT_UPLOAD_MD5_HEADER
+#define AUTOCONNECT_UPLOAD_MD5_HEADER "X-Content-MD5"
+#endif // !AUTOCONNECT_UPLOAD_MD5_HEADER
+#ifndef AUTOCONNECT_UPLOAD_SHA256_HEADER
+#define AUTOCONNECT_UPLOAD_SHA256_HEADER  "X-Content-SHA256"
+#endif // !AUTOCONNECT_UPLOAD_SHA256_HEADER
+
+// The default upload handlers of AutoConnectFile coalesce the uploaded
+// data into the blocks of these sizes before writing them to the file.
+// The block for the SD should be a multiple of the sector size of 512
+// bytes, and the block for the filesystem should be a multiple of the
+// flash page size of 256 bytes. Defining 0 writes each received chunk
+// as it is.
+#ifndef AUTOCONNECT_UPLOAD_SD_BUFFERSIZE
+#define AUTOCONNECT_UPLOAD_SD_BUFFERSIZE  4096
+#endif // !AUTOCONNECT_UPLOAD_SD_BUFFERSIZE
+#ifndef AUTOCONNECT_UPLOAD_FS_BUFFERSIZE
+#define AUTOCONNECT_UPLOAD_FS_BUFFERSIZE  4096
+#endif // !AUTOCONNECT_UPLOAD_FS_BUFFERSIZE
+
+// The default upload handlers of AutoConnectFile begin the media at
+// the start of each upload and end it at the finish. Defining true
+// keeps the media mounted once begun across the uploads, which saves
+// the SD card initialization for each upload.
+#ifndef AUTOCONNECT_UPLOAD_KEEPMOUNT
+#define AUTOCONNECT_UPLOAD_KEEPMOUNT  false
+#endif // !AUTOCONNECT_UPLOAD_KEEPMOUNT
+
 // File name where AutoConnectConfig is persisted on the file system.
 #ifndef AUTOCONNECT_CONFIGAUX_FILE
 #define AUTOCONNECT_CONFIGAUX_FILE    "acconfig.json"
@@ -0,0 +1,163 @@
+/**
+ * Declaration of AutoConnectDigest class, which computes the MD5 or
+ * SHA-256 digest of the data streamed in pieces.
+ * @file AutoConnectDigest.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTDIGEST_H_
+#define _AUTOCONNECTDIGEST_H_
+
+#include <stdint.h>
+#include <WString.h>
+#if defined(ARDUINO_ARCH_ESP8266)
+#include <bearssl/bearssl_hash.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <mbedtls/md5.h>
+#include <mbedtls/sha256.h>
+#endif
+
+/**
+ * AutoConnectDigest hashes the data given by add in sequence and
+ * returns the digest as a hexadecimal string. It uses the hash
+ * functions of BearSSL on ESP8266 and mbedTLS on ESP32, both of which
+ * are built into the core.
+ */
+class AutoConnectDigest {
+ public:
+  typedef enum {
+    AC_DIGEST_NONE,
+    AC_DIGEST_MD5,
+    AC_DIGEST_SHA256
+  } AC_DIGEST_t;
+
+  AutoConnectDigest() : _type(AC_DIGEST_NONE) {}
+  AutoConnectDigest(const AutoConnectDigest&) = delete;
+  AutoConnectDigest& operator=(const AutoConnectDigest&) = delete;
+  ~AutoConnectDigest() { _free(); }
+
+  /**
+   * Start a new digest computation.
+   * @param  type  The hash algorithm.
+   */
+  void  begin(const AC_DIGEST_t type) {
+    _free();
+    _type = type;
+    switch (_type) {
+    case AC_DIGEST_MD5:
+#if defined(ARDUINO_ARCH_ESP8266)
+      br_md5_init(&_ctx.md5);
+#elif defined(ARDUINO_ARCH_ESP32)
+      mbedtls_md5_init(&_ctx.md5);
+      mbedtls_md5_starts(&_ctx.md5);
+#endif
+      break;
+    case AC_DIGEST_SHA256:
+#if defined(ARDUINO_ARCH_ESP8266)
+      br_sha256_init(&_ctx.sha256);
+#elif defined(ARDUINO_ARCH_ESP32)
+      mbedtls_sha256_init(&_ctx.sha256);
+      mbedtls_sha256_starts(&_ctx.sha256, 0);
+#endif
+      break;
+    default:
+      break;
+    }
+  }
+
+  /**
+   * Hash the subsequent piece of the data.
+   * @param  data  The data.
+   * @param  size  Size of the data.
+   */
+  void  add(const uint8_t* data, const size_t size) {
+    switch (_type) {
+    case AC_DIGEST_MD5:
+#if defined(ARDUINO_ARCH_ESP8266)
+      br_md5_update(&_ctx.md5, data, size);
+#elif defined(ARDUINO_ARCH_ESP32)
+      mbedtls_md5_update(&_ctx.md5, data, size);
+#endif
+      break;
+    case AC_DIGEST_SHA256:
+#if defined(ARDUINO_ARCH_ESP8266)
+      br_sha256_update(&_ctx.sha256, data, size);
+#elif defined(ARDUINO_ARCH_ESP32)
+      mbedtls_sha256_update(&_ctx.sha256, data, size);
+#endif
+      break;
+    default:
+      break;
+    }
+  }
+
+  /**
+   * Finish the computation and return the digest.
+   * @return The digest in lowercase hexadecimal, an empty string if
+   * the computation has not begun.
+   */
+  String  toString(void) {
+    uint8_t digest[32];
+    size_t  len = 0;
+
+    switch (_type) {
+    case AC_DIGEST_MD5:
+#if defined(ARDUINO_ARCH_ESP8266)
+      br_md5_out(&_ctx.md5, digest);
+#elif defined(ARDUINO_ARCH_ESP32)
+      mbedtls_md5_finish(&_ctx.md5, digest);
+#endif
+      len = 16;
+      break;
+    case AC_DIGEST_SHA256:
+#if defined(ARDUINO_ARCH_ESP8266)
+      br_sha256_out(&_ctx.sha256, digest);
+#elif defined(ARDUINO_ARCH_ESP32)
+      mbedtls_sha256_finish(&_ctx.sha256, digest);
+#endif
+      len = 32;
+      break;
+    default:
+      break;
+    }
+    _free();
+
+    String  hex;
+    hex.reserve(len * 2);
+    for (size_t i = 0; i < len; i++) {
+      hex += "0123456789abcdef"[digest[i] >> 4];
+      hex += "0123456789abcdef"[digest[i] & 0x0f];
+    }
+    return hex;
+  }
+
+  AC_DIGEST_t type(void) const { return _type; }  /**< The hash algorithm in progress */
+
+ protected:
+  void  _free(void) {
+#if defined(ARDUINO_ARCH_ESP32)
+    // The context of mbedTLS may hold the hardware accelerator.
+    if (_type == AC_DIGEST_MD5)
+      mbedtls_md5_free(&_ctx.md5);
+    else if (_type == AC_DIGEST_SHA256)
+      mbedtls_sha256_free(&_ctx.sha256);
+#endif
+    _type = AC_DIGEST_NONE;
+  }
+
+  AC_DIGEST_t _type;          /**< The hash algorithm in progress */
+  union {
+#if defined(ARDUINO_ARCH_ESP8266)
+    br_md5_context    md5;
+    br_sha256_context sha256;
+#elif defined(ARDUINO_ARCH_ESP32)
+    mbedtls_md5_context     md5;
+    mbedtls_sha256_context  sha256;
+#endif
+  } _ctx;                     /**< The hash context */
+};
+
+#endif // !_AUTOCONNECTDIGEST_H_
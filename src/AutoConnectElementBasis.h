@@ -113,7 +113,7 @@ class AutoConnectElementBasis {
     : name(String(name)), value(String(value)), post(post), enable(true), global(false) {
     _type = AC_Element;
   }
-  virtual ~AutoConnectElementBasis() {}
+  virtual ~AutoConnectElementBasis();
   virtual const String  toHTML(void) const { return enable ? posterior(value) : String(""); }
   ACElement_t typeOf(void) const { return _type; }
   const String  posterior(const String& s) const;
@@ -126,7 +126,7 @@ class AutoConnectElementBasis {
   // individual AutoConnectElement.
   virtual bool  canHandle(void) const { return false; }
   virtual void  reply(AutoConnectAux& aux) { AC_UNUSED(aux); }
-  virtual void  response(const char* attribute, const char* value) { responses.push_back(ACResponse_t({ attribute, value })); }
+  virtual void  response(const char* attribute, const char* value);
   virtual void  response(const char* value) { AC_UNUSED(value); }
   virtual size_t  responseJSON(char* buffer);
   virtual size_t  responseLength(void);
@@ -143,6 +143,11 @@ class AutoConnectElementBasis {
   bool  _isCompatible(void);  /**< Verify type integrity */
   
   ACElement_t _type;  /**< Element type identifier */
+
+  /** The elements that have the responses not yet sent, in order of the first response */
+  static std::vector<AutoConnectElementBasis*> _responded;
+
+  friend class AutoConnectAux;
 };
 
 /**
@@ -241,6 +246,8 @@ class AutoConnectFileBasis : AC_AUTOCONNECTELEMENT_ON_VIRTUAL public AutoConnect
   AutoConnectUploadHandler::ProgressExit_ft _cbProgress;  
 };
 
+class AutoConnectInputMatcher;  // Compiled pattern of AutoConnectInput
+
 /**
  * Input-box arrangement class, a part of AutoConnectAux element.
  * Place an optionally labeled input-box that can be added by user sketch.
@@ -270,6 +277,9 @@ class AutoConnectInputBasis :
   String  placeholder;  /**< Pre-filled placeholder */
   ACInput_t apply;    /**< An input element type attribute */
   String  style;      /**< Formatting style */
+
+ protected:
+  mutable std::shared_ptr<AutoConnectInputMatcher>  _matcher; /**< The pattern compiled at the last validation */
 };
 
 /**
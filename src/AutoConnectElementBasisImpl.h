@@ -10,6 +10,7 @@
 #ifndef _AUTOCONNECTELEMENTBASISIMPL_H_
 #define _AUTOCONNECTELEMENTBASISIMPL_H_
 
+#include <algorithm>
 #include <stdlib.h>
 #include <stdio.h>
 #if defined(ARDUINO_ARCH_ESP8266)
@@ -25,6 +26,16 @@ namespace AutoConnectElementBasisImpl {
   constexpr size_t  _sizeof(const char (&)[N]) { return N - sizeof('\0'); }
 } // AutoConnectElementBasisImpl
 
+std::vector<AutoConnectElementBasis*> AutoConnectElementBasis::_responded;
+
+/**
+ * An element destroyed before its responses are sent leaves from the
+ * elements to be responded.
+ */
+AutoConnectElementBasis::~AutoConnectElementBasis() {
+  _responded.erase(std::remove(_responded.begin(), _responded.end(), this), _responded.end());
+}
+
 /**
  * Append post-tag according by the post attribute.
  * @param  s  An original string
@@ -65,6 +76,19 @@ const String AutoConnectElementBasis::posterior(const String& s) const {
   return html;
 }
 
+/**
+ * Add the attribute value to the response of the Fetch request. The
+ * element with the first response is marked as responded, so that the
+ * Fetch endpoint only visits the elements that have something to send.
+ * @param  attribute  An attribute or property of the DOM node.
+ * @param  value      The value to be set.
+ */
+void AutoConnectElementBasis::response(const char* attribute, const char* value) {
+  if (!responses.size())
+    _responded.push_back(this);
+  responses.push_back(ACResponse_t({ attribute, value }));
+}
+
 /**
  * Generate a JSON response adapting to the Fetch request.
  * @param  buffer  Buffer to output JSON response data
@@ -434,31 +458,201 @@ const String AutoConnectInputBasis::toHTML(void) const {
 }
 
 /**
- * Evaluate the pattern as a regexp and return whether value matches.
- * Always return true if the pattern is undefined.
- * @return true  The value matches a pattern.
- * @return false The value does not match a pattern.
+ * The compiled pattern of AutoConnectInput. AutoConnectInput keeps it
+ * across validations until the pattern is changed, so the regex is not
+ * compiled for each isValid call. The patterns that AutoConnect uses
+ * for the IPv4 address, the host name and the number of digits are
+ * evaluated by the built-in matchers without the regex.
  */
-bool AutoConnectInputBasis::isValid(void) const {
-  bool  rc = true;
-  if (pattern.length()) {
+class AutoConnectInputMatcher {
+ public:
+  explicit AutoConnectInputMatcher(const String& pattern);
+  ~AutoConnectInputMatcher();
+  bool  match(const char* value) const;
+  const String& pattern(void) const { return _pattern; }
+
+ private:
+  bool  _builtin(void);
+  static bool _isDigits(const char* value, const uint16_t min, const uint16_t max);
+  static bool _isHostname(const char* value);
+  static bool _isIPv4(const char* value);
+
+  typedef enum {
+    AC_MATCH_REGEX,
+    AC_MATCH_DIGITS,
+    AC_MATCH_HOSTNAME,
+    AC_MATCH_IPV4,
+    AC_MATCH_INVALID
+  } ACMatch_t;
+
+  String    _pattern; /**< Compiled pattern */
+  ACMatch_t _match;   /**< Matcher to evaluate the value */
+  uint16_t  _min;     /**< Minimum number of digits */
+  uint16_t  _max;     /**< Maximum number of digits */
+  static constexpr uint16_t _unbounded = UINT16_MAX;  /**< No maximum number of digits */
+#if defined(ARDUINO_ARCH_ESP8266)
+  regex_t   _preg;
+#elif defined(ARDUINO_ARCH_ESP32)
+  std::unique_ptr<std::regex> _re;
+#endif
+};
+
+/**
+ * Compile the pattern. If the pattern is one of the built-in, the regex
+ * is not compiled.
+ * @param  pattern  A regular expression.
+ */
+AutoConnectInputMatcher::AutoConnectInputMatcher(const String& pattern) : _pattern(pattern), _match(AC_MATCH_REGEX), _min(0), _max(0) {
+  if (_builtin())
+    return;
+#if defined(ARDUINO_ARCH_ESP8266)
+  if (regcomp(&_preg, _pattern.c_str(), REG_EXTENDED) != 0) {
+    AC_DBG("%s regex compile failed\n", _pattern.c_str());
+    _match = AC_MATCH_INVALID;
+  }
+#elif defined(ARDUINO_ARCH_ESP32)
+  _re.reset(new std::regex(std::string(_pattern.c_str())));
+#endif
+}
+
+AutoConnectInputMatcher::~AutoConnectInputMatcher() {
+#if defined(ARDUINO_ARCH_ESP8266)
+  if (_match == AC_MATCH_REGEX)
+    regfree(&_preg);
+#endif
+}
+
+/**
+ * Evaluate the value with the compiled pattern.
+ * @param  value  A value to be evaluated.
+ * @return true   The value matches the pattern.
+ */
+bool AutoConnectInputMatcher::match(const char* value) const {
+  switch (_match) {
+  case AC_MATCH_DIGITS:
+    return _isDigits(value, _min, _max);
+  case AC_MATCH_HOSTNAME:
+    return _isHostname(value);
+  case AC_MATCH_IPV4:
+    return _isIPv4(value);
+  case AC_MATCH_INVALID:
+    return false;
+  default:
+    break;
+  }
 #if defined(ARDUINO_ARCH_ESP8266)
-    regex_t preg;
-    if (regcomp(&preg, pattern.c_str(), REG_EXTENDED) != 0) {
-      AC_DBG("%s regex compile failed\n", pattern.c_str());
-      rc = false;
+  regmatch_t  p_match[1];
+  return regexec(&_preg, value, 1, p_match, 0) == 0;
+#elif defined(ARDUINO_ARCH_ESP32)
+  return std::regex_match(value, *_re);
+#else
+  return true;
+#endif
+}
+
+/**
+ * Identify the built-in matcher of the pattern. The IPv4 and host name
+ * patterns are those AutoConnect uses, and the digits are ^[0-9]{n}$,
+ * ^[0-9]{m,n}$, ^[0-9]+$ and ^[0-9]*$.
+ * @return true  The pattern is evaluated by the built-in matcher.
+ */
+bool AutoConnectInputMatcher::_builtin(void) {
+  static const char ipv4[] PROGMEM = "^(?:(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\\.){3}(?:25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)$";
+  static const char hostname[] PROGMEM = "^(([a-zA-Z0-9]|[a-zA-Z0-9][a-zA-Z0-9\\-]*[a-zA-Z0-9])\\.)*([A-Za-z0-9]|[A-Za-z0-9][A-Za-z0-9\\-]*[A-Za-z0-9])$";
+  static const char digits[] PROGMEM = "^[0-9]";
+
+  if (_pattern.equals(FPSTR(ipv4)))
+    _match = AC_MATCH_IPV4;
+  else if (_pattern.equals(FPSTR(hostname)))
+    _match = AC_MATCH_HOSTNAME;
+  else if (_pattern.startsWith(FPSTR(digits)) && _pattern.endsWith("$")) {
+    const char* q = _pattern.c_str() + sizeof(digits) - sizeof('\0');
+    unsigned int  min, max;
+    int   n = 0;
+    if (!strcmp_P(q, PSTR("+$"))) {
+      min = 1;
+      max = _unbounded;
     }
+    else if (!strcmp_P(q, PSTR("*$"))) {
+      min = 0;
+      max = _unbounded;
+    }
+    else if (sscanf(q, "{%u}$%n", &min, &n) == 1 && n && !q[n] && min < _unbounded)
+      max = min;
     else {
-      regmatch_t  p_match[1];
-      rc = regexec(&preg, value.c_str(), 1, p_match, 0) == 0 ? true : false;
-      regfree(&preg);
+      n = 0;
+      if (sscanf(q, "{%u,%u}$%n", &min, &max, &n) != 2 || !n || q[n] || max >= _unbounded)
+        return false;
     }
-#elif defined(ARDUINO_ARCH_ESP32)
-    const std::regex  re(std::string(pattern.c_str()));
-    rc = std::regex_match(value.c_str(), re);
-#endif
+    if (min > max)
+      return false;
+    _min = min;
+    _max = max;
+    _match = AC_MATCH_DIGITS;
   }
-  return rc;
+  return _match != AC_MATCH_REGEX;
+}
+
+/**
+ * Built-in matcher for the number of digits.
+ */
+bool AutoConnectInputMatcher::_isDigits(const char* value, const uint16_t min, const uint16_t max) {
+  size_t  len = 0;
+  for (; value[len]; len++)
+    if (!isdigit(static_cast<unsigned char>(value[len])))
+      return false;
+  return len >= min && (max == _unbounded || len <= max);
+}
+
+/**
+ * Built-in matcher for the host name that consists of the dot separated
+ * labels of the alphanumeric characters and the inner hyphens.
+ */
+bool AutoConnectInputMatcher::_isHostname(const char* value) {
+  const char* label = value;
+  for (const char* p = value; ; p++) {
+    if (*p == '.' || *p == '\0') {
+      if (p == label || *(p - 1) == '-')
+        return false;
+      if (*p == '\0')
+        return true;
+      label = p + 1;
+    }
+    else if (!isalnum(static_cast<unsigned char>(*p)) && !(*p == '-' && p != label))
+      return false;
+  }
+}
+
+/**
+ * Built-in matcher for the dotted decimal IPv4 address.
+ */
+bool AutoConnectInputMatcher::_isIPv4(const char* value) {
+  for (uint8_t octet = 0; octet < 4; octet++) {
+    unsigned int  n = 0;
+    uint8_t d = 0;
+    for (; isdigit(static_cast<unsigned char>(*value)) && d < 3; value++, d++)
+      n = n * 10 + *value - '0';
+    if (!d || n > 255)
+      return false;
+    if (*value++ != (octet < 3 ? '.' : '\0'))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * Evaluate the pattern as a regexp and return whether value matches.
+ * Always return true if the pattern is undefined. The compiled pattern
+ * is retained until the pattern changes.
+ * @return true  The value matches a pattern.
+ * @return false The value does not match a pattern.
+ */
+bool AutoConnectInputBasis::isValid(void) const {
+  if (!pattern.length())
+    return true;
+  if (!_matcher || _matcher->pattern() != pattern)
+    _matcher.reset(new AutoConnectInputMatcher(pattern));
+  return _matcher->match(value.c_str());
 }
 
 /**
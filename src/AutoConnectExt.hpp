@@ -12,6 +12,7 @@
 #ifndef _AUTOCONNECTEXT_HPP_
 #define _AUTOCONNECTEXT_HPP_
 
+#include <algorithm>
 #include "AutoConnectCoreImpl.hpp"
 #include "AutoConnectAux.h"
 
@@ -37,7 +38,7 @@ class AutoConnectExt : public AutoConnectCore<T> {
   AutoConnectAux* aux(const String& uri) const;
   AutoConnectAux* append(const String& uri, const String& title);
   AutoConnectAux* append(const String& uri, const String& title, WebServer::THandlerFunction handler);
-  bool  detach(const String& uri);
+  bool  detach(const String& uri, const bool dispose = false);
   void  join(AutoConnectAux& aux);
   void  join(AutoConnectAuxVT auxVector);
   AutoConnectAux& locate(const String& uri) const { return *aux(uri); }
@@ -63,6 +64,16 @@ class AutoConnectExt : public AutoConnectCore<T> {
  protected:
   void  _handleUpload(const String& requestUri, const HTTPUpload& upload);
   PageElement*  _setupFetch(const String& uri);
+#ifdef AUTOCONNECT_USE_AUXEVENT
+  PageElement*  _setupEvent(const String& uri);
+#endif
+  AutoConnectAux* _findAux(const String& uri) const;
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  void  _indexAux(void) const;
+  void  _indexGlobals(void);
+  uint32_t  _elementsGeneration(void) const;
+  void  _propagateGlobal(const AutoConnectAux& origin, const AutoConnectElement& element, const String& value);
+#endif
 
 #ifdef AUTOCONNECT_USE_JSON
   template<typename U>
@@ -81,6 +92,22 @@ class AutoConnectExt : public AutoConnectCore<T> {
   AutoConnectAux* _aux = nullptr; /**< A top of registered AutoConnectAux */
   String        _auxUri;        /**< Last accessed AutoConnectAux */
   String        _prevUri;       /**< Previous generated page uri */
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  /** AutoConnectAux pages sorted by the hash of uri */
+  typedef std::pair<uint32_t, AutoConnectAux*>  AC_AUXINDEX_t;
+  mutable std::vector<AC_AUXINDEX_t>  _auxIndex;
+  mutable bool  _auxIndexed = false;          /**< _auxIndex reflects the current pages */
+  /** Peers of the global elements across the AutoConnectAux pages */
+  typedef struct {
+    uint32_t  hash;                 /**< Hash of the element name */
+    AutoConnectAux*     aux;        /**< AutoConnectAux page that contains the element */
+    AutoConnectElement* element;    /**< The element that receives the global value */
+  } AC_GLOBALPEER_t;
+  std::vector<AC_GLOBALPEER_t>  _globalPeers; /**< Peers sorted by the name hash */
+  uint32_t      _auxGeneration = 1;           /**< Bumped whenever a page joins or detaches */
+  uint32_t      _globalChain = 0;             /**< _auxGeneration that _globalPeers reflects */
+  uint32_t      _globalGeneration = 0;        /**< Sum of the page generations that _globalPeers reflects */
+#endif
   /** Available updater, only reset by AutoConnectUpdate::attach is valid */
   std::unique_ptr<AutoConnectUpdate>  _update;
   /** OTA updater */
@@ -94,6 +121,9 @@ class AutoConnectExt : public AutoConnectCore<T> {
   inline void _enableUpdate(void) override;
   inline bool _handleOTA(void) override;
   inline bool _handleUpdate(void) override;
+#ifdef AUTOCONNECT_USE_AUXEVENT
+  inline void _handleEvent(void) override;
+#endif
   inline void _registerOnUpload(PageBuilder* page) override;
   inline void _releaseAux(const String& uri) override;
   inline void _saveCurrentUri(const String& uri) override;
@@ -110,12 +140,7 @@ class AutoConnectExt : public AutoConnectCore<T> {
  */
 template<typename T>
 AutoConnectAux* AutoConnectExt<T>::aux(const String& uri) const {
-  AutoConnectAux* aux_p = _aux;
-  while (aux_p) {
-    if (!strcmp(aux_p->uri(), uri.c_str()))
-      break;
-    aux_p = aux_p->_next;
-  }
+  AutoConnectAux* aux_p = _findAux(uri);
   if (!aux_p) {
     AC_DBG("'%s' not found in auxiliaries", uri.c_str());
     if (uri[0] != '/') {
@@ -138,7 +163,146 @@ void AutoConnectExt<T>::join(AutoConnectAux& aux) {
   else
     _aux = &aux;
   aux._join(*this);
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  _auxIndexed = false;
+  _auxGeneration++;
+#endif
   AC_DBG("%s on hands\n", aux.uri());
 }
 
+/**
+ * Find the AutoConnectAux page of the uri. The index of the uri hash
+ * narrows down the page without walking the chain. If the index has no
+ * match, the chain is walked as a safeguard against the page whose uri
+ * has been rewritten after joining, and the index is rebuilt when found.
+ * @param  uri  An uri string.
+ * @return A pointer of AutoConnectAux instance, nullptr if not joined.
+ */
+template<typename T>
+AutoConnectAux* AutoConnectExt<T>::_findAux(const String& uri) const {
+#ifdef AUTOCONNECT_USE_AUXINDEX
+  if (!_auxIndexed)
+    _indexAux();
+  const uint32_t  hash = AutoConnectAux::_hashName(uri.c_str(), false);
+  auto  itr = std::lower_bound(_auxIndex.begin(), _auxIndex.end(), hash,
+    [](const AC_AUXINDEX_t& index, const uint32_t hash) {
+      return index.first < hash;
+    });
+  for (; itr != _auxIndex.end() && itr->first == hash; ++itr)
+    if (!strcmp(itr->second->uri(), uri.c_str()))
+      return itr->second;
+#endif
+
+  for (AutoConnectAux* aux_p = _aux; aux_p; aux_p = aux_p->_next)
+    if (!strcmp(aux_p->uri(), uri.c_str())) {
+#ifdef AUTOCONNECT_USE_AUXINDEX
+      _indexAux();
+#endif
+      return aux_p;
+    }
+  return nullptr;
+}
+
+#ifdef AUTOCONNECT_USE_AUXINDEX
+/**
+ * Rebuild the index of the joined AutoConnectAux pages. The pages with
+ * the same uri are kept in the order of the chain so that the first
+ * joined page takes precedence.
+ */
+template<typename T>
+void AutoConnectExt<T>::_indexAux(void) const {
+  _auxIndex.clear();
+  for (AutoConnectAux* aux_p = _aux; aux_p; aux_p = aux_p->_next)
+    _auxIndex.push_back(AC_AUXINDEX_t(AutoConnectAux::_hashName(aux_p->uri(), false), aux_p));
+  std::stable_sort(_auxIndex.begin(), _auxIndex.end(),
+    [](const AC_AUXINDEX_t& a, const AC_AUXINDEX_t& b) {
+      return a.first < b.first;
+    });
+  _auxIndexed = true;
+}
+#endif
+
+#ifdef AUTOCONNECT_USE_AUXINDEX
+/**
+ * Sum up the generations of the elements on all pages. Each generation
+ * only increases, so the sum changes whenever the elements of any page
+ * may have changed as long as the chain of pages is the same.
+ * @return The sum of the generations.
+ */
+template<typename T>
+uint32_t AutoConnectExt<T>::_elementsGeneration(void) const {
+  uint32_t  generation = 0;
+  for (AutoConnectAux* aux = _aux; aux; aux = aux->_next)
+    generation += aux->_currentGeneration();
+  return generation;
+}
+
+/**
+ * Build the registry of the global element peers. For each name of the
+ * elements declared as global, it registers the element with the same
+ * name on every AutoConnectAux page, which receives the value when the
+ * global element is stored. The registry holds pointers to the pages and
+ * the elements, so it is rebuilt whenever a page joins or detaches, or
+ * the elements of a page are added, released or changed through
+ * getElements.
+ */
+template<typename T>
+void AutoConnectExt<T>::_indexGlobals(void) {
+  _globalPeers.clear();
+  for (AutoConnectAux* owner = _aux; owner; owner = owner->_next) {
+    for (AutoConnectElement& global : owner->_addonElm) {
+      if (!global.global)
+        continue;
+      const uint32_t  hash = AutoConnectAux::_hashName(global.name.c_str(), false);
+      bool  registered = false;
+      for (const AC_GLOBALPEER_t& peer : _globalPeers)
+        if (peer.hash == hash && peer.element->name.equalsIgnoreCase(global.name)) {
+          registered = true;
+          break;
+        }
+      if (registered)
+        continue;
+      for (AutoConnectAux* aux = _aux; aux; aux = aux->_next) {
+        AutoConnectElement* element = aux->_findElement(global.name.c_str(), false);
+        if (element)
+          _globalPeers.push_back({ hash, aux, element });
+      }
+    }
+  }
+  std::stable_sort(_globalPeers.begin(), _globalPeers.end(),
+    [](const AC_GLOBALPEER_t& a, const AC_GLOBALPEER_t& b) {
+      return a.hash < b.hash;
+    });
+  _globalChain = _auxGeneration;
+  _globalGeneration = _elementsGeneration();
+}
+
+/**
+ * Copy the value of the global element to its peers on the other
+ * AutoConnectAux pages.
+ * @param  origin   AutoConnectAux page that contains the global element.
+ * @param  element  The global element whose value was stored.
+ * @param  value    The stored value.
+ */
+template<typename T>
+void AutoConnectExt<T>::_propagateGlobal(const AutoConnectAux& origin, const AutoConnectElement& element, const String& value) {
+  const uint32_t  hash = AutoConnectAux::_hashName(element.name.c_str(), false);
+  auto  lessHash = [](const AC_GLOBALPEER_t& peer, const uint32_t hash) {
+    return peer.hash < hash;
+  };
+
+  if (_globalChain != _auxGeneration || _globalGeneration != _elementsGeneration())
+    _indexGlobals();
+  auto  itr = std::lower_bound(_globalPeers.begin(), _globalPeers.end(), hash, lessHash);
+  // An element turned global after indexing has no peers yet.
+  if (itr == _globalPeers.end() || itr->hash != hash) {
+    _indexGlobals();
+    itr = std::lower_bound(_globalPeers.begin(), _globalPeers.end(), hash, lessHash);
+  }
+  for (; itr != _globalPeers.end() && itr->hash == hash; ++itr)
+    if (itr->aux != &origin && itr->element->name.equalsIgnoreCase(element.name))
+      AutoConnectAux::_setValue(*itr->element, value);
+}
+#endif
+
 #endif  // _AUTOCONNECTEXT_HPP_
@@ -47,7 +47,7 @@ void AutoConnectExt<T>::end(void) {
  */
 template<typename T>
 AutoConnectAux* AutoConnectExt<T>::append(const String& uri, const String& title) {
-  AutoConnectAux* reg = aux(uri);
+  AutoConnectAux* reg = _findAux(uri);
   if (!reg) {
     reg = new AutoConnectAux(uri, title);
     AC_DBG("%s newly added\n", uri.c_str());
@@ -83,19 +83,28 @@ AutoConnectAux* AutoConnectExt<T>::append(const String& uri, const String& title
 
 /**
  * Detach a AutoConnectAux from the portal.
- * @param  uri    An uri of the AutoConnectAux should be released
- * @return true   Specified AUX has released
- * @return false  Specified AUX not registered
+ * @param  uri      An uri of the AutoConnectAux should be released
+ * @param  dispose  Delete the AutoConnectAux created by load
+ * @return true     Specified AUX has released
+ * @return false    Specified AUX not registered
  */
 template<typename T>
-bool AutoConnectExt<T>::detach(const String &uri) {
+bool AutoConnectExt<T>::detach(const String &uri, const bool dispose) {
   AutoConnectAux**  self = &_aux;
   while (*self) {
     if (!strcmp((*self)->uri(), uri.c_str())) {
       AC_DBG("%s released\n", (*self)->uri());
       AutoConnectAux* ref = *self;
       *self = (*self)->_next;
-      if (ref->_deletable)
+#ifdef AUTOCONNECT_USE_AUXINDEX
+      _auxIndexed = false;
+      _auxGeneration++;
+#endif
+      // Unlink the page from the chain so that it can be joined again.
+      ref->_next = nullptr;
+      // The page loaded from JSON may still be referred to by the sketch
+      // or be building its response, so it is deleted only on request.
+      if (ref->_deletable || (dispose && ref->_disposable))
         delete ref;
       return true;
     }
@@ -129,13 +138,10 @@ void AutoConnectExt<T>::join(AutoConnectAuxVT auxVector) {
  */
 template<typename T>
 bool AutoConnectExt<T>::on(const String& uri, const AuxHandlerFunctionT handler, AutoConnectExitOrder_t order) {
-  AutoConnectAux* aux = _aux;
-  while (aux) {
-    if (!strcmp(uri.c_str(), aux->uri())) {
-      aux->on(handler, order);
-      return true;
-    }
-    aux = aux->_next;
+  AutoConnectAux* aux = _findAux(uri);
+  if (aux) {
+    aux->on(handler, order);
+    return true;
   }
   AC_DBG("%s not registered, handler ignored\n", uri.c_str());
   return false;
@@ -234,6 +240,26 @@ PageElement* AutoConnectExt<T>::_setupFetch(const String& uri) {
   return endpointElement;
 }
 
+#ifdef AUTOCONNECT_USE_AUXEVENT
+/**
+ * Allow AutoConnect to respond to `/_ac/event` endpoint requests, which
+ * subscribe to the event stream of AutoConnectAux page. As with the Fetch
+ * endpoint, AutoConnectAux::_eventEndpoint identifies the page from the
+ * request arguments.
+ * @param   uri  URL of the requested endpoint, unused.
+ * @return  Registered PageElement of the handler accepting the subscription.
+ */
+template<typename T>
+PageElement* AutoConnectExt<T>::_setupEvent(const String& uri) {
+  AC_UNUSED(uri);
+  PageElement*  endpointElement = new PageElement();
+
+  endpointElement->setMold(FPSTR("{{RES}}"));
+  endpointElement->addToken(FPSTR("RES"), std::bind(&AutoConnectAux::_eventEndpoint, _aux, std::placeholders::_1));
+  return endpointElement;
+}
+#endif
+
 /**
  * For OTA, the upload process is handled with each turn of the handleRequst.
  * When the upload is complete and the system is waiting for a reboot, it will
@@ -289,20 +315,27 @@ inline bool AutoConnectExt<T>::_handleUpdate(void) {
   return false;
 }
 
+#ifdef AUTOCONNECT_USE_AUXEVENT
+/**
+ * Send the heartbeat to the browsers subscribing to the event stream
+ * of each AutoConnectAux page.
+ */
+template<typename T>
+inline void AutoConnectExt<T>::_handleEvent(void) {
+  for (AutoConnectAux* aux = _aux; aux; aux = aux->_next)
+    aux->_keepAlive();
+}
+#endif
+
 /**
  * A wrapper of the upload function for the WebServerClass. Invokes the
  * upload function of the AutoConnectAux which has a destination URI.
  */
 template<typename T>
 void AutoConnectExt<T>::_handleUpload(const String& requestUri, const HTTPUpload& upload) {
-  AutoConnectAux* aux = _aux;
-  while (aux) {
-    if (aux->_uri == requestUri) {
-      aux->upload(_prevUri, upload);
-      break;
-    }
-    aux = aux->_next;
-  }
+  AutoConnectAux* aux = _findAux(requestUri);
+  if (aux)
+    aux->upload(_prevUri, upload);
 }
 
 /**
@@ -328,9 +361,17 @@ inline void AutoConnectExt<T>::_releaseAux(const String& uri) {
       // Fetch-API requested. Prepare to accept by pseudo-endpoint.
       AutoConnectCore<T>::_currentPageElement.reset(_setupFetch(uri));
     }
+#ifdef AUTOCONNECT_USE_AUXEVENT
+    else if (uri == String(F(AUTOCONNECT_URI_EVENT))) {
+      // EventSource requested. Hand the connection over to the page.
+      AutoConnectCore<T>::_currentPageElement.reset(_setupEvent(uri));
+    }
+#endif
     else {
       // Requested URL is not a normal page, exploring AUX pages
-      AutoConnectCore<T>::_currentPageElement.reset(_aux->_setupPage(uri));
+      AutoConnectAux* aux = _findAux(uri);
+      if (aux)
+        AutoConnectCore<T>::_currentPageElement.reset(aux->_setupPage(uri));
     }
   }
 }
@@ -421,12 +462,53 @@ bool AutoConnectExt<T>::load(const String& aux) {
  * Load AutoConnectAux page from JSON description from the stream.
  * This function can load AutoConnectAux for multiple AUX pages written
  * in JSON and is registered in AutoConnect.
+ * The pages are read from the stream one by one and each page loads
+ * its elements one at a time without deserializing the whole stream.
+ * None of the pages join unless the whole stream is valid.
  * @param  aux  Stream for read AutoConnectAux elements.
  * @return true Successfully loaded.
  */
 template<typename T>
 bool AutoConnectExt<T>::load(Stream& aux) {
-  return _parseJson<Stream&>(aux);
+  std::vector<AutoConnectAux*>  pages;
+  bool  rc = true;
+
+  const bool  array = AutoConnectAux::_peekJson(aux) == '[';
+  if (array)
+    AutoConnectAux::_timedRead(aux);
+
+  int c = AutoConnectAux::_peekJson(aux);
+  while (!array || c != ']') {
+    AutoConnectAux* newAux = new AutoConnectAux;
+    newAux->_disposable = true;
+    pages.push_back(newAux);
+    if (!(rc = newAux->_streamPage(aux)))
+      break;
+    if (!array)
+      break;
+    c = AutoConnectAux::_peekJson(aux);
+    if (c == ',') {
+      AutoConnectAux::_timedRead(aux);
+      c = AutoConnectAux::_peekJson(aux);
+    }
+    else if (c != ']') {
+      AC_DBG("JSON parse error\n");
+      rc = false;
+      break;
+    }
+  }
+  if (rc && array)
+    AutoConnectAux::_timedRead(aux);
+
+  // The pages join only after the whole document has been parsed, so a
+  // broken document leaves the current pages as they are.
+  for (AutoConnectAux* newAux : pages) {
+    if (rc)
+      join(*newAux);
+    else
+      delete newAux;
+  }
+  return rc;
 }
 
 /**
@@ -441,6 +523,7 @@ bool AutoConnectExt<T>::_load(JsonVariant& auxJson) {
     ArduinoJsonArray  jb = auxJson.as<JsonArray>();
     for (ArduinoJsonObject  auxJson : jb) {
       AutoConnectAux* newAux = new AutoConnectAux;
+      newAux->_disposable = true;
       if (newAux->_load(auxJson))
         join(*newAux);
       else {
@@ -453,6 +536,7 @@ bool AutoConnectExt<T>::_load(JsonVariant& auxJson) {
   else {
     ArduinoJsonObject jb = auxJson.as<JsonObject>();
     AutoConnectAux* newAux = new AutoConnectAux;
+    newAux->_disposable = true;
     if (newAux->_load(jb))
       join(*newAux);
     else {
@@ -473,8 +557,8 @@ bool AutoConnectExt<T>::_load(JsonVariant& auxJson) {
 template<typename T>
 String AutoConnectExt<T>::_mold_MENU_AUX(PageArgument& args) {
   String  menuItem = String("");
-  if (_aux)
-    menuItem = _aux->_injectMenu(args);
+  for (AutoConnectAux* aux = _aux; aux; aux = aux->_next)
+    menuItem += aux->_injectMenu(args);
   return menuItem;
 }
 
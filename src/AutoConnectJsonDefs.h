@@ -17,7 +17,8 @@
  * version. These declarations share the following type definitions:
  * - Difference between reference and proxy of JsonObject and JsonArray.
  * - Difference of check whether the parsing succeeded or not.
- * - The print function name difference.
+ * - The print function name difference and the line break of the
+ *   pretty print.
  * - The buffer class difference.
  * - When PSRAM present, enables the buffer allocation it with ESP32 and
  *   supported version.
@@ -29,6 +30,7 @@
 #define ARDUINOJSON_PRETTYPRINT(doc, out) ({ size_t s = doc.prettyPrintTo(out); s; })
 #define ARDUINOJSON_PRINT(doc, out)       ({ size_t s = doc.printTo(out); s; })
 #define ARDUINOJSON_OBJECT_REFMODIFY
+#define AUTOCONNECT_JSON_NEWLINE          "\r\n"
 using ArduinoJsonObject = JsonObject&;
 using ArduinoJsonArray = JsonArray&;
 using ArduinoJsonBuffer = DynamicJsonBuffer;
@@ -40,6 +42,7 @@ using ArduinoJsonBuffer = DynamicJsonBuffer;
 #define ARDUINOJSON_PRETTYPRINT(doc, out) ({ size_t s = serializeJsonPretty(doc, out); s; })
 #define ARDUINOJSON_PRINT(doc, out)       ({ size_t s = serializeJson(doc, out); s; })
 #define ARDUINOJSON_OBJECT_REFMODIFY      const
+#define AUTOCONNECT_JSON_NEWLINE          "\n"
 using ArduinoJsonObject = JsonObject;
 using ArduinoJsonArray = JsonArray;
 #if defined(BOARD_HAS_PSRAM) && ((ARDUINOJSON_VERSION_MAJOR==6 && ARDUINOJSON_VERSION_MINOR>=10) || ARDUINOJSON_VERSION_MAJOR>6)
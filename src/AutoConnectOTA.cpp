@@ -12,23 +12,21 @@
 #if defined(ARDUINO_ARCH_ESP8266)
 #include <WiFiUdp.h>
 #include <Updater.h>
-#ifdef AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP
-#include <regex.h>
-#endif
 #elif defined(ARDUINO_ARCH_ESP32)
 #include <Update.h>
 #include <esp_ota_ops.h>
-#ifdef AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP
-#include <regex>
-#include <esp_pthread.h>
-#include <thread>
-#endif
 #endif
 #include <StreamString.h>
 #include "AutoConnectExt.hpp"
 #include "AutoConnectOTA.h"
+#include "AutoConnectOTAMatch.h"
 #include "AutoConnectOTAPage.h"
 
+static_assert(AUTOCONNECT_OTA_BUFFERSIZE % 4096 == 0, "AUTOCONNECT_OTA_BUFFERSIZE must be a multiple of the flash sector size");
+#ifdef AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP
+static_assert(AutoConnectOTAMatch::isSuffix("^.+\\.bin$"), "The default AUTOCONNECT_UPLOAD_ASFIRMWARE must be matched without the regex");
+#endif
+
 /**
  * A destructor. Release the OTA operation pages.
  */
@@ -158,48 +156,42 @@ bool AutoConnectOTA::_open(const char* filename, const char* mode) {
 // AUTOCONNECT_UPLOAD_ASFIRMWARE.
 // AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP allows you to use regular
 // expressions with the extension to determine the uploading destination.
-#ifndef AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP
-  String  asBin(F(AUTOCONNECT_UPLOAD_ASFIRMWARE));
-  _binName.toLowerCase();
-  asBin.toLowerCase();
-  _dest = _binName.endsWith(asBin) == true ? OTA_DEST_FIRM : OTA_DEST_FILE;
+// The pattern is compiled once at the first upload, and the regular
+// expression of the suffix form is evaluated without the regex.
+#ifdef AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP
+  static const AutoConnectOTAMatch  asBin(AUTOCONNECT_UPLOAD_ASFIRMWARE, true);
 #else
-// It is recommended to avoid introducing regular expressions in the
-// judgment to make the file a firmware upload as much as possible.
-#if defined(ARDUINO_ARCH_ESP8266)
-  regex_t preg;
-  if (!regcomp(&preg, AUTOCONNECT_UPLOAD_ASFIRMWARE, REG_ICASE | REG_EXTENDED | REG_NOSUB)) {
-    regmatch_t  p_match[1];
-    _dest = !regexec(&preg, _binName.c_str(), 1, p_match, 0) ? OTA_DEST_FIRM : OTA_DEST_FILE;
-    regfree(&preg);
-  }
-  else {
+  static const AutoConnectOTAMatch  asBin(AUTOCONNECT_UPLOAD_ASFIRMWARE);
+#endif
+  if (!asBin.valid()) {
     _setError("regex failed:" AUTOCONNECT_UPLOAD_ASFIRMWARE);
     return false;
   }
-#elif defined(ARDUINO_ARCH_ESP32)
-// Especially on the ESP32 platform, std::regex fattens the elf, also
-// requires many stack area. It easily eats up the FreeRTOS stack
-// (8KB by default) allocated to an Arduino loop thread.
-// To avoid this, AutoConnectOTA spawns a thread exclusively for regular
-// expression evaluation just. But it comes with a heavy price and no meaning.
-  esp_pthread_cfg_t t_cfg;
-  if (esp_pthread_get_cfg(&t_cfg) != ESP_OK) {
-    // t_cfg = esp_pthread_get_default_config();
-  }
-  t_cfg.stack_size = 1024 * 10;
-  esp_pthread_set_cfg(&t_cfg);
-  std::thread t_regex([&]() {
-    const std::regex  re(std::string(AUTOCONNECT_UPLOAD_ASFIRMWARE), std::regex_constants::icase | std::regex_constants::extended | std::regex_constants::nosubs);
-    _dest = std::regex_match(_binName.c_str(), re) ? OTA_DEST_FIRM : OTA_DEST_FILE;
-  });
-  t_regex.join();
+  _dest = asBin.match(_binName.c_str()) ? OTA_DEST_FIRM : OTA_DEST_FILE;
+
+#if defined(ARDUINO_ARCH_ESP8266) || defined(AUTOCONNECT_USE_OTAINFLATE)
+  // The gzip-compressed firmware is identified by the fixed extension.
+  static const AutoConnectOTAMatch  asGz(AUTOCONNECT_UPLOAD_ASCOMPRESSED);
+  const bool  compressed = asGz.match(_binName.c_str());
+  if (compressed)
+    _dest = OTA_DEST_FIRM;
 #endif
+#ifdef AUTOCONNECT_USE_OTAINFLATE
+  _inflating = compressed;
 #endif
 
   _err.clear();
   AC_DBG("OTA:%s %s\n", _dest == OTA_DEST_FIRM ? "app" : "fs", _binName.c_str());
   if (_dest == OTA_DEST_FIRM) {
+#ifdef AUTOCONNECT_USE_OTAINFLATE
+    // The window is taken ahead of the Update that also takes the heap.
+    if (_inflating) {
+      if (!_inflate.begin(std::bind(&AutoConnectOTABuffer::write, &_buffer, std::placeholders::_1, std::placeholders::_2))) {
+        _setError("No heap to inflate");
+        return false;
+      }
+    }
+#endif
     uint32_t  maxSketchSpace = (ESP.getFreeSketchSpace() - 0x1000) & 0xFFFFF000;
     // It only supports FLASH as a sketch area for updating.
     bc = Update.begin(maxSketchSpace, U_FLASH);
@@ -214,6 +206,7 @@ bool AutoConnectOTA::_open(const char* filename, const char* mode) {
     else
       bc = _fs->begin(AUTOCONNECT_FS_INITIALIZATION);
     if (bc) {
+      _filePath = String(filename);
       _file = _fs->open(filename, "w");
       if (!_file) {
         bc = false;
@@ -227,6 +220,7 @@ bool AutoConnectOTA::_open(const char* filename, const char* mode) {
   if (bc) {
     if (_tickerPort != -1)
       pinMode(static_cast<uint8_t>(_tickerPort), OUTPUT);
+    _buffer.begin(std::bind(&AutoConnectOTA::_flash, this, std::placeholders::_1, std::placeholders::_2));
     _otaStatus = AC_OTA_START;
     _ulAmount = 0;
     AC_DBG("%s up%s start\n", filename, _dest == OTA_DEST_FIRM ? "dating" : "loading");
@@ -235,7 +229,9 @@ bool AutoConnectOTA::_open(const char* filename, const char* mode) {
 }
 
 /**
- * Writes received updater to the flash.
+ * Writes received updater to the flash. The received chunks are
+ * coalesced into the blocks of AUTOCONNECT_OTA_BUFFERSIZE, which are
+ * written by _flash.
  * This function overrides AutoConnectUploadHandler::_write.
  * @param  buf  Buffer address where received update file was stored.
  * @param  size Size to be written.
@@ -254,24 +250,47 @@ size_t AutoConnectOTA::_write(const uint8_t *buf, const size_t size) {
   }
 #endif
 
-  if (_tickerPort != -1)
-    digitalWrite(_tickerPort, digitalRead(_tickerPort) ^ 0x01);
   if (!_err.length()) {
     _otaStatus = AC_OTA_PROGRESS;
-    if (_dest == OTA_DEST_FIRM) {
-      wsz = Update.write(const_cast<uint8_t*>(buf), size);
-      if (wsz != size)
-        _setError();
+#ifdef AUTOCONNECT_USE_OTAINFLATE
+    if (_inflating) {
+      // The decompressed data goes to the buffer.
+      wsz = _inflate.write(buf, size);
+      if (wsz != size && !_buffer.failed()) {
+        _setError("Broken gzip stream");
+        return wsz;
+      }
     }
-    else {
-      wsz = _file.write(buf, size);
-      if (wsz != size)
+    else
+#endif
+    wsz = _buffer.write(buf, size);
+    if (wsz != size) {
+      if (_dest == OTA_DEST_FIRM)
+        _setError();
+      else
         _setError("Incomplete writing");
     }
   }
   return wsz;
 }
 
+/**
+ * Writes a coalesced block to the flash or the file, and flickers the
+ * ticker. It may be called from the writer thread of AutoConnectOTABuffer,
+ * so it does not touch the error status.
+ * @param  buf  The block to be written.
+ * @param  size Size of the block.
+ * @return      the amount written
+ */
+size_t AutoConnectOTA::_flash(const uint8_t* buf, const size_t size) {
+  if (_tickerPort != -1)
+    digitalWrite(_tickerPort, digitalRead(_tickerPort) ^ 0x01);
+  if (_dest == OTA_DEST_FIRM)
+    return Update.write(const_cast<uint8_t*>(buf), size);
+  else
+    return _file.write(buf, size);
+}
+
 /**
  * All bytes are written, this call writes the config to reboot.
  * If there is an error this will clear everything.
@@ -286,15 +305,41 @@ void AutoConnectOTA::_close(const HTTPUploadStatus status) {
   // Updater class, and native file uploading closes the file.
   bool  bc = status == UPLOAD_FILE_END;
 
+#ifdef AUTOCONNECT_USE_OTAINFLATE
+  // The compressed firmware must be decompressed up to the end.
+  if (_inflating) {
+    if (!_inflate.end() && bc && !_err.length())
+      _setError("Incomplete gzip stream");
+    _inflating = false;
+  }
+#endif
+  // Do not commit the firmware that has failed.
+  if (_err.length())
+    bc = false;
+
+  // Write out the last block before closing.
+  if (!_buffer.end(bc && !_err.length()) && !_err.length()) {
+    if (_dest == OTA_DEST_FIRM)
+      _setError();
+    else
+      _setError("Incomplete writing");
+  }
+
   if (_dest == OTA_DEST_FIRM) {
     if (!Update.end(bc)) {
-      _setError();
+      // Keep the error that caused the abort, such as a digest mismatch.
+      if (!_err.length())
+        _setError();
       AC_DBG("Failed to flash");
     }
   }
   else {
-    if (_file)
+    if (_file) {
       _file.close();
+      // Do not leave the incomplete file.
+      if (!bc)
+        _fs->remove(_filePath);
+    }
   }
 
   if (!_err.length()) {
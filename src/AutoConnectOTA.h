@@ -22,6 +22,8 @@
 #include "AutoConnectAux.h"
 #include "AutoConnectUpload.h"
 #include "AutoConnectFS.h"
+#include "AutoConnectOTABuffer.h"
+#include "AutoConnectOTAInflate.h"
 
 class AutoConnectOTA : public AutoConnectUploadHandler {
 public:
@@ -59,6 +61,7 @@ protected:
   bool    _open(const char* filename, const char* mode) override;
   size_t  _write(const uint8_t *buf, const size_t size) override;
   void    _close(const HTTPUploadStatus status) override;
+  size_t  _flash(const uint8_t* buf, const size_t size);
   String  _updated(AutoConnectAux& result, PageArgument& args);
   void    _setError(const char* err) override;
 
@@ -76,6 +79,12 @@ protected:
 
   AutoConnectFS::FS*  _fs;      /**< Filesystem for the native file uploading */
   fs::File  _file;              /**< File handler for the native file uploading */
+  String  _filePath;            /**< Path of the file for the native file uploading */
+  AutoConnectOTABuffer  _buffer;  /**< Coalesces the received chunks into the sectors */
+#ifdef AUTOCONNECT_USE_OTAINFLATE
+  AutoConnectOTAInflate _inflate; /**< Decompresses the gzip-compressed firmware */
+  bool  _inflating = false;     /**< The firmware being uploaded is compressed */
+#endif
 
   static const AutoConnectAux::ACPage_t         _pageUpdate  PROGMEM;
   static const AutoConnectAux::ACElementProp_t  _elmUpdate[] PROGMEM;
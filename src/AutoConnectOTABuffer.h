@@ -0,0 +1,224 @@
+/**
+ * Declaration of AutoConnectOTABuffer class, which coalesces the data
+ * uploaded by AutoConnectOTA into the blocks aligned with the flash
+ * sector.
+ * @file AutoConnectOTABuffer.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTOTABUFFER_H_
+#define _AUTOCONNECTOTABUFFER_H_
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdint.h>
+#include <string.h>
+#include "AutoConnectDefs.h"
+#ifdef AUTOCONNECT_USE_OTAWRITER
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_pthread.h>
+#endif
+#endif
+
+/**
+ * AutoConnectOTABuffer accumulates the received chunks of any size
+ * and passes them to the writer in the blocks of the fixed size, so
+ * that the flash and the file are written sector by sector. With
+ * AUTOCONNECT_USE_OTAWRITER, the filled block of the threaded buffer is
+ * handed over to the writer thread and the next block is received into
+ * the other buffer while the previous one is being written. The buffer
+ * constructed without the thread uses a single block that is written
+ * by the caller of write, as the upload handlers of AutoConnectFile
+ * do. If the buffer cannot be
+ * allocated, the chunks are passed through to the writer as they are.
+ * Note that the writer is called from the writer thread, not from the
+ * task that calls write, and it must not touch the state of the caller
+ * other than through its return value.
+ */
+class AutoConnectOTABuffer {
+ public:
+  typedef std::function<size_t(const uint8_t*, const size_t)> WriterFuncT;
+
+  explicit AutoConnectOTABuffer(const size_t blockSize = AUTOCONNECT_OTA_BUFFERSIZE, const bool threaded = true) : _blockSize(blockSize), _len(0), _failed(false), _threaded(threaded) {}
+  AutoConnectOTABuffer(const AutoConnectOTABuffer&) = delete;
+  AutoConnectOTABuffer& operator=(const AutoConnectOTABuffer&) = delete;
+  ~AutoConnectOTABuffer() { end(false); }
+
+  /**
+   * Allocate the buffers and start the writer.
+   * @param  writer  A function that writes the block and returns the
+   * number of bytes written.
+   * @return true   The blocks are coalesced.
+   * @return false  The buffer is not available and the chunks are
+   * passed through.
+   */
+  bool  begin(WriterFuncT writer) {
+    end(false);
+    _writer = writer;
+    _len = 0;
+    _failed = false;
+    if (_blockSize) {
+      _fill.reset(new (std::nothrow) uint8_t[_blockSize]);
+#ifdef AUTOCONNECT_USE_OTAWRITER
+      if (_threaded && _fill)
+        _pending.reset(new (std::nothrow) uint8_t[_blockSize]);
+      if (_fill && _pending) {
+        _pendingLen = 0;
+        _stop = false;
+#ifdef ARDUINO_ARCH_ESP32
+        // The writer runs at the same priority as the receiver so that
+        // neither of them starves the other while waiting for the flash.
+        esp_pthread_cfg_t t_cfg = esp_pthread_get_default_config();
+        t_cfg.stack_size = AUTOCONNECT_OTAWRITER_STACKSIZE;
+        t_cfg.prio = uxTaskPriorityGet(NULL);
+        esp_pthread_set_cfg(&t_cfg);
+#endif
+        _thread = std::thread(&AutoConnectOTABuffer::_run, this);
+      }
+      else
+        _pending.reset();
+#endif
+      if (!_fill)
+        AC_DBG("OTA buffer %u bytes unavailable\n", (unsigned int)_blockSize);
+    }
+    return _fill ? true : false;
+  }
+
+  /**
+   * Accumulate the chunk and write the blocks filled up.
+   * @param  buf   The received chunk.
+   * @param  size  Size of the chunk.
+   * @return The size of the chunk accepted, 0 if the writer has failed.
+   */
+  size_t  write(const uint8_t* buf, const size_t size) {
+    if (failed())
+      return 0;
+    if (!_fill) {
+      if (_writer(buf, size) != size)
+        _failed = true;
+      return _failed ? 0 : size;
+    }
+
+    size_t  remain = size;
+    while (remain) {
+      size_t  chunk = std::min(_blockSize - _len, remain);
+      memcpy(_fill.get() + _len, buf, chunk);
+      _len += chunk;
+      buf += chunk;
+      remain -= chunk;
+      if (_len == _blockSize && !_commit())
+        return 0;
+    }
+    return size;
+  }
+
+  /**
+   * Write the remaining partial block, wait for the writer to finish
+   * and release the buffers.
+   * @param  flush  false discards the remaining partial block.
+   * @return true   All blocks have been written.
+   */
+  bool  end(const bool flush = true) {
+    if (flush && _len && !failed())
+      _commit();
+    _len = 0;
+#ifdef AUTOCONNECT_USE_OTAWRITER
+    if (_thread.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _cond.notify_all();
+      _thread.join();
+    }
+    _pending.reset();
+#endif
+    _fill.reset();
+    return !_failed;
+  }
+
+  /**
+   * Returns whether the writer has failed.
+   */
+  bool  failed(void) {
+#ifdef AUTOCONNECT_USE_OTAWRITER
+    std::lock_guard<std::mutex> lock(_mutex);
+#endif
+    return _failed;
+  }
+
+ protected:
+  /**
+   * Pass the filled block to the writer. With the writer thread, it
+   * waits until the previous block has been written, and swaps the
+   * buffers.
+   * @return false  The writer has failed.
+   */
+  bool  _commit(void) {
+#ifdef AUTOCONNECT_USE_OTAWRITER
+    if (_thread.joinable()) {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _cond.wait(lock, [this]() { return !_pendingLen || _failed; });
+      if (_failed)
+        return false;
+      _fill.swap(_pending);
+      _pendingLen = _len;
+      _len = 0;
+      lock.unlock();
+      _cond.notify_all();
+      return true;
+    }
+#endif
+    if (_writer(_fill.get(), _len) != _len)
+      _failed = true;
+    _len = 0;
+    return !_failed;
+  }
+
+#ifdef AUTOCONNECT_USE_OTAWRITER
+  /**
+   * The writer thread writes the pending blocks until it is stopped.
+   */
+  void  _run(void) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    for (;;) {
+      _cond.wait(lock, [this]() { return _pendingLen || _stop; });
+      if (!_pendingLen)
+        break;
+      const size_t  len = _pendingLen;
+      lock.unlock();
+      const bool  written = _writer(_pending.get(), len) == len;
+      lock.lock();
+      if (!written)
+        _failed = true;
+      _pendingLen = 0;
+      _cond.notify_all();
+    }
+  }
+#endif
+
+  const size_t  _blockSize;           /**< Size of the block to be written */
+  size_t  _len;                       /**< Bytes accumulated in the block being filled */
+  bool    _failed;                    /**< The writer has failed */
+  const bool  _threaded;              /**< Write in the writer thread if available */
+  WriterFuncT _writer;                /**< The writer of the blocks */
+  std::unique_ptr<uint8_t[]>  _fill;  /**< The block being filled */
+#ifdef AUTOCONNECT_USE_OTAWRITER
+  std::unique_ptr<uint8_t[]>  _pending; /**< The block being written by the writer thread */
+  size_t  _pendingLen = 0;            /**< Bytes of the pending block, 0 if the writer is idle */
+  bool    _stop = false;              /**< Request to stop the writer thread */
+  std::mutex  _mutex;
+  std::condition_variable _cond;
+  std::thread _thread;
+#endif
+};
+
+#endif // !_AUTOCONNECTOTABUFFER_H_
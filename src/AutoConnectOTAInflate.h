@@ -0,0 +1,202 @@
+/**
+ * Declaration of AutoConnectOTAInflate class, which decompresses the
+ * gzip-compressed firmware uploaded by AutoConnectOTA.
+ * @file AutoConnectOTAInflate.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTOTAINFLATE_H_
+#define _AUTOCONNECTOTAINFLATE_H_
+
+#include "AutoConnectDefs.h"
+#ifdef AUTOCONNECT_USE_OTAINFLATE
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdint.h>
+#if __has_include(<miniz.h>)
+#include <miniz.h>
+#else
+#include <rom/miniz.h>
+#endif
+
+/**
+ * AutoConnectOTAInflate decompresses the gzip stream given in pieces
+ * of any size with the tinfl decompressor in the ROM, and passes the
+ * decompressed data to the writer. The decompressed data is output
+ * into the window of the deflate dictionary size, which also serves
+ * as the history of the back references. The gzip header is skipped
+ * and the trailer is not verified, as the image is verified by the
+ * Update class.
+ */
+class AutoConnectOTAInflate {
+ public:
+  typedef std::function<size_t(const uint8_t*, const size_t)> WriterFuncT;
+
+  AutoConnectOTAInflate() {}
+  AutoConnectOTAInflate(const AutoConnectOTAInflate&) = delete;
+  AutoConnectOTAInflate& operator=(const AutoConnectOTAInflate&) = delete;
+  ~AutoConnectOTAInflate() { end(); }
+
+  /**
+   * Allocate the decompressor and the window.
+   * @param  writer  A function that writes the decompressed data and
+   * returns the number of bytes written.
+   * @return false  The heap is insufficient.
+   */
+  bool  begin(WriterFuncT writer) {
+    end();
+    _inflator.reset(new (std::nothrow) tinfl_decompressor);
+    _window.reset(new (std::nothrow) uint8_t[TINFL_LZ_DICT_SIZE]);
+    if (!_inflator || !_window) {
+      AC_DBG("Inflate window %u bytes unavailable\n", (unsigned int)TINFL_LZ_DICT_SIZE);
+      end();
+      return false;
+    }
+    tinfl_init(_inflator.get());
+    _writer = writer;
+    _state = _GZ_FIXED;
+    _count = 0;
+    _outPos = 0;
+    return true;
+  }
+
+  /**
+   * Decompress the piece of the gzip stream.
+   * @param  buf   The piece of the gzip stream.
+   * @param  size  Size of the piece.
+   * @return The size of the piece accepted, 0 if the stream is broken
+   * or the writer has failed.
+   */
+  size_t  write(const uint8_t* buf, const size_t size) {
+    size_t  remain = size;
+
+    while (remain && _state < _GZ_DEFLATE) {
+      _header(*buf++);
+      remain--;
+    }
+
+    tinfl_status  status = TINFL_STATUS_NEEDS_MORE_INPUT;
+    while (_state == _GZ_DEFLATE && (remain || status == TINFL_STATUS_HAS_MORE_OUTPUT)) {
+      size_t  inSize = remain;
+      size_t  outSize = TINFL_LZ_DICT_SIZE - _outPos;
+      status = tinfl_decompress(_inflator.get(), buf, &inSize, _window.get(), _window.get() + _outPos, &outSize, TINFL_FLAG_HAS_MORE_INPUT);
+      buf += inSize;
+      remain -= inSize;
+      if (outSize) {
+        if (_writer(_window.get() + _outPos, outSize) != outSize) {
+          _state = _GZ_ERROR;
+          break;
+        }
+        _outPos = (_outPos + outSize) & (TINFL_LZ_DICT_SIZE - 1);
+      }
+      if (status == TINFL_STATUS_DONE)
+        _state = _GZ_DONE;
+      else if (status < 0) {
+        AC_DBG("Inflate failed %d\n", (int)status);
+        _state = _GZ_ERROR;
+      }
+    }
+    // The trailer after the deflate stream is ignored.
+    return _state == _GZ_ERROR ? 0 : size;
+  }
+
+  /**
+   * Release the decompressor and the window.
+   * @return true  The deflate stream has been completed.
+   */
+  bool  end(void) {
+    _inflator.reset();
+    _window.reset();
+    return _state == _GZ_DONE;
+  }
+
+ protected:
+  typedef enum {
+    _GZ_FIXED,    /**< ID1, ID2, CM, FLG, MTIME, XFL and OS */
+    _GZ_XLEN,     /**< Length of the extra field */
+    _GZ_EXTRA,    /**< Extra field */
+    _GZ_NAME,     /**< Zero-terminated file name */
+    _GZ_COMMENT,  /**< Zero-terminated comment */
+    _GZ_HCRC,     /**< CRC16 of the header */
+    _GZ_DEFLATE,  /**< Deflate stream */
+    _GZ_DONE,     /**< The deflate stream completed */
+    _GZ_ERROR     /**< Broken stream or the writer failed */
+  } _GZState_t;
+
+  /**
+   * Parse a byte of the gzip header.
+   * @param  c  A byte of the header.
+   */
+  void  _header(const uint8_t c) {
+    switch (_state) {
+    case _GZ_FIXED:
+      if ((_count == 0 && c != 0x1f) || (_count == 1 && c != 0x8b) || (_count == 2 && c != 0x08)) {
+        AC_DBG("Not a gzip stream\n");
+        _state = _GZ_ERROR;
+        return;
+      }
+      if (_count == 3)
+        _flags = c;
+      if (++_count == 10)
+        _nextField();
+      break;
+    case _GZ_XLEN:
+      _xlen |= static_cast<uint16_t>(c) << (_count * 8);
+      if (++_count == 2) {
+        _state = _GZ_EXTRA;
+        if (!(_count = _xlen))
+          _nextField();
+      }
+      break;
+    case _GZ_EXTRA:
+    case _GZ_HCRC:
+      if (!--_count)
+        _nextField();
+      break;
+    case _GZ_NAME:
+    case _GZ_COMMENT:
+      if (!c)
+        _nextField();
+      break;
+    default:
+      break;
+    }
+  }
+
+  /**
+   * Advance to the next field of the gzip header that the flags have.
+   */
+  void  _nextField(void) {
+    if (_state < _GZ_XLEN && (_flags & 0x04)) {
+      _state = _GZ_XLEN;
+      _count = 0;
+      _xlen = 0;
+    }
+    else if (_state < _GZ_NAME && (_flags & 0x08))
+      _state = _GZ_NAME;
+    else if (_state < _GZ_COMMENT && (_flags & 0x10))
+      _state = _GZ_COMMENT;
+    else if (_state < _GZ_HCRC && (_flags & 0x02)) {
+      _state = _GZ_HCRC;
+      _count = 2;
+    }
+    else
+      _state = _GZ_DEFLATE;
+  }
+
+  _GZState_t  _state = _GZ_ERROR;   /**< Parsing state of the gzip stream */
+  uint8_t   _flags = 0;             /**< FLG of the gzip header */
+  uint16_t  _xlen = 0;              /**< Length of the extra field */
+  size_t    _count = 0;             /**< Bytes parsed or remaining in the field */
+  size_t    _outPos = 0;            /**< Output position in the window */
+  WriterFuncT _writer;              /**< The writer of the decompressed data */
+  std::unique_ptr<tinfl_decompressor> _inflator;  /**< The decompressor */
+  std::unique_ptr<uint8_t[]>  _window;  /**< The window of the deflate dictionary size */
+};
+
+#endif // !AUTOCONNECT_USE_OTAINFLATE
+#endif // !_AUTOCONNECTOTAINFLATE_H_
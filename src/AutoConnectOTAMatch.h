@@ -0,0 +1,260 @@
+/**
+ * Declaration of AutoConnectOTAMatch class, which classifies the file
+ * uploaded by AutoConnectOTA as the firmware by its name.
+ * @file AutoConnectOTAMatch.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTOTAMATCH_H_
+#define _AUTOCONNECTOTAMATCH_H_
+
+#include <ctype.h>
+#include <memory>
+#include <string.h>
+#include <strings.h>
+#include "AutoConnectDefs.h"
+#ifdef AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP
+#if defined(ARDUINO_ARCH_ESP8266)
+#include <regex.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <regex>
+#include <esp_pthread.h>
+#include <thread>
+#endif
+#endif
+
+/**
+ * AutoConnectOTAMatch matches the file name against the pattern of the
+ * firmware without case sensitivity. The pattern is parsed once, and
+ * the name is matched by comparing its tail with the suffix in the
+ * pattern without the regex. The matcher refers to the pattern rather
+ * than copying it, so the pattern must outlive the matcher, such as a
+ * string literal. The regular expressions of the following forms are
+ * parsed into the suffix, where SUFFIX consists of the literal
+ * characters and the escaped punctuations, and may contain one group of
+ * the alternatives such as \.(bin|img).
+ *
+ *   ^.+SUFFIX$  The name that ends with SUFFIX after one or more chars
+ *   ^.*SUFFIX$  The name that ends with SUFFIX
+ *   ^SUFFIX$    The name equals SUFFIX
+ *
+ * The other regular expressions are compiled by the regex library once
+ * and evaluated with it. On ESP32, std::regex is evaluated in a thread
+ * of AUTOCONNECT_OTAMATCH_STACKSIZE created for each match. The form of
+ * the pattern can be identified at compile time with
+ * AutoConnectOTAMatch::isSuffix.
+ */
+class AutoConnectOTAMatch {
+ public:
+  /**
+   * Compile the pattern.
+   * @param  pattern  The pattern of the file name.
+   * @param  regexp   The pattern is a regular expression, otherwise it
+   * is the suffix as it is.
+   */
+  explicit AutoConnectOTAMatch(const char* pattern, const bool regexp = false) : _head(pattern), _headEnd(nullptr), _alters(nullptr), _trail(nullptr), _trailEnd(nullptr), _min(0), _exact(false), _plain(!regexp), _regex(false) {
+    if (regexp) {
+      if (isSuffix(pattern))
+        _compile(pattern);
+      else {
+        _head = nullptr;
+        _regex = _compileRegex(pattern);
+      }
+    }
+  }
+  AutoConnectOTAMatch(const AutoConnectOTAMatch&) = delete;
+  AutoConnectOTAMatch& operator=(const AutoConnectOTAMatch&) = delete;
+  ~AutoConnectOTAMatch() {
+#if defined(AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP) && defined(ARDUINO_ARCH_ESP8266)
+    if (_regex)
+      regfree(&_preg);
+#endif
+  }
+
+  /**
+   * Returns whether the name matches the pattern.
+   * @param  name  The file name.
+   */
+  bool  match(const char* name) const {
+    if (_regex)
+      return _matchRegex(name);
+    if (!_head)
+      return false;
+    const size_t  len = strlen(name);
+    if (_plain) {
+      const size_t  sLen = strlen(_head);
+      return len >= sLen && !strcasecmp(name + len - sLen, _head);
+    }
+    if (!_alters)
+      return _matchSuffix(name, len, nullptr, nullptr);
+    // Try each alternative of the group.
+    for (const char* alt = _alters + 1;;) {
+      const char* altEnd = _lits(alt);
+      if (_matchSuffix(name, len, alt, altEnd))
+        return true;
+      if (*altEnd != '|')
+        return false;
+      alt = altEnd + 1;
+    }
+  }
+
+  /**
+   * Returns whether the pattern has been compiled.
+   */
+  bool  valid(void) const { return _regex || _head; }
+
+  /**
+   * Returns whether the regular expression is parsed into the suffix
+   * without the regex, which can be evaluated at compile time.
+   * @param  p  The regular expression.
+   */
+  static constexpr bool isSuffix(const char* p) {
+    return p[0] == '^' && (p[1] == '.' && (p[2] == '+' || p[2] == '*') ? _body(p + 3) : _body(p + 1));
+  }
+
+ protected:
+  // The grammar of the suffix for isSuffix, written in the recursion
+  // that C++11 constexpr allows.
+  static constexpr bool _isAlnum(const char c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+  static constexpr bool _isMeta(const char c, const char* meta = "^$.[]()|*+?{}\\") { return *meta && (c == *meta || _isMeta(c, meta + 1)); }
+  static constexpr const char* _lit(const char* p) { return (*p && !_isMeta(*p)) ? p + 1 : (*p == '\\' && p[1] && !_isAlnum(p[1])) ? p + 2 : nullptr; }
+  static constexpr const char* _lits(const char* p) { return _lit(p) ? _lits(_lit(p)) : p; }
+  static constexpr const char* _altNext(const char* p, const char* q) { return q == p ? nullptr : *q == '|' ? _alts(q + 1) : *q == ')' ? q + 1 : nullptr; }
+  static constexpr const char* _alts(const char* p) { return _altNext(p, _lits(p)); }
+  static constexpr bool _tail(const char* p) { return p && p[0] == '$' && !p[1]; }
+  static constexpr bool _group(const char* p) { return p && _tail(_lits(p)); }
+  static constexpr bool _bodyNext(const char* q) { return *q == '(' ? _group(_alts(q + 1)) : _tail(q); }
+  static constexpr bool _body(const char* p) { return _bodyNext(_lits(p)); }
+
+  /**
+   * Parse the regular expression of the suffix form into the literals
+   * before, in and after the group, which are kept as the ranges of the
+   * pattern.
+   */
+  void  _compile(const char* p) {
+    p++;
+    if (p[0] == '.' && (p[1] == '+' || p[1] == '*')) {
+      _min = p[1] == '+' ? 1 : 0;
+      p += 2;
+    }
+    else
+      _exact = true;
+    _head = p;
+    _headEnd = _lits(p);
+    _trail = _headEnd;
+    if (*_trail == '(') {
+      // Skip the group in the same grammar as isSuffix, which takes an
+      // escaped parenthesis as a literal.
+      _alters = _trail;
+      _trail = _alts(_alters + 1);
+    }
+    _trailEnd = _lits(_trail);
+  }
+
+  /**
+   * Returns the number of the characters of the literal range, where
+   * the escape is counted as one character.
+   */
+  static size_t _length(const char* p, const char* end) {
+    size_t  len = 0;
+    for (; p < end; p = _lit(p))
+      len++;
+    return len;
+  }
+
+  /**
+   * Compare the name with the literal range without case sensitivity,
+   * and advance the name.
+   */
+  static bool _compare(const char*& name, const char* p, const char* end) {
+    for (const char* q; p < end; p = q) {
+      q = _lit(p);
+      const char  c = q - p == 2 ? p[1] : p[0];
+      if (tolower(static_cast<unsigned char>(*name++)) != tolower(static_cast<unsigned char>(c)))
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * Returns whether the name ends with the suffix made of the head, the
+   * alternative and the tail.
+   */
+  bool  _matchSuffix(const char* name, const size_t len, const char* alt, const char* altEnd) const {
+    const size_t  sLen = _length(_head, _headEnd) + _length(alt, altEnd) + _length(_trail, _trailEnd);
+    if (_exact ? len != sLen : len < sLen + _min)
+      return false;
+    name += len - sLen;
+    return _compare(name, _head, _headEnd) && _compare(name, alt, altEnd) && _compare(name, _trail, _trailEnd);
+  }
+
+#if defined(AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP) && defined(ARDUINO_ARCH_ESP8266)
+  bool  _compileRegex(const char* pattern) {
+    if (regcomp(&_preg, pattern, REG_ICASE | REG_EXTENDED | REG_NOSUB)) {
+      AC_DBG("%s regex compile failed\n", pattern);
+      return false;
+    }
+    return true;
+  }
+
+  bool  _matchRegex(const char* name) const {
+    regmatch_t  p_match[1];
+    return !regexec(&_preg, name, 1, p_match, 0);
+  }
+#elif defined(AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP) && defined(ARDUINO_ARCH_ESP32)
+  // std::regex requires much stack, which easily eats up the stack of
+  // the loop task. It is evaluated in the thread with enough stack.
+  template<typename T>
+  static void _run(T func) {
+    esp_pthread_cfg_t t_cfg = esp_pthread_get_default_config();
+    t_cfg.stack_size = AUTOCONNECT_OTAMATCH_STACKSIZE;
+    esp_pthread_set_cfg(&t_cfg);
+    std::thread t_regex(func);
+    t_regex.join();
+  }
+
+  bool  _compileRegex(const char* pattern) {
+    _run([&]() {
+      _re.reset(new std::regex(std::string(pattern), std::regex_constants::icase | std::regex_constants::extended | std::regex_constants::nosubs));
+    });
+    return true;
+  }
+
+  bool  _matchRegex(const char* name) const {
+    bool  matched;
+    _run([&]() { matched = std::regex_match(name, *_re); });
+    return matched;
+  }
+#else
+  bool  _compileRegex(const char* pattern) {
+    AC_DBG("%s is not a suffix\n", pattern);
+    AC_UNUSED(pattern);
+    return false;
+  }
+
+  bool  _matchRegex(const char* name) const {
+    AC_UNUSED(name);
+    return false;
+  }
+#endif
+
+  const char* _head;              /**< The literal before the group, or the plain suffix */
+  const char* _headEnd;           /**< End of the literal before the group */
+  const char* _alters;            /**< The group of the alternatives, nullptr if none */
+  const char* _trail;             /**< The literal after the group */
+  const char* _trailEnd;          /**< End of the literal after the group */
+  uint8_t _min;                   /**< Minimum length of the name before the suffix */
+  bool    _exact;                 /**< The name equals the suffix */
+  bool    _plain;                 /**< The pattern is the suffix as it is */
+  bool    _regex;                 /**< The pattern is evaluated by the regex */
+#if defined(AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP) && defined(ARDUINO_ARCH_ESP8266)
+  regex_t _preg;                  /**< The compiled regex */
+#elif defined(AUTOCONNECT_UPLOAD_ASFIRMWARE_USE_REGEXP) && defined(ARDUINO_ARCH_ESP32)
+  std::unique_ptr<std::regex> _re;  /**< The compiled regex */
+#endif
+};
+
+#endif // !_AUTOCONNECTOTAMATCH_H_
@@ -1360,7 +1360,6 @@ String AutoConnectCore<T>::_token_OPEN_SSID(PageArgument& args) {
   static const char _ssidLock[] PROGMEM = "<span class=\"img-lock\"></span>";
   static const char _ssidNull[] PROGMEM = "";
   String ssidList;
-  station_config_t  entry;
   char  rssiCont[32];
   char  trash[80] = {'\0'};
   char  slCont[sizeof(_ssidList) + sizeof(AUTOCONNECT_PARAMID_CRED) + sizeof(station_config_t::ssid) + sizeof(rssiCont) + sizeof(trash) + sizeof(_ssidLock)];
@@ -1374,18 +1373,16 @@ String AutoConnectCore<T>::_token_OPEN_SSID(PageArgument& args) {
     _indelibleSSID.clear();
   }
 
-  uint8_t creEntries = credit.entries();
+  uint16_t  creEntries = credit.entries();
   if (creEntries > 0)
     _scanCount = WiFi.scanNetworks(false, true);
   else
     ssidList += String(F("<p><b>" AUTOCONNECT_TEXT_NOSAVEDCREDENTIALS "</b></p>"));
 
-  for (uint8_t i = 0; i < creEntries; i++) {
+  for (const station_config_t& entry : credit) {
     rssiCont[0] = '\0';
     PGM_P rssiSym = _ssidNA;
     PGM_P ssidLock = _ssidNull;
-    credit.load(i, &entry);
-    AC_DBG("Credential #%d loaded\n", (int)i);
     for (int8_t sc = 0; sc < (int8_t)_scanCount; sc++) {
       if (_isValidAP(entry, sc)) {
         // The access point collation key is determined at compile time
@@ -1400,9 +1397,9 @@ String AutoConnectCore<T>::_token_OPEN_SSID(PageArgument& args) {
       }
     }
     if (_apConfig.menuItems & AC_MENUITEM_DELETESSID)
-      snprintf_P(trash, sizeof(trash), (PGM_P)_ssidTrsh, reinterpret_cast<char*>(entry.ssid));
+      snprintf_P(trash, sizeof(trash), (PGM_P)_ssidTrsh, reinterpret_cast<const char*>(entry.ssid));
 
-    snprintf_P(slCont, sizeof(slCont), (PGM_P)_ssidList, AUTOCONNECT_PARAMID_CRED, reinterpret_cast<char*>(entry.ssid), rssiSym, trash, ssidLock);
+    snprintf_P(slCont, sizeof(slCont), (PGM_P)_ssidList, AUTOCONNECT_PARAMID_CRED, reinterpret_cast<const char*>(entry.ssid), rssiSym, trash, ssidLock);
     ssidList += String(slCont);
   }
   return ssidList;
@@ -0,0 +1,321 @@
+/**
+ * Declaration of AutoConnectPatch class, which applies the binary patch
+ * of the firmware to the running image in a streaming fashion.
+ * @file AutoConnectPatch.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTPATCH_H_
+#define _AUTOCONNECTPATCH_H_
+
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+#include <string.h>
+#include <WString.h>
+#include "AutoConnectDefs.h"
+
+/**
+ * AutoConnectPatch reconstructs the new firmware from the running
+ * firmware and the patch given in pieces of any size. The patch is
+ * generated by the acpatch.py script bundled with the updateserver,
+ * and consists of the following header and the records in the manner
+ * of bsdiff.
+ *
+ *   magic "ACPATCH1", the old and the new image sizes (uint32 LE),
+ *   MD5 of the old image and MD5 of the new image (16 bytes each)
+ *
+ * Each record holds the control values as varint, the length of the
+ * diff, the length of the extra and the seek of the old position as
+ * zigzag varint. The diff follows as the pairs of the run length of
+ * zeros and the length of the literal deltas, each of which is a
+ * varint, followed by the deltas. A zero delta leaves the old byte as
+ * it is and the literal delta is added to the old byte. The extra is
+ * the literal bytes of the new image. The old image is read through
+ * the reader block by block and the reconstructed image is passed to
+ * the writer, so the memory used does not depend on the image size.
+ */
+class AutoConnectPatch {
+ public:
+  typedef std::function<bool(const uint32_t, uint8_t*, const size_t)> ReaderFuncT;
+  typedef std::function<size_t(const uint8_t*, const size_t)> WriterFuncT;
+  typedef std::function<bool(AutoConnectPatch&)> HeaderFuncT;
+
+  AutoConnectPatch() {}
+  AutoConnectPatch(const AutoConnectPatch&) = delete;
+  AutoConnectPatch& operator=(const AutoConnectPatch&) = delete;
+  ~AutoConnectPatch() {}
+
+  /**
+   * Start applying a patch.
+   * @param  reader  A function that reads the old image at the offset.
+   * @param  writer  A function that writes the new image and returns
+   * the number of bytes written.
+   * @param  header  A function called when the header is received. It
+   * prepares the destination with the sizes and the digests, and
+   * returns false to reject the patch.
+   */
+  void  begin(ReaderFuncT reader, WriterFuncT writer, HeaderFuncT header = nullptr) {
+    _reader = reader;
+    _writer = writer;
+    _header = header;
+    _state = _PATCH_HEADER;
+    _count = 0;
+    _acc = 0;
+    _shift = 0;
+    _remain[0] = _remain[1] = 0;
+    _pending = 0;
+    _seek = 0;
+    _oldPos = 0;
+    _newPos = 0;
+    _err = nullptr;
+  }
+
+  /**
+   * Apply the piece of the patch.
+   * @param  buf   The piece of the patch.
+   * @param  size  Size of the piece.
+   * @return The size of the piece accepted, 0 if the patch is broken or
+   * the reader or the writer has failed.
+   */
+  size_t  write(const uint8_t* buf, const size_t size) {
+    const uint8_t*  p = buf;
+    const uint8_t*  end = buf + size;
+
+    while (_state < _PATCH_DONE) {
+      if (p == end && !(_state == _PATCH_ZEROS && _pending))
+        break;
+      switch (_state) {
+      case _PATCH_HEADER:
+        _hdr[_count++] = *p++;
+        if (_count == sizeof(_hdr)) {
+          if (memcmp(_hdr, "ACPATCH1", 8)) {
+            _fail("Not a patch");
+            break;
+          }
+          if (_header && !_header(*this)) {
+            _fail("Patch rejected");
+            break;
+          }
+          _state = newSize() ? _PATCH_DIFF : _PATCH_DONE;
+        }
+        break;
+      case _PATCH_DIFF:
+      case _PATCH_EXTRA:
+        if (_get(p, end)) {
+          _remain[_state == _PATCH_EXTRA] = _varint;
+          _state = static_cast<_PatchState_t>(_state + 1);
+        }
+        break;
+      case _PATCH_SEEK:
+        if (_get(p, end)) {
+          _seek = static_cast<int32_t>(_varint >> 1) ^ -static_cast<int32_t>(_varint & 1);
+          if (_remain[0] > newSize() - _newPos || _remain[1] > newSize() - _newPos - _remain[0])
+            _fail("Record overflow");
+          else
+            _diffEnd();
+        }
+        break;
+      case _PATCH_ZEROS:
+        if (!_pending) {
+          if (!_get(p, end))
+            break;
+          if (_varint > _remain[0]) {
+            _fail("Diff overflow");
+            break;
+          }
+          _remain[0] -= _varint;
+          _pending = _varint;
+        }
+        // The zero run copies the old image as it is without input.
+        _pending -= _apply(nullptr, _pending);
+        if (!_pending && _state == _PATCH_ZEROS)
+          _state = _PATCH_LITERALS;
+        break;
+      case _PATCH_LITERALS:
+        if (_get(p, end)) {
+          if (_varint > _remain[0]) {
+            _fail("Diff overflow");
+            break;
+          }
+          _remain[0] -= _varint;
+          _pending = _varint;
+          _state = _PATCH_DELTAS;
+          if (!_pending)
+            _deltaEnd();
+        }
+        break;
+      case _PATCH_DELTAS: {
+        size_t  n = _apply(p, std::min(static_cast<size_t>(end - p), static_cast<size_t>(_pending)));
+        p += n;
+        _pending -= n;
+        if (!_pending && _state == _PATCH_DELTAS)
+          _deltaEnd();
+        break;
+      }
+      case _PATCH_EXTRAS: {
+        size_t  n = std::min(static_cast<size_t>(end - p), static_cast<size_t>(_remain[1]));
+        if (!_emit(p, n))
+          break;
+        p += n;
+        _remain[1] -= n;
+        if (!_remain[1])
+          _recordEnd();
+        break;
+      }
+      default:
+        break;
+      }
+    }
+    return _state == _PATCH_ERROR ? 0 : size;
+  }
+
+  /**
+   * Returns whether the new image has been completely reconstructed.
+   */
+  bool  end(void) const { return _state == _PATCH_DONE; }
+
+  uint32_t  oldSize(void) const { return _le32(_hdr + 8); }   /**< Size of the old image */
+  uint32_t  newSize(void) const { return _le32(_hdr + 12); }  /**< Size of the new image */
+  String  oldMD5(void) const { return _hex(_hdr + 16); }      /**< MD5 of the old image */
+  String  newMD5(void) const { return _hex(_hdr + 32); }      /**< MD5 of the new image */
+  const char* error(void) const { return _err; }              /**< Cause of the failure */
+
+ protected:
+  typedef enum {
+    _PATCH_HEADER,    /**< Header */
+    _PATCH_DIFF,      /**< Length of the diff */
+    _PATCH_EXTRA,     /**< Length of the extra */
+    _PATCH_SEEK,      /**< Seek of the old position */
+    _PATCH_ZEROS,     /**< Run length of the zero deltas */
+    _PATCH_LITERALS,  /**< Length of the literal deltas */
+    _PATCH_DELTAS,    /**< Literal deltas */
+    _PATCH_EXTRAS,    /**< Extra bytes */
+    _PATCH_DONE,      /**< The new image completed */
+    _PATCH_ERROR      /**< Broken patch or the I/O failed */
+  } _PatchState_t;
+
+  /**
+   * Read a varint from the patch.
+   * @return true  The varint completed in _varint.
+   */
+  bool  _get(const uint8_t*& p, const uint8_t* end) {
+    while (p < end) {
+      const uint8_t c = *p++;
+      if (_shift > 28) {
+        _fail("Broken varint");
+        return false;
+      }
+      _acc |= static_cast<uint32_t>(c & 0x7f) << _shift;
+      _shift += 7;
+      if (!(c & 0x80)) {
+        _varint = _acc;
+        _acc = 0;
+        _shift = 0;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Reconstruct the new image by adding the deltas to the old image.
+   * @param  delta  The deltas, nullptr copies the old image as it is.
+   * @param  size   Number of the bytes to be reconstructed.
+   * @return Number of the bytes reconstructed.
+   */
+  size_t  _apply(const uint8_t* delta, const size_t size) {
+    size_t  done = 0;
+    while (done < size && _state != _PATCH_ERROR) {
+      const size_t  n = std::min(size - done, sizeof(_block));
+      // The old image out of the range is regarded as zeros.
+      memset(_block, 0, n);
+      if (_oldPos < static_cast<int64_t>(oldSize()) && _oldPos + static_cast<int64_t>(n) > 0) {
+        const int64_t head = std::max(_oldPos, static_cast<int64_t>(0));
+        const int64_t tail = std::min(_oldPos + static_cast<int64_t>(n), static_cast<int64_t>(oldSize()));
+        if (!_reader(static_cast<uint32_t>(head), _block + (head - _oldPos), static_cast<size_t>(tail - head))) {
+          _fail("Old image unreadable");
+          break;
+        }
+      }
+      if (delta)
+        for (size_t i = 0; i < n; i++)
+          _block[i] += delta[done + i];
+      if (!_emit(_block, n))
+        break;
+      _oldPos += n;
+      done += n;
+    }
+    return done;
+  }
+
+  bool  _emit(const uint8_t* buf, const size_t size) {
+    if (size && _writer(buf, size) != size) {
+      _fail("Write failed");
+      return false;
+    }
+    _newPos += size;
+    return true;
+  }
+
+  void  _deltaEnd(void) {
+    if (_remain[0])
+      _state = _PATCH_ZEROS;
+    else
+      _diffEnd();
+  }
+
+  void  _diffEnd(void) {
+    if (_remain[0])
+      _state = _PATCH_ZEROS;
+    else if (_remain[1])
+      _state = _PATCH_EXTRAS;
+    else
+      _recordEnd();
+  }
+
+  void  _recordEnd(void) {
+    _oldPos += _seek;
+    _seek = 0;
+    _state = _newPos < newSize() ? _PATCH_DIFF : _PATCH_DONE;
+  }
+
+  void  _fail(const char* err) {
+    AC_DBG("Patch %s at %u\n", err, (unsigned int)_newPos);
+    _err = err;
+    _state = _PATCH_ERROR;
+  }
+
+  static uint32_t _le32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+  static String _hex(const uint8_t* md5) {
+    String  hex;
+    hex.reserve(32);
+    for (uint8_t i = 0; i < 16; i++) {
+      hex += "0123456789abcdef"[md5[i] >> 4];
+      hex += "0123456789abcdef"[md5[i] & 0x0f];
+    }
+    return hex;
+  }
+
+  _PatchState_t _state = _PATCH_ERROR;  /**< Parsing state of the patch */
+  uint8_t   _hdr[48] = { 0 };         /**< The header */
+  size_t    _count = 0;               /**< Bytes of the header received */
+  uint32_t  _acc = 0;                 /**< The varint being read */
+  uint8_t   _shift = 0;               /**< Bits of the varint being read */
+  uint32_t  _varint = 0;              /**< The varint read */
+  uint32_t  _remain[2] = { 0, 0 };    /**< Remaining bytes of the diff and the extra */
+  uint32_t  _pending = 0;             /**< Remaining bytes of the zero run or the literal deltas */
+  int32_t   _seek = 0;                /**< Seek of the old position at the end of the record */
+  int64_t   _oldPos = 0;              /**< Position in the old image */
+  uint32_t  _newPos = 0;              /**< Position in the new image */
+  const char* _err = nullptr;         /**< Cause of the failure */
+  ReaderFuncT _reader;                /**< The reader of the old image */
+  WriterFuncT _writer;                /**< The writer of the new image */
+  HeaderFuncT _header;                /**< Notifies the header */
+  uint8_t   _block[AUTOCONNECT_UPDATE_PATCH_BLOCKSIZE]; /**< The block of the old image */
+};
+
+#endif // !_AUTOCONNECTPATCH_H_
@@ -0,0 +1,126 @@
+/**
+ * Declaration of AutoConnectSchedule class, which times the unattended
+ * polling of the update server staggered across the fleet.
+ * @file AutoConnectSchedule.h
+ * @author hieromon@gmail.com
+ * @version  1.4.2
+ * @date 2026-10-19
+ * @copyright  MIT license.
+ */
+
+#ifndef _AUTOCONNECTSCHEDULE_H_
+#define _AUTOCONNECTSCHEDULE_H_
+
+#include <stdint.h>
+#include "AutoConnectDefs.h"
+
+/**
+ * AutoConnectSchedule decides when the device polls the update server
+ * and whether the device takes part in a rollout, from the device
+ * identifier such as the chip ID. The first poll falls at a point
+ * within the interval that differs by device, so that the devices
+ * powered on at once do not poll in sync, and each subsequent interval
+ * is extended by a random jitter. The interval doubles while the
+ * server asks to back off, and the server can also extend it with
+ * Retry-After. The rollout bucket of the device is fixed in 0 to 99 by
+ * the identifier, and the device takes a rollout of the percentage
+ * greater than its bucket. It takes the current time on each call
+ * rather than reading the clock, so the schedule can be simulated.
+ */
+class AutoConnectSchedule {
+ public:
+  AutoConnectSchedule() {}
+  ~AutoConnectSchedule() {}
+
+  /**
+   * Start the polling.
+   * @param  id        The device identifier.
+   * @param  interval  Polling interval [ms], 0 stops the polling.
+   * @param  jitter    Maximum random delay added to the interval [ms].
+   * @param  now       Current time [ms].
+   */
+  void  begin(const uint32_t id, const unsigned long interval, const unsigned long jitter, const unsigned long now) {
+    _interval = interval;
+    _jitter = jitter;
+    _backoff = 0;
+    _bucket = _mix(id) % 100;
+    _seed = _mix(id ^ 0x9e3779b9) | 1;
+    _since = now;
+    _wait = _interval ? _random() % _interval : 0;
+  }
+
+  /**
+   * Returns whether the poll is due.
+   * @param  now  Current time [ms].
+   */
+  bool  due(const unsigned long now) const { return _interval && now - _since >= _wait; }
+
+  /**
+   * Schedule the next poll after the current one has ended.
+   * @param  now         Current time [ms].
+   * @param  busy        The server responded 429 or 503.
+   * @param  retryAfter  Retry-After of the response [ms], 0 if absent.
+   */
+  void  next(const unsigned long now, const bool busy = false, const unsigned long retryAfter = 0) {
+    if (!busy)
+      _backoff = 0;
+    else if (_backoff < 31)
+      _backoff++;
+    // The interval doubles per backoff without overflowing.
+    const unsigned long limit = _interval > AUTOCONNECT_UPDATE_SCHEDULE_BACKOFF ? _interval : AUTOCONNECT_UPDATE_SCHEDULE_BACKOFF;
+    unsigned long wait = _interval;
+    for (uint8_t n = 0; n < _backoff && wait < limit; n++)
+      wait = wait > limit / 2 ? limit : wait * 2;
+    if (retryAfter > wait)
+      wait = retryAfter;
+    if (_jitter)
+      wait += _random() % _jitter;
+    _since = now;
+    _wait = wait;
+  }
+
+  /**
+   * Returns whether the device takes part in the rollout.
+   * @param  rollout  Percentage of the devices to take part.
+   */
+  bool  eligible(const int rollout) const { return _bucket < rollout; }
+
+  uint8_t bucket(void) const { return _bucket; }              /**< Rollout bucket of the device */
+  unsigned long interval(void) const { return _interval; }    /**< Polling interval */
+  unsigned long remaining(const unsigned long now) const { return due(now) ? 0 : _wait - (now - _since); } /**< Time until the poll */
+  uint8_t backoff(void) const { return _backoff; }            /**< Number of the backoffs in a row */
+
+ protected:
+  /**
+   * The finalizer of MurmurHash3 to spread the identifier over the bits.
+   */
+  static uint32_t _mix(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+  }
+
+  /**
+   * Xorshift32 seeded by the identifier, which gives the jitter its own
+   * sequence for each device.
+   */
+  uint32_t  _random(void) {
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 17;
+    _seed ^= _seed << 5;
+    return _seed;
+  }
+
+  unsigned long _interval = 0;  /**< Polling interval */
+  unsigned long _jitter = 0;    /**< Maximum random delay */
+  unsigned long _since = 0;     /**< Time from which the wait is counted */
+  unsigned long _wait = 0;      /**< Wait until the next poll */
+  uint32_t  _seed = 1;          /**< State of the random sequence */
+  uint8_t   _bucket = 0;        /**< Rollout bucket of the device */
+  uint8_t   _backoff = 0;       /**< Number of the backoffs in a row */
+};
+
+#endif // !_AUTOCONNECTSCHEDULE_H_
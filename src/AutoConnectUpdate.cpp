@@ -11,8 +11,12 @@
 
 #ifdef AUTOCONNECT_USE_UPDATE
 
+#include <algorithm>
 #include <functional>
+#include <new>
 #include <type_traits>
+#include <utility>
+#include <StreamString.h>
 #include "AutoConnectUpdate.h"
 #include "AutoConnectUpdatePage.h"
 #include "AutoConnectJsonDefs.h"
@@ -109,6 +113,10 @@ typename std::enable_if<!AutoConnectUtil::has_func_onProgress<T>::value, AutoCon
  * as AutoConnectAux.
  */
 AutoConnectUpdateAct::~AutoConnectUpdateAct() {
+#ifdef AUTOCONNECT_USE_UPDATETASK
+  if (_thread.joinable())
+    _thread.join();
+#endif
   _auxCatalog.reset(nullptr);
   _auxProgress.reset(nullptr);
   _auxResult.reset(nullptr);
@@ -197,7 +205,9 @@ void AutoConnectUpdateAct::disable(const bool activate) {
  */
 void AutoConnectUpdateAct::enable(void) {
   _enable = true;
-  _status = UPDATE_IDLE;
+  // The update in the background continues over the reconnection.
+  if (_status != UPDATE_PROGRESS)
+    _status = UPDATE_IDLE;
   if (_auxCatalog) {
     _auxCatalog->menu(WiFi.status() == WL_CONNECTED);
     AC_DBG("AutoConnectUpdate enabled\n");
@@ -210,8 +220,18 @@ void AutoConnectUpdateAct::enable(void) {
  * the AutoConnectUpdate class will invoke this entry.
  * This entry point will be called from the process loop of handleClient
  * function only if the class is associated with the AutoConnect class.
+ * The update requested from the progress page runs in the background,
+ * in the dedicated task on ESP32 or by advancing the download a chunk
+ * per call on ESP8266, so that the sketch loop keeps running. It also
+ * polls the catalog when the scheduled update is due.
  */
 void AutoConnectUpdateAct::handleUpdate(void) {
+#ifdef AUTOCONNECT_USE_UPDATETASK
+  // Reap the update task that has finished.
+  if (_thread.joinable() && !_running)
+    _thread.join();
+#endif
+
   // Activate the update menu conditional with WiFi connected.
   if (!isEnabled() && _enable) {
     if (WiFi.status() == WL_CONNECTED)
@@ -220,13 +240,55 @@ void AutoConnectUpdateAct::handleUpdate(void) {
 
   if (isEnabled()) {
     if (WiFi.status() == WL_CONNECTED) {
+      // The scheduled update polls the catalog when it is due, while no
+      // update is running.
+      if (_status != UPDATE_START && _status != UPDATE_PROGRESS && _status != UPDATE_RESET) {
+        if (_scheduled) {
+          // The scheduled update has ended, restart with the new firmware
+          // or evaluate the catalog again on the next poll.
+          _scheduled = false;
+          if (_status == UPDATE_SUCCESS)
+            _status = UPDATE_RESET;
+          else {
+            _scheduleETag = String();
+            _scheduler.next(millis(), _responseCode == HTTP_CODE_TOO_MANY_REQUESTS || _responseCode == HTTP_CODE_SERVICE_UNAVAILABLE, _retryAfter);
+          }
+        }
+        // The firmware updated from the page waits for the restart.
+        else if (_status != UPDATE_SUCCESS && _scheduler.due(millis()))
+          _poll();
+      }
+
       // Evaluate the processing status of AutoConnectUpdateAct and
       // execute it accordingly. It is only this process point that
       // requests update processing.
       if (_status == UPDATE_START) {
         _status = UPDATE_PROGRESS;
-        update();
+        _async = true;
+#ifdef AUTOCONNECT_USE_UPDATETASK
+        if (_thread.joinable())
+          _thread.join();
+        // The task runs at the same priority as the loop task so that
+        // neither of them starves the other while waiting for the flash.
+        esp_pthread_cfg_t t_cfg = esp_pthread_get_default_config();
+        t_cfg.stack_size = AUTOCONNECT_UPDATETASK_STACKSIZE;
+        t_cfg.prio = uxTaskPriorityGet(NULL);
+        esp_pthread_set_cfg(&t_cfg);
+        _running = true;
+        _thread = std::thread([this]() {
+          if (_start())
+            while (_step())
+              delay(1);
+          _running = false;
+        });
+#else
+        _start();
+#endif
       }
+#ifndef AUTOCONNECT_USE_UPDATETASK
+      else if (_status == UPDATE_PROGRESS && _async)
+        _step();
+#endif
       else if (_status == UPDATE_RESET) {
         AC_DBG("Restart on %s updated...\n", _binName.c_str());
         ESP.restart();
@@ -240,52 +302,424 @@ void AutoConnectUpdateAct::handleUpdate(void) {
 }
 
 /**
- * Run the update function of HTTPUpdate that is the base class and
- * fetch the result.
+ * Poll the catalog of the update server periodically and update the
+ * firmware unattended. The polling of each device is staggered by its
+ * chip ID and the jitter so that the fleet does not overload the
+ * update server, and the update restarts the module.
+ * @param  interval  Polling interval [ms], 0 stops the polling.
+ * @param  jitter    Maximum random delay added to each interval [ms].
+ * @param  target    Name of the binary sketch file in the catalog to be
+ * rolled out.
+ */
+void AutoConnectUpdateAct::schedule(const unsigned long interval, const unsigned long jitter, const String& target) {
+#if defined(ARDUINO_ARCH_ESP8266)
+  const uint32_t  chipId = ESP.getChipId();
+#elif defined(ARDUINO_ARCH_ESP32)
+  // The efuse MAC holds the first octet in the lowest byte. The lower
+  // three octets are the vendor OUI common to the fleet, and the upper
+  // three octets distinguish the device.
+  const uint32_t  chipId = static_cast<uint32_t>(ESP.getEfuseMac() >> 24);
+#endif
+  _scheduler.begin(chipId, interval, jitter, millis());
+  _scheduleTarget = target;
+  _scheduleETag = String();
+  AC_DBG("Update scheduled every %lu ms, bucket %u\n", interval, _scheduler.bucket());
+}
+
+/**
+ * Returns the MD5 of the running firmware. The running firmware does not
+ * change until the restart, and ESP.getSketchMD5 reads through the whole
+ * image, so the MD5 is calculated once.
+ * @return MD5 of the running firmware.
+ */
+const String& AutoConnectUpdateAct::_runningMD5(void) {
+  if (!_sketchMD5.length())
+    _sketchMD5 = ESP.getSketchMD5();
+  return _sketchMD5;
+}
+
+/**
+ * Download the binary from the update server to update the firmware
+ * and fetch the result. It blocks until the update ends. It does not
+ * serve the web server in the meantime, since it may be called from
+ * a request handler of the web server.
  * @return  AC_UPDATESTATUS_t
  */
 AC_UPDATESTATUS_t AutoConnectUpdateAct::update(void) {
-  // Start update
+#ifdef AUTOCONNECT_USE_UPDATETASK
+  // The update task owns the download until it ends.
+  if (_running)
+    return _status;
+#endif
+  _async = false;
+  if (_start()) {
+    while (_step())
+      yield();
+  }
+  if (_status == UPDATE_RESET) {
+    AC_DBG("Restart on %s updated...\n", _binName.c_str());
+    ESP.restart();
+  }
+  return _status;
+}
+
+// Identifies as the HTTP updater of the core, so that the update server
+// accepts the request for the patch as well as the full binary.
+#if defined(ARDUINO_ARCH_ESP8266)
+#define AC_UPDATE_ARCH  "ESP8266"
+#define AC_UPDATE_CHIPSIZE  ESP.getFlashChipRealSize()
+#elif defined(ARDUINO_ARCH_ESP32)
+#define AC_UPDATE_ARCH  "ESP32"
+#define AC_UPDATE_CHIPSIZE  ESP.getFlashChipSize()
+#endif
+
+/**
+ * Start the update of the selected binary. If the download of the same
+ * binary was interrupted, it resumes from the checkpoint with the HTTP
+ * Range request.
+ * @return true  The download has started.
+ */
+bool AutoConnectUpdateAct::_start(void) {
+  if (!_binName.length()) {
+    AC_DBG("An update has not specified");
+    _status = UPDATE_NOAVAIL;
+    return false;
+  }
+
   String  uriBin = '/' + _binName;
   if (uri != ".")
     uriBin = uri + '/' + _binName;
-  if (_binName.length()) {
-    WiFiClient  wifiClient;
-    AC_DBG("%s:%d/%s update in progress...", host.c_str(), port, uriBin.c_str());
-    t_httpUpdate_return ret;
+  AC_DBG("%s:%d%s update in progress...", host.c_str(), port, uriBin.c_str());
+  // The download refers to the MD5 cached here, also in the background.
+  _runningMD5();
+  _errString = String();
+  _responseCode = 0;
+  _retryAfter = 0;
+  _status = UPDATE_PROGRESS;
 #ifdef ARDUINO_ARCH_ESP32
-    // Check if an available OTA partition exists.
-    const esp_partition_t*  runningPartition = esp_ota_get_running_partition();
-    const esp_partition_t*  otaPartition = esp_ota_get_next_update_partition(NULL);
-    if (!strcmp(runningPartition->label, otaPartition->label)) {
-      _errString = String(F("No available OTA partition"));
-      ret = HTTP_UPDATE_FAILED;
-    }
-    else
+  // Check if an available OTA partition exists.
+  const esp_partition_t*  runningPartition = esp_ota_get_running_partition();
+  const esp_partition_t*  otaPartition = esp_ota_get_next_update_partition(NULL);
+  if (!strcmp(runningPartition->label, otaPartition->label)) {
+    _errString = String(F("No available OTA partition"));
+    return _fail(false);
+  }
 #endif
-    if ((ret = HTTPUpdateClass::update(wifiClient, host, port, uriBin)) != HTTP_UPDATE_OK)
-      _errString = getLastErrorString();
-    switch (ret) {
-    case HTTP_UPDATE_FAILED:
-      _status = UPDATE_FAIL;
-      AC_DBG_DUMB(" %s\n", _errString.c_str());
-      AC_DBG("update returns HTTP_UPDATE_FAILED\n");
-      break;
-    case HTTP_UPDATE_NO_UPDATES:
-      _status = UPDATE_IDLE;
-      AC_DBG_DUMB(" No available update\n");
-      break;
-    case HTTP_UPDATE_OK:
-      _status = UPDATE_SUCCESS;
-      AC_DBG_DUMB(" completed\n");
-      break;
+
+  // The checkpoint of another binary is no longer resumable.
+  if (_resumeUri != uriBin)
+    _discard();
+  _resumeUri = uriBin;
+  _chunk.reset(new (std::nothrow) uint8_t[AUTOCONNECT_UPDATE_CHUNKSIZE]);
+  if (!_chunk) {
+    _errString = String(F("No memory"));
+    return _fail(false);
+  }
+  _retry = 0;
+  _phase = UPDATEPHASE_REQUEST;
+#ifdef AC_HAS_UPDATECALLBACK
+  if (_cbStart)
+    _cbStart();
+#endif
+  return true;
+}
+
+/**
+ * Advance the download by a chunk. It requests the binary, transfers
+ * the response chunk by chunk to the Update class, and waits for the
+ * retry after the link drop, without blocking except for the request.
+ * @return true  The download is still in progress.
+ */
+bool AutoConnectUpdateAct::_step(void) {
+  switch (_phase) {
+  case UPDATEPHASE_RETRY:
+    if (millis() - _tm < AUTOCONNECT_UPDATE_RESUME_INTERVAL)
+      return true;
+    // fall through
+  case UPDATEPHASE_REQUEST: {
+    bool  transient = false;
+    if (!_request(transient))
+      return _fail(transient);
+    _phase = UPDATEPHASE_TRANSFER;
+    _tm = millis();
+    return true;
+  }
+  case UPDATEPHASE_TRANSFER:
+    break;
+  }
+
+  WiFiClient* stream = _httpClient->getStreamPtr();
+  const int   available = stream ? stream->available() : 0;
+  if (available > 0) {
+    const size_t  size = std::min(std::min(static_cast<size_t>(available), _resumeSize - _resumeOffset), static_cast<size_t>(AUTOCONNECT_UPDATE_CHUNKSIZE));
+    const int     len = stream->read(_chunk.get(), size);
+    if (len > 0) {
+      size_t  written;
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+      if (_patch)
+        written = _patch->write(_chunk.get(), len);
+      else
+#endif
+      written = Update.write(_chunk.get(), len);
+      if (written != static_cast<size_t>(len)) {
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+        if (_patch && _patch->error() && !_errString.length())
+          _errString = String(_patch->error());
+#endif
+        if (!_errString.length()) {
+          StreamString  eStr;
+          Update.printError(eStr);
+          _errString = eStr;
+        }
+        return _fail(false);
+      }
+      _resumeOffset += len;
+      _tm = millis();
     }
+    if (_resumeOffset == _resumeSize)
+      return _finish();
+  }
+  else if (!stream || millis() - _tm > static_cast<unsigned long>(_timeout)) {
+    // The link dropped, which can be resumed.
+    _errString = String(F("Download interrupted at ")) + String(_resumeOffset);
+    return _fail(true);
+  }
+  return true;
+}
+
+/**
+ * Request the binary from the checkpoint and start writing the response.
+ * @param  transient  Returns true if the failure is to be retried.
+ * @return true  The response is ready to be transferred.
+ */
+bool AutoConnectUpdateAct::_request(bool& transient) {
+  const char* headerKeys[] = { "x-MD5", "Content-Range", "Retry-After" };
+
+  if (!_connect(_resumeUri)) {
+    _errString = String(F("http failed connect to ")) + host + String(':') + String(port);
+    transient = true;
+    return false;
+  }
+  _httpClient->collectHeaders(headerKeys, sizeof(headerKeys) / sizeof(headerKeys[0]));
+  _httpClient->setUserAgent(F(AC_UPDATE_ARCH "-http-Update"));
+  _httpClient->addHeader(F("x-" AC_UPDATE_ARCH "-STA-MAC"), WiFi.macAddress());
+  _httpClient->addHeader(F("x-" AC_UPDATE_ARCH "-AP-MAC"), WiFi.softAPmacAddress());
+  _httpClient->addHeader(F("x-" AC_UPDATE_ARCH "-FREE-SPACE"), String(ESP.getFreeSketchSpace()));
+  _httpClient->addHeader(F("x-" AC_UPDATE_ARCH "-SKETCH-SIZE"), String(ESP.getSketchSize()));
+  _httpClient->addHeader(F("x-" AC_UPDATE_ARCH "-SKETCH-MD5"), _sketchMD5);
+  _httpClient->addHeader(F("x-" AC_UPDATE_ARCH "-CHIP-SIZE"), String(AC_UPDATE_CHIPSIZE));
+  _httpClient->addHeader(F("x-" AC_UPDATE_ARCH "-SDK-VERSION"), String(ESP.getSdkVersion()));
+  if (_resumeOffset)
+    _httpClient->addHeader(F("Range"), String(F("bytes=")) + String(_resumeOffset) + '-');
+
+  int responseCode = _responseCode = _httpClient->GET();
+  if (responseCode == HTTP_CODE_PARTIAL_CONTENT && _resumeOffset) {
+    // Resume only the same binary from the requested position.
+    const String  range = _httpClient->header("Content-Range");
+    if (!range.startsWith(String(F("bytes ")) + String(_resumeOffset) + '-')
+      || static_cast<size_t>(range.substring(range.lastIndexOf('/') + 1).toInt()) != _resumeSize
+      || !_httpClient->header("x-MD5").equalsIgnoreCase(_resumeMD5)) {
+      _errString = String(F("The binary changed while resuming"));
+      const String  uriBin = _resumeUri;
+      _discard();
+      _resumeUri = uriBin;
+      transient = true;
+      return false;
+    }
+    AC_DBG_DUMB(" resume from %u", (unsigned int)_resumeOffset);
+  }
+  else if (responseCode == HTTP_CODE_OK) {
+    // The update server sends the whole binary, start over.
+    const String  uriBin = _resumeUri;
+    _discard();
+    _resumeUri = uriBin;
+    if (!_begin(*_httpClient))
+      return false;
   }
   else {
-    AC_DBG("An update has not specified");
-    _status = UPDATE_NOAVAIL;
+    _errString = String(F("Update server responds (")) + String(responseCode) + String(F("):")) + HTTPClient::errorToString(responseCode);
+    _retryAfter = _httpClient->header("Retry-After").toInt() * 1000UL;
+    transient = responseCode < 0;
+    return false;
   }
-  return _status;
+  return true;
+}
+
+/**
+ * Start writing the binary from the beginning of the response. The full
+ * binary begins the Update class with the content length and its MD5,
+ * and the patch begins it when its header arrives.
+ * @param  httpClient The response of the binary.
+ * @return false  The update cannot start.
+ */
+bool AutoConnectUpdateAct::_begin(HTTPClient& httpClient) {
+  const int length = httpClient.getSize();
+  _resumeMD5 = httpClient.header("x-MD5");
+  _resumeSize = length > 0 ? static_cast<size_t>(length) : 0;
+  if (!_resumeSize) {
+    _errString = String(F("Content-Length unknown"));
+    return false;
+  }
+
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+  if (_resumeUri.endsWith(F(AUTOCONNECT_UPDATE_PATCH_EXTENSION))) {
+    _patch.reset(new AutoConnectPatch);
+#if defined(ARDUINO_ARCH_ESP32)
+    const esp_partition_t*  runningPartition = esp_ota_get_running_partition();
+#endif
+    _patch->begin([=](const uint32_t offset, uint8_t* buf, const size_t size) {
+      // Read the running firmware.
+#if defined(ARDUINO_ARCH_ESP8266)
+      return ESP.flashRead(offset, buf, size);
+#elif defined(ARDUINO_ARCH_ESP32)
+      return esp_partition_read(runningPartition, offset, buf, size) == ESP_OK;
+#endif
+    }, [](const uint8_t* buf, const size_t size) {
+      return Update.write(const_cast<uint8_t*>(buf), size);
+    }, [this](AutoConnectPatch& header) {
+      if (!header.oldMD5().equalsIgnoreCase(_sketchMD5)) {
+        _errString = String(F("The patch is not for the running firmware"));
+        return false;
+      }
+      if (!Update.begin(header.newSize(), U_FLASH, _ledPort, _ledLevel)) {
+        StreamString  eStr;
+        Update.printError(eStr);
+        _errString = eStr;
+        return false;
+      }
+      // The new firmware is verified with its MD5 carried in the patch.
+      Update.setMD5(header.newMD5().c_str());
+      return true;
+    });
+    return true;
+  }
+#endif
+
+  if (!Update.begin(_resumeSize, U_FLASH, _ledPort, _ledLevel)) {
+    StreamString  eStr;
+    Update.printError(eStr);
+    _errString = eStr;
+    return false;
+  }
+  if (_resumeMD5.length())
+    Update.setMD5(_resumeMD5.c_str());
+  return true;
+}
+
+/**
+ * Complete the update with the binary transferred.
+ * @return false  The download has ended.
+ */
+bool AutoConnectUpdateAct::_finish(void) {
+  _disconnect(true);
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+  if (_patch && !_patch->end()) {
+    _errString = String(F("Incomplete patch"));
+    return _fail(false);
+  }
+#endif
+  if (!Update.end()) {
+    StreamString  eStr;
+    Update.printError(eStr);
+    _errString = eStr;
+    return _fail(false);
+  }
+  _discard();
+  _chunk.reset();
+  AC_DBG_DUMB(" completed\n");
+#ifdef AC_HAS_UPDATECALLBACK
+  if (_cbEnd)
+    _cbEnd();
+#endif
+  // The restart is left to handleUpdate, out of the update task.
+  _status = _reboot ? UPDATE_RESET : UPDATE_SUCCESS;
+  return false;
+}
+
+/**
+ * Handle the failure of the download. A transient failure such as the
+ * link drop is retried after AUTOCONNECT_UPDATE_RESUME_INTERVAL up to
+ * AUTOCONNECT_UPDATE_RESUME_RETRY times. When the retries run out, the
+ * checkpoint is kept so that the next update of the same binary
+ * resumes it as long as the module does not restart. The other
+ * failures abort the update.
+ * @param  transient  The failure is to be retried.
+ * @return true  The download will be retried.
+ */
+bool AutoConnectUpdateAct::_fail(const bool transient) {
+  _disconnect(false);
+  if (transient && _retry++ < AUTOCONNECT_UPDATE_RESUME_RETRY && WiFi.status() == WL_CONNECTED) {
+    AC_DBG_DUMB(" %s, retry", _errString.c_str());
+    _errString = String();
+    _phase = UPDATEPHASE_RETRY;
+    _tm = millis();
+    return true;
+  }
+#ifdef AC_HAS_UPDATECALLBACK
+  if (_cbError)
+    _cbError(Update.hasError() ? Update.getError() : _responseCode);
+#endif
+  if (transient && _resumeOffset)
+    _errString += String(F(", resumable from ")) + String(_resumeOffset);
+  else
+    _discard();
+  _chunk.reset();
+  _status = UPDATE_FAIL;
+  AC_DBG_DUMB(" %s\n", _errString.c_str());
+  AC_DBG("update returns HTTP_UPDATE_FAILED\n");
+  return false;
+}
+
+/**
+ * Begin the request on the persistent connection to the update server,
+ * which the catalog and the binary share as long as the update server
+ * keeps it alive.
+ * @param  path  The request path on the update server.
+ * @return false  The request cannot begin.
+ */
+bool AutoConnectUpdateAct::_connect(const String& path) {
+  if (!_httpClient)
+    _httpClient.reset(new HTTPClient);
+  _httpClient->setReuse(true);
+  // The connection alive with the same server only replaces the path.
+  // The begin would renew the client and lose the connection.
+  if (_httpClient->connected() && _connHost == host && _connPort == port)
+    _httpClient->setURL(path);
+  else {
+    if (!_httpClient->begin(_wifiClient, host, port, path))
+      return false;
+    _connHost = host;
+    _connPort = port;
+  }
+  _httpClient->setTimeout(_timeout);
+  return true;
+}
+
+/**
+ * End the request.
+ * @param  keep  Keep the connection alive for the next request. The
+ * connection with the response left unread cannot be reused.
+ */
+void AutoConnectUpdateAct::_disconnect(const bool keep) {
+  if (_httpClient) {
+    _httpClient->setReuse(keep);
+    _httpClient->end();
+  }
+}
+
+/**
+ * Discard the checkpoint of the interrupted download.
+ */
+void AutoConnectUpdateAct::_discard(void) {
+  if (Update.isRunning())
+    Update.end(false);
+  _resumeUri = String();
+  _resumeMD5 = String();
+  _resumeSize = 0;
+  _resumeOffset = 0;
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+  _patch.reset();
+#endif
 }
 
 /**
@@ -342,17 +776,21 @@ void AutoConnectUpdateAct::_buildAux(AutoConnectAux* aux, const AutoConnectAux::
 }
 
 /**
- * An update callback function in HTTPUpdate::update.
- * This callback handler acts as an HTTPUpdate::update callback and
- * sends the updated amount over the web socket to advance the progress
- * of the progress meter displayed in the browser.
+ * An update callback function of the Update class.
+ * This callback handler records the updated amount that the progress
+ * page inquires to advance the progress meter displayed in the browser.
+ * It may be called from the update task, so it does not serve the web
+ * server by itself.
  * @param  amount Already transferred size.
  * @param  size   Total size of the binary to update.
  */
 void AutoConnectUpdateAct::_inProgress(size_t amount, size_t size) {
   _amount = amount;
   _binSize = size;
-  _webServer->handleClient();
+#ifdef AC_HAS_UPDATECALLBACK
+  if (_cbProgress)
+    _cbProgress(amount, size);
+#endif
 }
 
 /**
@@ -367,103 +805,241 @@ void AutoConnectUpdateAct::_inProgress(size_t amount, size_t size) {
  */
 String AutoConnectUpdateAct::_onCatalog(AutoConnectAux& catalog, PageArgument& args) {
   AC_UNUSED(args);
-  WiFiClient  wifiClient;
-  HTTPClient  httpClient;
 
-  // Reallocate available firmwares list.
-  _binName = String("");
   AutoConnectText&  caption = catalog.getElement<AutoConnectText>(F("caption"));
   AutoConnectRadio& firmwares = catalog.getElement<AutoConnectRadio>(F("firmwares"));
   AutoConnectSubmit&  submit = catalog.getElement<AutoConnectSubmit>(F("update"));
-  firmwares.empty();
-  firmwares.tags.clear();
-  submit.enable = false;
+  // The update in the background is using the connection.
+  if (_status == UPDATE_PROGRESS || _status == UPDATE_START) {
+    caption.value = String(F("<h4>Update in progress</h4>"));
+    submit.enable = false;
+    return String("");
+  }
+
+  // Reallocate available firmwares list.
+  _binName = String("");
+
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+  // The patches are available only from the running firmware.
+  const String& sketchMD5 = _runningMD5();
+#endif
 
   String  qs = String(F(AUTOCONNECT_UPDATE_CATALOG)) + '?' + String(F("op=list&path=")) + uri;
-  AC_DBG("Query %s:%d%s\n", host.c_str(), port, qs.c_str());
+  // The catalog parsed last time is valid while the update server
+  // responds that it has not been modified since.
+  if (_catalogQuery != qs)
+    _catalogETag = String();
+  const bool  cached = _catalogETag.length();
 
   // Throw a query to the update server and parse the response JSON
   // document. After that, display the bin type file name contained in
   // its JSON document as available updaters to the page.
-  if (httpClient.begin(wifiClient, host, port, qs)) {
-    int responseCode = httpClient.GET();
-    if (responseCode == HTTP_CODE_OK) {
-
-      bool  parse;
-      char  beginOfList[] = "[";
-      char  endOfEntry[] = ",";
-      char  endOfList[] = "]";
-      WiFiClient& responseBody = httpClient.getStream();
-
-      // Read partially and repeatedly the responded http stream that is
-      // including the JSON array to reduce the buffer size for parsing
-      // of the firmware catalog list.
-      AC_DBG("Update server responded:");
-      responseBody.find(beginOfList);
-      do {
-        // The size of the JSON buffer is a fixed. It can be a problem
-        // when parsing with ArduinoJson V6. If memory insufficient has
-        // occurred during the parsing, increase this buffer size.
-        ArduinoJsonStaticBuffer<AUTOCONNECT_UPDATE_CATALOG_JSONBUFFER_SIZE> jb;
+  std::vector<String> names;
+  std::vector<String> tags;
+  String  err;
+  int responseCode = _queryCatalog(qs, _catalogETag, [&](ArduinoJsonObject json) {
+    // Register only bin type file name as available sketch binary to
+    // AutoConnectRadio value based on the response from the update server.
+    bool  available = json["type"].as<String>().equalsIgnoreCase("bin");
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+    if (json["type"].as<String>().equalsIgnoreCase("patch"))
+      available = json[F("base")].as<String>().equalsIgnoreCase(sketchMD5);
+#endif
+    if (available) {
+      names.push_back(json[F("name")].as<String>());
+      tags.push_back(String(F("<span>")) + json[F("date")].as<String>() + String(F("</span><span>")) + json[F("time")].as<String>().substring(0, 5) + String(F("</span><span>")) + String(json[F("size")].as<int>()) + String(F("</span>")));
+    }
+  }, err);
+
+  if (responseCode == HTTP_CODE_OK && !err.length()) {
+    firmwares.empty();
+    firmwares.order = AC_Horizontal;
+    for (const String& name : names)
+      firmwares.add(name);
+    firmwares.tags.swap(tags);
+    _catalogQuery = qs;
+  }
+  else if (!(responseCode == HTTP_CODE_NOT_MODIFIED && cached)) {
+    firmwares.empty();
+    firmwares.tags.clear();
+    submit.enable = false;
+    caption.value = err;
+    _status = UPDATE_IDLE;
+    return String("");
+  }
+  if (firmwares.size()) {
+    caption.value = String(F("<h4>Available firmwares</h4>"));
+    submit.enable = true;
+  }
+  else {
+    caption.value = String(F("<h4>No available firmwares</h4>"));
+    submit.enable = false;
+  }
+
+  _status = UPDATE_IDLE;
+  return String("");
+}
+
+/**
+ * Query the catalog to the update server and parse its entries one by
+ * one. It reads partially and repeatedly the responded http stream
+ * that is including the JSON array to reduce the buffer size for
+ * parsing of the firmware catalog list.
+ * @param  qs     The query string of the catalog.
+ * @param  etag   ETag of the catalog parsed last time to be sent with
+ * If-None-Match. It is replaced with the ETag of the catalog parsed.
+ * @param  entry  A function called with each entry of the catalog.
+ * @param  err    Returns the cause of the failure.
+ * @return HTTP response code. HTTP_CODE_OK with the cause of the failure
+ * indicates the invalid catalog.
+ */
+int AutoConnectUpdateAct::_queryCatalog(const String& qs, String& etag, std::function<void(ArduinoJsonObject)> entry, String& err) {
+  AC_DBG("Query %s:%d%s\n", host.c_str(), port, qs.c_str());
+  _retryAfter = 0;
+  if (!_connect(qs)) {
+    err = String(F("http failed connect to ")) + host + String(':') + String(port);
+    AC_DBG("%s\n", err.c_str());
+    etag = String();
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+
+  const char* headerKeys[] = { "ETag", "Retry-After" };
+  _httpClient->collectHeaders(headerKeys, sizeof(headerKeys) / sizeof(headerKeys[0]));
+  if (etag.length())
+    _httpClient->addHeader(F("If-None-Match"), etag);
+  int   responseCode = _httpClient->GET();
+  bool  keep = false;
+  if (responseCode == HTTP_CODE_NOT_MODIFIED && etag.length()) {
+    AC_DBG("Catalog not modified\n");
+    keep = true;
+  }
+  else if (responseCode == HTTP_CODE_OK) {
+    bool  parse;
+    char  beginOfList[] = "[";
+    char  endOfEntry[] = ",";
+    char  endOfList[] = "]";
+    WiFiClient& responseBody = _httpClient->getStream();
+
+    etag = String();
+    AC_DBG("Update server responded:");
+    responseBody.find(beginOfList);
+    do {
+      // The size of the JSON buffer is a fixed. It can be a problem
+      // when parsing with ArduinoJson V6. If memory insufficient has
+      // occurred during the parsing, increase this buffer size.
+      ArduinoJsonStaticBuffer<AUTOCONNECT_UPDATE_CATALOG_JSONBUFFER_SIZE> jb;
 
 #if ARDUINOJSON_VERSION_MAJOR<=5
-        ArduinoJsonObject json = jb.parseObject(responseBody);
-        parse = json.success();
+      ArduinoJsonObject json = jb.parseObject(responseBody);
+      parse = json.success();
 #else
-        DeserializationError err = deserializeJson(jb, responseBody);
-        ArduinoJsonObject json = jb.as<JsonObject>();
-        parse = (err == DeserializationError::Ok);
+      DeserializationError jerr = deserializeJson(jb, responseBody);
+      ArduinoJsonObject json = jb.as<JsonObject>();
+      parse = (jerr == DeserializationError::Ok);
 #endif
-        if (parse) {
+      if (parse) {
 #ifdef AC_DEBUG
-          AC_DBG_DUMB("\n");
-          ARDUINOJSON_PRINT(json, AC_DEBUG_PORT);
+        AC_DBG_DUMB("\n");
+        ARDUINOJSON_PRINT(json, AC_DEBUG_PORT);
 #endif
-          // Register only bin type file name as available sketch binary to
-          // AutoConnectRadio value based on the response from the update server.
-          firmwares.order = AC_Horizontal;
-          if (json["type"].as<String>().equalsIgnoreCase("bin")) {
-            firmwares.add(json[F("name")].as<String>());
-            String  attr = String(F("<span>")) + json[F("date")].as<String>() + String(F("</span><span>")) + json[F("time")].as<String>().substring(0, 5) + String(F("</span><span>")) + String(json[F("size")].as<int>()) + String(F("</span>"));
-            firmwares.tags.push_back(attr);
-          }
-        }
-        else {
+        entry(json);
+      }
+      else {
 #if ARDUINOJSON_VERSION_MAJOR<=5
-          String  errCaption = String(F("JSON parse error"));
+        String  errCaption = String(F("JSON parse error"));
 #else
-          String  errCaption = String(err.c_str());
+        String  errCaption = String(jerr.c_str());
 #endif
-          caption.value = String(F("Invalid catalog list:")) + errCaption;
-          AC_DBG("JSON:%s\n", errCaption.c_str());
-          break;
-        }
-      } while (responseBody.findUntil(endOfEntry, endOfList));
-
-      AC_DBG_DUMB("\n");
-      if (parse) {
-        if (firmwares.size()) {
-          caption.value = String(F("<h4>Available firmwares</h4>"));
-          submit.enable = true;
-        }
-        else
-          caption.value = String(F("<h4>No available firmwares</h4>"));
+        err = String(F("Invalid catalog list:")) + errCaption;
+        AC_DBG("JSON:%s\n", errCaption.c_str());
+        break;
       }
+    } while (responseBody.findUntil(endOfEntry, endOfList));
+    AC_DBG_DUMB("\n");
+
+    // The catalog read through can keep the connection.
+    if (parse) {
+      etag = _httpClient->header("ETag");
+      keep = true;
     }
-    else {
-      caption.value = String(F("Update server responds (")) + String(responseCode) + String("):");
-      caption.value += HTTPClient::errorToString(responseCode);
-      AC_DBG("%s\n", caption.value.c_str());
-    }
-    httpClient.end();
   }
   else {
-    caption.value = String(F("http failed connect to ")) + host + String(':') + String(port);
-    AC_DBG("%s\n", caption.value.c_str());
+    err = String(F("Update server responds (")) + String(responseCode) + String("):");
+    err += HTTPClient::errorToString(responseCode);
+    AC_DBG("%s\n", err.c_str());
+    etag = String();
   }
+  _retryAfter = _httpClient->header("Retry-After").toInt() * 1000UL;
+  _disconnect(keep);
+  return responseCode;
+}
 
-  _status = UPDATE_IDLE;
-  return String("");
+/**
+ * Poll the catalog for the scheduled update. Only the binary named by
+ * the schedule target is rolled out, and the update starts if its MD5
+ * differs from the running firmware and the device falls within the
+ * rollout percentage of the target. A patch from the running firmware
+ * to the target is taken instead of the binary if the catalog has it.
+ * The other binaries in the catalog are never installed, so that the
+ * fleet neither downgrades nor alternates between the binaries.
+ */
+void AutoConnectUpdateAct::_poll(void) {
+  const String  qs = String(F(AUTOCONNECT_UPDATE_CATALOG)) + '?' + String(F("op=list&path=")) + uri;
+  const String& sketchMD5 = _runningMD5();
+  String  binName;
+  String  targetMD5;
+  String  err;
+  int     rollout = 100;
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+  std::vector<std::pair<String, String>>  patches;
+#endif
+
+  int responseCode = _queryCatalog(qs, _scheduleETag, [&](ArduinoJsonObject json) {
+    const String  type = json["type"].as<String>();
+    const String  name = json[F("name")].as<String>();
+    // The binary without its MD5 in the catalog is not determined
+    // whether it is updated.
+    const char* md5 = json[F("md5")].as<const char*>();
+    if (!md5 || strlen(md5) != 32)
+      return;
+    if (type.equalsIgnoreCase("bin") && name.equalsIgnoreCase(_scheduleTarget)) {
+      binName = name;
+      targetMD5 = md5;
+      rollout = json.containsKey(F("rollout")) ? json[F("rollout")].as<int>() : 100;
+    }
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+    // The patch from the running firmware is a candidate, which will be
+    // matched against the target after the whole catalog is parsed.
+    else if (type.equalsIgnoreCase("patch") && json[F("base")].as<String>().equalsIgnoreCase(sketchMD5))
+      patches.push_back(std::make_pair(name, String(md5)));
+#endif
+  }, err);
+
+  // The running firmware is already the target.
+  if (targetMD5.equalsIgnoreCase(sketchMD5))
+    binName = String();
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+  else {
+    // The patch leading to the target takes precedence.
+    for (const std::pair<String, String>& patch : patches)
+      if (patch.second.equalsIgnoreCase(targetMD5)) {
+        binName = patch.first;
+        break;
+      }
+  }
+#endif
+
+  if (responseCode == HTTP_CODE_OK && !err.length() && binName.length()) {
+    if (_scheduler.eligible(rollout)) {
+      AC_DBG("Scheduled update %s, bucket %u of %d%%\n", binName.c_str(), _scheduler.bucket(), rollout);
+      _binName = binName;
+      _scheduled = true;
+      _status = UPDATE_START;
+      return;
+    }
+    AC_DBG("%s rolls out %d%%, out of bucket %u\n", binName.c_str(), rollout, _scheduler.bucket());
+  }
+  _scheduler.next(millis(), responseCode == HTTP_CODE_TOO_MANY_REQUESTS || responseCode == HTTP_CODE_SERVICE_UNAVAILABLE, _retryAfter);
 }
 
 /**
@@ -476,9 +1052,10 @@ String AutoConnectUpdateAct::_onCatalog(AutoConnectAux& catalog, PageArgument& a
 String AutoConnectUpdateAct::_onUpdate(AutoConnectAux& progress, PageArgument& args) {
   AC_UNUSED(args);
 
-  // Constructs the dialog page.
+  // Constructs the dialog page. The binary being downloaded is kept.
   AutoConnectElement* binName = progress.getElement(F("binname"));
-  _binName = _auxCatalog->getElement<AutoConnectRadio>(F("firmwares")).value();
+  if (_status != UPDATE_PROGRESS && _status != UPDATE_START)
+    _binName = _auxCatalog->getElement<AutoConnectRadio>(F("firmwares")).value();
   binName->value = _binName;
   AutoConnectElement* url = progress.getElement(F("url"));
   url->value = host + ':' + port;
@@ -518,7 +1095,9 @@ String AutoConnectUpdateAct::_onResult(AutoConnectAux& result, PageArgument& arg
   resultElm.value = _binName + resForm;
   resultElm.style = String(F("font-size:120%;color:")) + resColor;
   result.getElement<AutoConnectElement>(F("restart")).enable = restart;
-  _errString.clear();
+  // The update in the background may still be writing the error.
+  if (_status != UPDATE_PROGRESS && _status != UPDATE_START)
+    _errString.clear();
 
   return String("");
 }
@@ -574,7 +1153,7 @@ void AutoConnectUpdateAct::_progress(void) {
   case HTTP_GET:
     switch (_status) {
     case UPDATE_PROGRESS:
-      payload = String(AUTOCONNECT_UPDATE_NOTIFY_PROGRESS) + ',' + String(_amount) + ':' + String(_binSize);
+      payload = String(AUTOCONNECT_UPDATE_NOTIFY_PROGRESS) + ',' + String(static_cast<size_t>(_amount)) + ':' + String(static_cast<size_t>(_binSize));
       httpCode = 200;
       break;
     case UPDATE_IDLE:
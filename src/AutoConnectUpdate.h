@@ -34,7 +34,11 @@
 #ifndef AUTOCONNECT_USE_JSON
 #define AUTOCONNECT_USE_JSON
 #endif
+#include <functional>
 #include <memory>
+#include <vector>
+#include "AutoConnectJsonDefs.h"
+#include "AutoConnectSchedule.h"
 #define NO_GLOBAL_HTTPUPDATE
 #if defined(ARDUINO_ARCH_ESP8266)
 #include <ESP8266HTTPClient.h>
@@ -45,6 +49,19 @@ using HTTPUpdateClass = ESP8266HTTPUpdate;
 #include <HTTPUpdate.h>
 using HTTPUpdateClass = HTTPUpdate;
 #endif
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+#include "AutoConnectPatch.h"
+#endif
+// The exit routines of HTTPUpdate are available with ESP32 Arduino core
+// 2.0.0 or later.
+#if defined(ARDUINO_ARCH_ESP8266) || (defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR>=2)
+#define AC_HAS_UPDATECALLBACK
+#endif
+#ifdef AUTOCONNECT_USE_UPDATETASK
+#include <atomic>
+#include <thread>
+#include <esp_pthread.h>
+#endif
 // Quote the true AutoConnectUpdate class according to AUTOCONNECT_USE_UPDATE.
 #define AutoConnectUpdate  AutoConnectUpdateAct
 #else // !AUTOCONNECT_USE_UPDATE!
@@ -102,12 +119,12 @@ class AutoConnectUpdateVoid {
 class AutoConnectUpdateAct : public AutoConnectUpdateVoid, public HTTPUpdateClass {
  public:
   explicit AutoConnectUpdateAct(const String& host = String(""), const uint16_t port = AUTOCONNECT_UPDATE_PORT, const String& uri = String("."), const int timeout = AUTOCONNECT_UPDATE_TIMEOUT, const uint8_t ledOn = AUTOCONNECT_TICKER_LEVEL)
-    : HTTPUpdateClass(timeout), host(host), port(port), uri(uri), _amount(0), _binSize(0), _enable(false), _dialog(UPDATEDIALOG_LOADER), _status(UPDATE_IDLE), _binName(String()), _webServer(nullptr) {
+    : HTTPUpdateClass(timeout), host(host), port(port), uri(uri), _timeout(timeout), _amount(0), _binSize(0), _enable(false), _dialog(UPDATEDIALOG_LOADER), _status(UPDATE_IDLE), _binName(String()), _webServer(nullptr) {
     AC_SETLED(ledOn);       /**< LED blinking during the update that is the default. */
     rebootOnUpdate(false);  /**< Default reboot mode */
   }
   AutoConnectUpdateAct(AutoConnectExt<AutoConnectConfigExt>& portal, const String& host = String(""), const uint16_t port = AUTOCONNECT_UPDATE_PORT, const String& uri = String("."), const int timeout = AUTOCONNECT_UPDATE_TIMEOUT, const uint8_t ledOn = AUTOCONNECT_TICKER_LEVEL)
-    : HTTPUpdateClass(timeout), host(host), port(port), uri(uri), _amount(0), _binSize(0), _enable(false), _dialog(UPDATEDIALOG_LOADER), _status(UPDATE_IDLE), _binName(String()), _webServer(nullptr) {
+    : HTTPUpdateClass(timeout), host(host), port(port), uri(uri), _timeout(timeout), _amount(0), _binSize(0), _enable(false), _dialog(UPDATEDIALOG_LOADER), _status(UPDATE_IDLE), _binName(String()), _webServer(nullptr) {
     AC_SETLED(ledOn);
     rebootOnUpdate(false);
     attach(portal);
@@ -120,6 +137,17 @@ class AutoConnectUpdateAct : public AutoConnectUpdateVoid, public HTTPUpdateClas
   bool  isEnabled(void) override { return _auxCatalog ? _auxCatalog->isMenu() : false; } /**< Returns current updater effectiveness */
   AC_UPDATESTATUS_t  status(void) override { return _status; }   /**< reports the current update behavior status */
   AC_UPDATESTATUS_t  update(void) override;    /**< behaves update */
+  void  schedule(const unsigned long interval, const unsigned long jitter = AUTOCONNECT_UPDATE_SCHEDULE_JITTER, const String& target = String(F(AUTOCONNECT_UPDATE_SCHEDULE_TARGET)));  /**< Poll the catalog and update unattended */
+  void  rebootOnUpdate(bool reboot) { _reboot = reboot; HTTPUpdateClass::rebootOnUpdate(reboot); } /**< Restart after the update */
+  void  setLedPin(int ledPin = -1, uint8_t ledOn = HIGH) { _ledPort = ledPin; _ledLevel = ledOn; HTTPUpdateClass::setLedPin(ledPin, ledOn); } /**< LED blinking during the update */
+#ifdef AC_HAS_UPDATECALLBACK
+  // The update runs without HTTPUpdate::update, so the exit routines
+  // are called by AutoConnectUpdate itself.
+  void  onStart(HTTPUpdateStartCB fn) { _cbStart = fn; }
+  void  onEnd(HTTPUpdateEndCB fn) { _cbEnd = fn; }
+  void  onError(HTTPUpdateErrorCB fn) { _cbError = fn; }
+  void  onProgress(HTTPUpdateProgressCB fn) { _cbProgress = fn; }
+#endif
 
   String    host;           /**< Available URL of Update Server */
   uint16_t  port;           /**< Port number of the update server */
@@ -138,24 +166,94 @@ class AutoConnectUpdateAct : public AutoConnectUpdateVoid, public HTTPUpdateClas
   String  _onCatalog(AutoConnectAux& catalog, PageArgument& args);
   String  _onUpdate(AutoConnectAux& update, PageArgument& args);
   String  _onResult(AutoConnectAux& result, PageArgument& args);
+  int     _queryCatalog(const String& qs, String& etag, std::function<void(ArduinoJsonObject)> entry, String& err); /**< Query and parse the catalog */
+  void    _poll(void);          /**< Poll the catalog for the scheduled update */
   void    _inProgress(size_t amount, size_t size);  /**< UpdateClass::THandlerFunction_Progress */
+  bool    _start(void);         /**< Start the update of the selected binary */
+  bool    _step(void);          /**< Advance the download by a chunk */
+  const String& _runningMD5(void);  /**< MD5 of the running firmware */
+  bool    _request(bool& transient);  /**< Request the binary from the checkpoint */
+  bool    _begin(HTTPClient& httpClient); /**< Start the update with the response */
+  bool    _finish(void);        /**< Complete the update */
+  bool    _fail(const bool transient);  /**< Retry or abort the download */
+  void    _discard(void);       /**< Discard the checkpoint */
+  bool    _connect(const String& path); /**< Begin the request on the persistent connection */
+  void    _disconnect(const bool keep);   /**< End the request */
+
+  // Phase of the download in progress
+  typedef enum {
+    UPDATEPHASE_REQUEST,    /**< Request the binary */
+    UPDATEPHASE_TRANSFER,   /**< Transfer the response to the Update class */
+    UPDATEPHASE_RETRY       /**< Wait for the retry */
+  } AC_UPDATEPHASE_t;
 
   std::unique_ptr<AutoConnectAux> _auxCatalog;   /**< A catalog page for internally generated update binaries */
   std::unique_ptr<AutoConnectAux> _auxProgress;  /**< An update in-progress page */  
   std::unique_ptr<AutoConnectAux> _auxResult;    /**< A update result page  */
 
+  int     _timeout;             /**< Timeout of the HTTP client */
+  int     _ledPort = -1;        /**< LED blinking during the update */
+  uint8_t _ledLevel = LOW;      /**< LED active level */
+#ifdef AUTOCONNECT_USE_UPDATETASK
+  std::atomic<size_t> _amount;  /**< Received amount bytes, written by the update task */
+  std::atomic<size_t> _binSize; /**< Updater binary size, written by the update task */
+#else
   size_t  _amount;              /**< Received amount bytes */
   size_t  _binSize;             /**< Updater binary size */
+#endif
 
  private:
   void    _progress(void);      /**< A Handler that returns progress status to the web client */
 
   bool              _enable;    /**< Validation status of the Update class */
   AC_UPDATEDIALOG_t _dialog;    /**< The type of updating dialog displayed on the client */
+#ifdef AUTOCONNECT_USE_UPDATETASK
+  // The update task publishes the result with the status. The loop task
+  // reads the error and the response code only after the status has
+  // left UPDATE_PROGRESS, so they need no lock of their own.
+  std::atomic<AC_UPDATESTATUS_t>  _status;  /**< Status of update processing during the cycle of receiving a request */
+#else
   AC_UPDATESTATUS_t _status;    /**< Status of update processing during the cycle of receiving a request */
+#endif
   String            _binName;   /**< .bin name to update */
   String            _errString; /**< error text reservation */
+  String            _sketchMD5; /**< MD5 of the running firmware */
   WebServer*        _webServer; /**< Hosted WebServer for XMLHttpRequest */
+  String            _resumeUri;     /**< The binary being downloaded */
+  String            _resumeMD5;     /**< x-MD5 of the binary to identify it on resuming */
+  size_t            _resumeSize = 0;    /**< Size of the binary */
+  size_t            _resumeOffset = 0;  /**< Bytes written, from which the download resumes */
+#ifdef AUTOCONNECT_USE_UPDATEPATCH
+  std::unique_ptr<AutoConnectPatch> _patch; /**< The patch being applied */
+#endif
+  AC_UPDATEPHASE_t  _phase = UPDATEPHASE_REQUEST; /**< Phase of the download */
+  WiFiClient        _wifiClient;    /**< The client for the update server */
+  std::unique_ptr<HTTPClient> _httpClient;  /**< The persistent connection to the update server */
+  String            _connHost;      /**< The server of the persistent connection */
+  uint16_t          _connPort = 0;  /**< The port of the persistent connection */
+  String            _catalogQuery;  /**< The query of the catalog cached */
+  String            _catalogETag;   /**< ETag of the catalog cached */
+  AutoConnectSchedule _scheduler;   /**< Timing of the scheduled update */
+  String            _scheduleETag;  /**< ETag of the catalog polled last time */
+  String            _scheduleTarget;  /**< The binary rolled out by the scheduled update */
+  bool              _scheduled = false; /**< The update in progress is scheduled */
+  unsigned long     _retryAfter = 0;    /**< Retry-After of the last response [ms] */
+  std::unique_ptr<uint8_t[]>  _chunk;       /**< The chunk being transferred */
+  unsigned long     _tm = 0;        /**< Time of the last transfer or the failure */
+  uint8_t           _retry = 0;     /**< Number of retries */
+  int               _responseCode = 0;  /**< HTTP response code of the last request */
+  bool              _async = false; /**< The update is running in the background */
+  bool              _reboot = true; /**< Restart after the update */
+#ifdef AC_HAS_UPDATECALLBACK
+  HTTPUpdateStartCB     _cbStart;     /**< Exit routine at the update start */
+  HTTPUpdateEndCB       _cbEnd;       /**< Exit routine at the update end */
+  HTTPUpdateErrorCB     _cbError;     /**< Exit routine at the update error */
+  HTTPUpdateProgressCB  _cbProgress;  /**< Exit routine of the update progress */
+#endif
+#ifdef AUTOCONNECT_USE_UPDATETASK
+  std::thread       _thread;        /**< The update task */
+  std::atomic<bool> _running{false};  /**< The update task is running */
+#endif
 
   static const AutoConnectAux::ACPage_t         _pageCatalog  PROGMEM;
   static const AutoConnectAux::ACElementProp_t  _elmCatalog[] PROGMEM;
@@ -19,6 +19,10 @@
 #include <WiFi.h>
 #include <WebServer.h>
 #endif
+#include "AutoConnectDefs.h"
+#ifdef AUTOCONNECT_USE_UPLOADDIGEST
+#include "AutoConnectDigest.h"
+#endif
 
 /**
  * Uploader base class. This class is a wrapper for the AutoConnectUpload
@@ -32,7 +36,8 @@ class AutoConnectUploadHandler {
     AC_UPLOAD_END,
     AC_UPLOAD_ABORTED,
     AC_UPLOAD_ERROR_OPEN,
-    AC_UPLOAD_ERROR_WRITE
+    AC_UPLOAD_ERROR_WRITE,
+    AC_UPLOAD_ERROR_DIGEST
   } AC_UPLOADStatus_t;
 
   // Callback functions to notify the upload status
@@ -49,6 +54,9 @@ class AutoConnectUploadHandler {
   AutoConnectUploadHandler& onProgress(ProgressExit_ft fn) { _cbProgress = fn; return *this; }  /**< Register a callback for OTA in progress */
   virtual void upload(const String& requestUri, const HTTPUpload& upload);
   AC_UPLOADStatus_t status(void) { return _status; }
+#ifdef AUTOCONNECT_USE_UPLOADDIGEST
+  void  verify(const AutoConnectDigest::AC_DIGEST_t type, const String& digest) { _digest.begin(type); _expected = digest; }  /**< Verify the next upload with the digest */
+#endif
 
 protected:
   virtual bool    _open(const char* filename, const char* mode) = 0;
@@ -65,6 +73,10 @@ protected:
   AC_UPLOADStatus_t _status;
   size_t  _ulAmount;              /**< Cumulative amount uploaded */
   String  _err;                   /**< Occurred error stamp */
+#ifdef AUTOCONNECT_USE_UPLOADDIGEST
+  AutoConnectDigest _digest;      /**< Digest of the data being uploaded */
+  String  _expected;              /**< The digest expected for the current upload */
+#endif
 };
 
 #endif // !_AUTOCONNECTUPLOAD_H_
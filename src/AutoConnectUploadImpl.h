@@ -21,6 +21,7 @@
 #include "AutoConnectDefs.h"
 #include "AutoConnectUpload.h"
 #include "AutoConnectFS.h"
+#include "AutoConnectOTABuffer.h"
 
 namespace AutoConnectUtil {
 AC_HAS_FUNC(end);
@@ -52,6 +53,7 @@ void AutoConnectUploadHandler::upload(const String& requestUri, const HTTPUpload
   case UPLOAD_FILE_START: {
     _status = AC_UPLOAD_IDLE;
     _ulAmount = 0;
+    _err = String();
     if (_cbStart)   // Notify an OTA status change
       _cbStart();
     String  absFilename = "/" + upload.filename;
@@ -63,6 +65,11 @@ void AutoConnectUploadHandler::upload(const String& requestUri, const HTTPUpload
   }
   case UPLOAD_FILE_WRITE: {
     size_t  wsz = _write(upload.buf, upload.currentSize);
+#ifdef AUTOCONNECT_USE_UPLOADDIGEST
+    // Hash the received data as it is written, so that the verification
+    // does not read back the destination.
+    _digest.add(upload.buf, upload.currentSize);
+#endif
     if ((int)wsz != -1) {
       _ulAmount += wsz;
       if (_cbProgress)
@@ -75,10 +82,25 @@ void AutoConnectUploadHandler::upload(const String& requestUri, const HTTPUpload
     break;
   }
   case UPLOAD_FILE_END:
-  case UPLOAD_FILE_ABORTED:
-    _close(upload.status);
+  case UPLOAD_FILE_ABORTED: {
+    HTTPUploadStatus  status = upload.status;
+#ifdef AUTOCONNECT_USE_UPLOADDIGEST
+    // Verify the digest before the destination commits the upload. The
+    // mismatch closes the destination as aborted.
+    if (_digest.type() != AutoConnectDigest::AC_DIGEST_NONE) {
+      String  digest = _digest.toString();
+      if (status == UPLOAD_FILE_END && _status == AC_UPLOAD_IDLE && !_err.length() && !digest.equalsIgnoreCase(_expected)) {
+        AC_DBG("Digest %s expected %s\n", digest.c_str(), _expected.c_str());
+        status = UPLOAD_FILE_ABORTED;
+        _status = AC_UPLOAD_ERROR_DIGEST;
+        _setError("Digest mismatch");
+      }
+    }
+    _expected = String();
+#endif
+    _close(status);
     if (_status == AC_UPLOAD_IDLE) {
-      if (upload.status == UPLOAD_FILE_ABORTED) {
+      if (status == UPLOAD_FILE_ABORTED) {
         _status = AC_UPLOAD_ABORTED;
         _setError(nullptr);
       }
@@ -89,6 +111,7 @@ void AutoConnectUploadHandler::upload(const String& requestUri, const HTTPUpload
       _cbEnd();
     break;
   }
+  }
 }
 
 /**
@@ -104,126 +127,213 @@ void AutoConnectUploadHandler::_setError(const char* err) {
     _cbError((uint8_t)_status);
 } 
 
+static_assert(AUTOCONNECT_UPLOAD_FS_BUFFERSIZE % 256 == 0, "AUTOCONNECT_UPLOAD_FS_BUFFERSIZE must be a multiple of the flash page size");
+static_assert(AUTOCONNECT_UPLOAD_SD_BUFFERSIZE % 512 == 0, "AUTOCONNECT_UPLOAD_SD_BUFFERSIZE must be a multiple of the SD sector size");
+
 // Default handler for uploading to the standard SPIFFS class embedded in the core.
+// The uploaded data is written in the blocks aligned with the flash
+// pages through a single staging block, without the writer thread of
+// AutoConnectOTA. The filesystem mounted by this handler is left
+// mounted for the next upload with keepMount.
 class AutoConnectUploadFS : public AutoConnectUploadHandler {
  public:
-  explicit AutoConnectUploadFS(AutoConnectFS::FS& media) : _media(&media), _mounted(false) {}
+  explicit AutoConnectUploadFS(AutoConnectFS::FS& media, const bool keepMount = AUTOCONNECT_UPLOAD_KEEPMOUNT, const size_t bufferSize = AUTOCONNECT_UPLOAD_FS_BUFFERSIZE) : _media(&media), _mounted(false), _keepMount(keepMount), _buffer(bufferSize, false) {}
   ~AutoConnectUploadFS() { _close(HTTPUploadStatus::UPLOAD_FILE_END); }
 
  protected:
   bool  _open(const char* filename, const char* mode) override {
-    _mounted = AutoConnectFS::_isMounted(_media);
-    if (!_mounted) {
+    if (!AutoConnectFS::_isMounted(_media)) {
       AC_DBG("%s is not mounted, ensure mount\n", AUTOCONNECT_STRING_DEPLOY(AUTOCONNECT_APPLIED_FILESYSTEM));
       if (!_media->begin(AUTOCONNECT_FS_INITIALIZATION)) {
         AC_DBG("%s mount failed\n", AUTOCONNECT_STRING_DEPLOY(AUTOCONNECT_APPLIED_FILESYSTEM));
         return false;
       }
+      _mounted = true;
     }
+    _filename = String(filename);
     _file = _media->open(filename, mode);
-    return _file != false;      
+    if (!_file)
+      return false;
+    _buffer.begin(std::bind(&AutoConnectUploadFS::_flush, this, std::placeholders::_1, std::placeholders::_2));
+    return true;
   }
 
   size_t  _write(const uint8_t* buf, const size_t size) override {
-    if (_file)
-      return _file.write(buf, size);
+    if (_file && (!size || _buffer.write(buf, size)))
+      return size;
     else
       return -1;
   }
 
   void  _close(const HTTPUploadStatus status) override {
-    AC_UNUSED(status);
-    if (_file)
+    if (_file) {
+      // Write the remaining partial block.
+      const bool  flushed = _buffer.end(status == UPLOAD_FILE_END) || status != UPLOAD_FILE_END;
+      if (!flushed && _status == AC_UPLOAD_IDLE) {
+        _status = AC_UPLOAD_ERROR_WRITE;
+        _setError("Write failed");
+      }
       _file.close();
-    if (!_mounted)
+      // Do not leave the incomplete file.
+      if (status == UPLOAD_FILE_ABORTED || !flushed)
+        _media->remove(_filename);
+    }
+    if (_mounted && !_keepMount) {
       _media->end();
+      _mounted = false;
+    }
   }
 
+  size_t  _flush(const uint8_t* buf, const size_t size) { return _file.write(buf, size); }
+
  private:
   AutoConnectFS::FS*  _media;       /**< Actual Filesystem */
   fs::File            _file;        /**< File instace */
-  bool                _mounted;     /**< Need to end of the filesystem */
+  String              _filename;    /**< Name of the file being uploaded */
+  bool                _mounted;     /**< The filesystem mounted by this handler */
+  bool                _keepMount;   /**< Keep the filesystem mounted after the upload */
+  AutoConnectOTABuffer  _buffer;    /**< Coalesces the chunks into the pages */
 };
 
 // Default handler for uploading to the standard SD class embedded in the core.
+// The uploaded data is written in the blocks aligned with the SD
+// sectors through a single staging block, without the writer thread of
+// AutoConnectOTA. With keepMount, the SD stays mounted across the uploads
+// instead of beginning and ending it for each.
 class AutoConnectUploadSD : public AutoConnectUploadHandler {
  public:
-  explicit AutoConnectUploadSD(AutoConnectFS::SDClassT& media, const uint8_t cs = AUTOCONNECT_SD_CS, const uint32_t speed = AUTOCONNECT_SD_SPEED) : _media(&media), _cs(cs), _speed(speed) {}
+  explicit AutoConnectUploadSD(AutoConnectFS::SDClassT& media, const uint8_t cs = AUTOCONNECT_SD_CS, const uint32_t speed = AUTOCONNECT_SD_SPEED, const bool keepMount = AUTOCONNECT_UPLOAD_KEEPMOUNT, const size_t bufferSize = AUTOCONNECT_UPLOAD_SD_BUFFERSIZE) : _media(&media), _cs(cs), _speed(speed), _keepMount(keepMount), _buffer(bufferSize, false) {}
   ~AutoConnectUploadSD() { _close(HTTPUploadStatus::UPLOAD_FILE_END); }
 
  protected:
   bool  _open(const char* filename, const char* mode) override {
-    const char* sdVerify;
 #if defined(ARDUINO_ARCH_ESP8266)
-    if (_media->begin(_cs, AC_SD_SPEED(_speed))) {
-      uint8_t oflag = *mode == 'w' ? FILE_WRITE : FILE_READ;
-      uint8_t sdType = _media->type();      
-      switch (sdType) {
-      case 1: // SD_CARD_TYPE_SD1
-        sdVerify = (const char*)"MMC";
-        break;
-      case 2: // SD_CARD_TYPE_SD2
-        sdVerify = (const char*)"SDSC";
-        break;
-      case 3: // SD_CARD_TYPE_SDHC
-        sdVerify = (const char*)"SDHC";
-        break;
-      default:
-        sdVerify = (const char*)"UNKNOWN";
-        break;
-      }
+    uint8_t oflag = *mode == 'w' ? FILE_WRITE : FILE_READ;
 #elif defined(ARDUINO_ARCH_ESP32)
-    if (_media->begin(_cs, SPI, _speed)) {
-      const char* oflag = mode;
-      uint8_t sdType = _media->cardType();
-      switch (sdType) {
-      case CARD_NONE:
-        sdVerify = (const char*)"No card";
-        break;
-      case CARD_MMC:
-        sdVerify = (const char*)"MMC";
-        break;
-      case CARD_SD:
-        sdVerify = (const char*)"SDSC";
-        break;
-      case CARD_SDHC:
-        sdVerify = (const char*)"SDHC";
-        break;
-      default:
-        sdVerify = (const char*)"UNKNOWN";
-        break;
-      }
-#endif
-#ifndef AC_DEBUG
-      AC_UNUSED(sdVerify);
+    const char* oflag = mode;
 #endif
-      AC_DBG("%s mounted\n", sdVerify);
+    _filename = String(filename);
+    if (_mounted())
       _file = _media->open(filename, oflag);
-      return _file != false;
+    if (!_file) {
+      // The SD kept mounted may have been replaced or ended by the
+      // sketch, then mount it again.
+      if (_mounted()) {
+        AutoConnectUtil::end<AutoConnectFS::SDClassT>(_media);
+        _mounted() = false;
+      }
+      if (!_mount())
+        return false;
+      _file = _media->open(filename, oflag);
+      if (!_file)
+        return false;
     }
-    AC_DBG("SD mount failed\n");
-    return false;
+    _buffer.begin(std::bind(&AutoConnectUploadSD::_flush, this, std::placeholders::_1, std::placeholders::_2));
+    return true;
   }
 
   size_t  _write(const uint8_t* buf, const size_t size) override {
-    if (_file)
-      return _file.write(buf, size);
+    if (_file && (!size || _buffer.write(buf, size)))
+      return size;
     else
       return -1;
   }
 
   void  _close(const HTTPUploadStatus status) override {
-    AC_UNUSED(status);
-    if (_file)
+    if (_file) {
+      // Write the remaining partial block.
+      const bool  flushed = _buffer.end(status == UPLOAD_FILE_END) || status != UPLOAD_FILE_END;
+      if (!flushed && _status == AC_UPLOAD_IDLE) {
+        _status = AC_UPLOAD_ERROR_WRITE;
+        _setError("Write failed");
+      }
       _file.close();
-    AutoConnectUtil::end<AutoConnectFS::SDClassT>(_media);
+      // Do not leave the incomplete file.
+      if (status == UPLOAD_FILE_ABORTED || !flushed)
+        _media->remove(_filename.c_str());
+    }
+    if (_mounted() && !_keepMount) {
+      AutoConnectUtil::end<AutoConnectFS::SDClassT>(_media);
+      _mounted() = false;
+    }
+  }
+
+  /**
+   * Begin the SD and report the card type.
+   */
+  bool  _mount(void) {
+    const char* sdVerify;
+#if defined(ARDUINO_ARCH_ESP8266)
+    if (!_media->begin(_cs, AC_SD_SPEED(_speed))) {
+      AC_DBG("SD mount failed\n");
+      return false;
+    }
+    uint8_t sdType = _media->type();
+    switch (sdType) {
+    case 1: // SD_CARD_TYPE_SD1
+      sdVerify = (const char*)"MMC";
+      break;
+    case 2: // SD_CARD_TYPE_SD2
+      sdVerify = (const char*)"SDSC";
+      break;
+    case 3: // SD_CARD_TYPE_SDHC
+      sdVerify = (const char*)"SDHC";
+      break;
+    default:
+      sdVerify = (const char*)"UNKNOWN";
+      break;
+    }
+#elif defined(ARDUINO_ARCH_ESP32)
+    if (!_media->begin(_cs, SPI, _speed)) {
+      AC_DBG("SD mount failed\n");
+      return false;
+    }
+    uint8_t sdType = _media->cardType();
+    switch (sdType) {
+    case CARD_NONE:
+      sdVerify = (const char*)"No card";
+      break;
+    case CARD_MMC:
+      sdVerify = (const char*)"MMC";
+      break;
+    case CARD_SD:
+      sdVerify = (const char*)"SDSC";
+      break;
+    case CARD_SDHC:
+      sdVerify = (const char*)"SDHC";
+      break;
+    default:
+      sdVerify = (const char*)"UNKNOWN";
+      break;
+    }
+#endif
+#ifndef AC_DEBUG
+    AC_UNUSED(sdVerify);
+#endif
+    AC_DBG("%s mounted\n", sdVerify);
+    _mounted() = true;
+    return true;
+  }
+
+  size_t  _flush(const uint8_t* buf, const size_t size) { return _file.write(buf, size); }
+
+  /**
+   * The mount state outlives the handler, which AutoConnectFile
+   * instantiates for each upload.
+   */
+  static bool&  _mounted(void) {
+    static bool mounted = false;
+    return mounted;
   }
 
  private:
   AutoConnectFS::SDClassT*  _media;
   AutoConnectFS::SDFileT    _file;
+  String    _filename;
   uint8_t   _cs;
   uint32_t  _speed;
+  bool      _keepMount;             /**< Keep the SD mounted after the upload */
+  AutoConnectOTABuffer  _buffer;    /**< Coalesces the chunks into the sectors */
 };
 
 #endif // !_AUTOCONNECTUPLOADIMPL_H_
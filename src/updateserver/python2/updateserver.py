@@ -5,25 +5,38 @@
 
 from __future__ import absolute_import
 import argparse
+import binascii
+import collections
 import hashlib
 import httplib
-import CGIHTTPServer, SimpleHTTPServer, BaseHTTPServer
+import CGIHTTPServer, SimpleHTTPServer, BaseHTTPServer, SocketServer
 import json
 import logging
 import os
 import re
 import socket
+import threading
 import time
 import urllib2, urllib, urlparse
 from itertools import imap
 from io import open
 
+PATCH_EXTENSION = '.acpatch'
+PATCH_HEADER_SIZE = 48
+
+
+class ThreadingHTTPServer(SocketServer.ThreadingMixIn, BaseHTTPServer.HTTPServer):
+    pass
+
 
 class UpdateHttpServer(object):
-    def __init__(self, port, bind, catalog_dir):
+    def __init__(self, port, bind, catalog_dir, rollout=None, rate_limit=0):
+        limiter = RateLimiter(rate_limit)
+
         def handler(*args):
-            UpdateHTTPRequestHandler(catalog_dir, *args)
-        httpd = BaseHTTPServer.HTTPServer((bind, port), handler)
+            UpdateHTTPRequestHandler(catalog_dir, rollout, limiter, *args)
+        httpd = ThreadingHTTPServer((bind, port), handler)
+        httpd.daemon_threads = True
         sa = httpd.socket.getsockname()
         logger.info('http server starting {0}:{1} {2}'.format(sa[0], sa[1], catalog_dir))
         try:
@@ -34,11 +47,25 @@ class UpdateHttpServer(object):
 
 
 class UpdateHTTPRequestHandler(BaseHTTPServer.BaseHTTPRequestHandler):
-    def __init__(self, catalog_dir, *args):
+    # HTTP/1.1 keeps the connection alive for the catalog and the binary.
+    protocol_version = 'HTTP/1.1'
+
+    def __init__(self, catalog_dir, rollout, limiter, *args):
         self.catalog_dir = catalog_dir
+        self.rollout = rollout
+        self.limiter = limiter
         BaseHTTPServer.BaseHTTPRequestHandler.__init__(self, *args)
 
     def do_GET(self):
+        # Let the devices back off when the requests exceed the limit.
+        retry_after = self.limiter.retry_after()
+        if retry_after:
+            logger.info('Too many requests, retry after {0}s'.format(retry_after))
+            self.send_response(429)
+            self.send_header('Retry-After', str(retry_after))
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            return
         request_path = urlparse.urlparse(self.path)
         if request_path.path == '/_catalog':
             err = ''
@@ -66,6 +93,7 @@ class UpdateHTTPRequestHandler(BaseHTTPServer.BaseHTTPRequestHandler):
             if not result:
                 logger.info(err)
                 self.send_response(httplib.FORBIDDEN, err)
+                self.send_header('Content-Length', '0')
                 self.end_headers()
         else:
             self.__send_file(self.path)
@@ -89,6 +117,7 @@ class UpdateHTTPRequestHandler(BaseHTTPServer.BaseHTTPRequestHandler):
     def __send_file(self, path):
         if not self.__check_header():
             self.send_response(httplib.FORBIDDEN, 'The request available only from ESP8266 or ESP32 http updater.')
+            self.send_header('Content-Length', '0')
             self.end_headers()
             return
 
@@ -96,33 +125,54 @@ class UpdateHTTPRequestHandler(BaseHTTPServer.BaseHTTPRequestHandler):
         logger.debug('Request file:{0}'.format(filename))
         try:
             fsize = os.path.getsize(filename)
-            self.send_response(httplib.OK)
+            # The client resumes the interrupted download with the Range
+            # request from the bytes it already has.
+            start = 0
+            m = re.match(r'bytes=(\d+)-$', self.headers.get('Range', ''))
+            if m and int(m.group(1)) < fsize:
+                start = int(m.group(1))
+                self.send_response(httplib.PARTIAL_CONTENT)
+                self.send_header('Content-Range', 'bytes {0}-{1}/{2}'.format(start, fsize - 1, fsize))
+            else:
+                self.send_response(httplib.OK)
             self.send_header('Content-Type', 'application/octet-stream')
             self.send_header('Content-Disposition', 'attachment; filename=' + os.path.basename(filename))
-            self.send_header('Content-Length', fsize)
+            self.send_header('Content-Length', fsize - start)
+            self.send_header('Accept-Ranges', 'bytes')
             self.send_header('x-MD5', get_MD5(filename))
             self.end_headers()
             f = open(filename, 'rb')
+            f.seek(start)
             self.wfile.write(f.read())
             f.close()
         except Exception, e:
             err = unicode(e)
             logger.error(err)
             self.send_response(httplib.INTERNAL_SERVER_ERROR, err)
+            self.send_header('Content-Length', '0')
             self.end_headers()
 
     def __send_dir(self, path):
-        content = dir_json(path)
+        content = dir_json(path, self.rollout)
         d = json.dumps(content).encode('UTF-8', 'replace')
         logger.debug(d)
+        # The client keeps the catalog while the ETag matches.
+        etag = '"' + hashlib.md5(d).hexdigest() + '"'
+        if etag in [t.strip() for t in self.headers.get('If-None-Match', '').split(',')]:
+            self.send_response(httplib.NOT_MODIFIED)
+            self.send_header('ETag', etag)
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            return
         self.send_response(httplib.OK)
         self.send_header('Content-Type', 'application/json')
         self.send_header('Content-Length', unicode(len(d)))
+        self.send_header('ETag', etag)
         self.end_headers()
         self.wfile.write(d)
 
 
-def dir_json(path):
+def dir_json(path, rollout=None):
     d = list()
     for entry in os.listdir(path):
         e = {'name': entry}
@@ -130,25 +180,60 @@ def dir_json(path):
             e['type'] = "directory"
         else:
             e['type'] = "file"
-            if os.path.splitext(entry)[1] == '.bin':
+            ext = os.path.splitext(entry)[1]
+            if ext in ('.bin', PATCH_EXTENSION):
                 fn = os.path.join(path, entry)
                 try:
                     f = open(fn, 'rb')
-                    c = f.read(1)
+                    c = f.read(PATCH_HEADER_SIZE)
                     f.close()
-                except Exception, e:
-                    logger.info(unicode(e))
+                except Exception, ex:
+                    logger.info(unicode(ex))
                     c = '\x00'
-                if c == '\xe9':
+                if ext == '.bin' and c[:1] == '\xe9':
                     e['type'] = "bin"
+                    # The MD5 tells the scheduled update whether it is the running firmware.
+                    e['md5'] = get_MD5(fn)
+                elif ext == PATCH_EXTENSION and len(c) == PATCH_HEADER_SIZE and c[:8] == 'ACPATCH1':
+                    # The patch is available to the firmware with the MD5 as the base.
+                    e['type'] = "patch"
+                    e['base'] = binascii.hexlify(c[16:32]).decode('ascii')
+                    # The MD5 of the firmware that the patch produces.
+                    e['md5'] = binascii.hexlify(c[32:48]).decode('ascii')
+                if e['type'] != "file":
                     mtime = os.path.getmtime(fn)
                     e['date'] = time.strftime('%x', time.localtime(mtime))
                     e['time'] = time.strftime('%X', time.localtime(mtime))
                     e['size'] = os.path.getsize(fn)
+                    if rollout is not None:
+                        e['rollout'] = rollout
         d.append(e)
     return d
 
 
+class RateLimiter(object):
+    """Limits the requests per minute from all clients."""
+
+    def __init__(self, limit):
+        self.limit = limit
+        self.lock = threading.Lock()
+        self.requests = collections.deque()
+
+    def retry_after(self):
+        """Returns 0 if the request is accepted, otherwise the seconds
+        until the limit allows the request."""
+        if not self.limit:
+            return 0
+        with self.lock:
+            now = time.time()
+            while self.requests and now - self.requests[0] >= 60:
+                self.requests.popleft()
+            if len(self.requests) < self.limit:
+                self.requests.append(now)
+                return 0
+            return int(60 - (now - self.requests[0])) + 1
+
+
 def get_MD5(filename):
     try:
         f = open(filename, 'rb')
@@ -161,9 +246,9 @@ def get_MD5(filename):
         return None
 
 
-def run(port=8000, bind='127.0.0.1', catalog_dir='', log_level=logging.INFO):
+def run(port=8000, bind='127.0.0.1', catalog_dir='', log_level=logging.INFO, rollout=None, rate_limit=0):
     logging.basicConfig(level=log_level)
-    UpdateHttpServer(port, bind, catalog_dir)
+    UpdateHttpServer(port, bind, catalog_dir, rollout, rate_limit)
 
 
 if __name__ == "__main__":
@@ -176,9 +261,13 @@ if __name__ == "__main__":
                         help='Catalog directory')
     parser.add_argument('--log', '-l', action='store', default='INFO',
                         help='Logging level')
+    parser.add_argument('--rollout', '-r', action='store', default=None, type=int,
+                        help='Percentage of the devices to which the scheduled update rolls out')
+    parser.add_argument('--rate-limit', action='store', default=0, type=int,
+                        help='Maximum requests per minute, responds 429 beyond it [default:0, unlimited]')
     args = parser.parse_args()
     loglevel = getattr(logging, args.log.upper(), None)
     if not isinstance(loglevel, int):
         raise ValueError('Invalid log level: %s' % args.log)
     logger = logging.getLogger(__name__)
-    run(args.port, args.bind, args.catalog, loglevel)
+    run(args.port, args.bind, args.catalog, loglevel, args.rollout, args.rate_limit)
@@ -0,0 +1,259 @@
+#!python3.*
+
+"""Binary patch generator for AutoConnectUpdate.
+
+Generates the patch that AutoConnectUpdate applies to the running
+firmware to reconstruct the new firmware, in the manner of bsdiff. The
+patch consists of the header and the records as follows, where the diff
+is run-length encoded on the zeros since it mostly consists of zeros.
+
+    header: b'ACPATCH1', old size, new size (uint32 LE),
+            MD5 of the old image, MD5 of the new image
+    record: varint diff length, varint extra length, zigzag varint seek,
+            diff as pairs of (varint zeros, varint literals, literals),
+            extra bytes
+
+    acpatch.py [-o OUTPUT] [--verify] old.bin new.bin
+"""
+
+import argparse
+import bisect
+import hashlib
+import re
+import struct
+import sys
+
+MAGIC = b'ACPATCH1'
+HEADER = struct.Struct('<8sII16s16s')
+EXTENSION = '.acpatch'
+KEY_LENGTH = 16             # Prefix length to sort the suffixes of the old image
+
+
+def varint(n):
+    out = bytearray()
+    while True:
+        b = n & 0x7f
+        n >>= 7
+        if n:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(n):
+    return (n << 1) ^ (n >> 31) if n >= 0 else ((-n - 1) << 1) | 1
+
+
+def matchlen(old, op, new, np):
+    """Length of the common prefix of old[op:] and new[np:]."""
+    n = min(len(old) - op, len(new) - np)
+    length = 0
+    step = 4096
+    while step:
+        while length + step <= n and old[op + length:op + length + step] == new[np + length:np + length + step]:
+            length += step
+        step //= 8
+    while length < n and old[op + length] == new[np + length]:
+        length += 1
+    return length
+
+
+class SuffixIndex:
+    """Suffixes of the old image sorted by the prefix of KEY_LENGTH,
+    which approximates the suffix array of bsdiff."""
+
+    def __init__(self, old):
+        self.old = old
+        keys = [old[i:i + KEY_LENGTH] for i in range(len(old))]
+        self.sa = sorted(range(len(old)), key=keys.__getitem__)
+        self.keys = [keys[i] for i in self.sa]
+
+    def search(self, new, np):
+        """Returns the length and the position of the longest match."""
+        if not self.sa:
+            return 0, 0
+        i = bisect.bisect_left(self.keys, new[np:np + KEY_LENGTH])
+        best = (0, 0)
+        for j in (i - 1, i, i + 1):
+            if 0 <= j < len(self.sa):
+                pos = self.sa[j]
+                length = matchlen(self.old, pos, new, np)
+                if length > best[0]:
+                    best = (length, pos)
+        return best
+
+
+def encode_diff(db):
+    """Run-length encode the zeros of the diff."""
+    out = bytearray()
+    if not db:
+        return bytes(out)
+    pos = 0
+    zeros = 0
+    for m in re.finditer(rb'\x00{3,}', db):
+        if m.start() == 0:
+            zeros = m.end()
+            pos = m.end()
+            continue
+        literals = db[pos:m.start()]
+        out += varint(zeros) + varint(len(literals)) + literals
+        zeros = m.end() - m.start()
+        pos = m.end()
+    literals = db[pos:]
+    out += varint(zeros) + varint(len(literals)) + literals
+    return bytes(out)
+
+
+def diff(old, new):
+    """Generate the patch records in the manner of bsdiff 4."""
+    index = SuffixIndex(old)
+    oldsize, newsize = len(old), len(new)
+    records = bytearray()
+    scan = length = pos = 0
+    lastscan = lastpos = lastoffset = 0
+
+    while scan < newsize:
+        oldscore = 0
+        scan += length
+        scsc = scan
+        while scan < newsize:
+            length, pos = index.search(new, scan)
+            while scsc < scan + length:
+                if scsc + lastoffset < oldsize and old[scsc + lastoffset] == new[scsc]:
+                    oldscore += 1
+                scsc += 1
+            if (length == oldscore and length != 0) or length > oldscore + 8:
+                break
+            if scan + lastoffset < oldsize and old[scan + lastoffset] == new[scan]:
+                oldscore -= 1
+            scan += 1
+
+        if length != oldscore or scan == newsize:
+            s = sf = lenf = 0
+            i = 0
+            while lastscan + i < scan and lastpos + i < oldsize:
+                if old[lastpos + i] == new[lastscan + i]:
+                    s += 1
+                i += 1
+                if s * 2 - i > sf * 2 - lenf:
+                    sf = s
+                    lenf = i
+
+            lenb = 0
+            if scan < newsize:
+                s = sb = 0
+                i = 1
+                while scan >= lastscan + i and pos >= i:
+                    if old[pos - i] == new[scan - i]:
+                        s += 1
+                    if s * 2 - i > sb * 2 - lenb:
+                        sb = s
+                        lenb = i
+                    i += 1
+
+            if lastscan + lenf > scan - lenb:
+                overlap = (lastscan + lenf) - (scan - lenb)
+                s = ss = lens = 0
+                for i in range(overlap):
+                    if new[lastscan + lenf - overlap + i] == old[lastpos + lenf - overlap + i]:
+                        s += 1
+                    if new[scan - lenb + i] == old[pos - lenb + i]:
+                        s -= 1
+                    if s > ss:
+                        ss = s
+                        lens = i + 1
+                lenf += lens - overlap
+                lenb -= lens
+
+            db = bytes((new[lastscan + i] - old[lastpos + i]) & 0xff for i in range(lenf))
+            extra = new[lastscan + lenf:scan - lenb]
+            seek = (pos - lenb) - (lastpos + lenf)
+            records += varint(lenf) + varint(len(extra)) + varint(zigzag(seek))
+            records += encode_diff(db) + extra
+
+            lastscan = scan - lenb
+            lastpos = pos - lenb
+            lastoffset = pos - scan
+
+    return bytes(records)
+
+
+def make_patch(old, new):
+    header = HEADER.pack(MAGIC, len(old), len(new), hashlib.md5(old).digest(), hashlib.md5(new).digest())
+    return header + diff(old, new)
+
+
+def read_header(patch):
+    """Returns the header as (old size, new size, old MD5, new MD5) or
+    None if it is not a patch."""
+    if len(patch) < HEADER.size:
+        return None
+    magic, oldsize, newsize, oldmd5, newmd5 = HEADER.unpack_from(patch)
+    if magic != MAGIC:
+        return None
+    return oldsize, newsize, oldmd5.hex(), newmd5.hex()
+
+
+def apply_patch(old, patch):
+    """Apply the patch as AutoConnectPatch does, for the verification."""
+    oldsize, newsize, oldmd5, newmd5 = read_header(patch)
+    p = HEADER.size
+
+    def get():
+        nonlocal p
+        n = shift = 0
+        while True:
+            c = patch[p]
+            p += 1
+            n |= (c & 0x7f) << shift
+            shift += 7
+            if not c & 0x80:
+                return n
+
+    def old_at(i):
+        return old[i] if 0 <= i < len(old) else 0
+
+    new = bytearray()
+    oldpos = 0
+    while len(new) < newsize:
+        difflen, extralen, seek = get(), get(), get()
+        seek = (seek >> 1) ^ -(seek & 1)
+        while difflen:
+            zeros = get()
+            for _ in range(zeros):
+                new.append(old_at(oldpos))
+                oldpos += 1
+            literals = get()
+            for d in patch[p:p + literals]:
+                new.append((old_at(oldpos) + d) & 0xff)
+                oldpos += 1
+            p += literals
+            difflen -= zeros + literals
+        new += patch[p:p + extralen]
+        p += extralen
+        oldpos += seek
+    return bytes(new)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Generate the binary patch for AutoConnectUpdate.')
+    parser.add_argument('old', help='The firmware running on the device')
+    parser.add_argument('new', help='The firmware to be updated')
+    parser.add_argument('--output', '-o', action='store',
+                        help='Output patch file [default:NEW with {0} extension]'.format(EXTENSION))
+    parser.add_argument('--verify', action='store_true',
+                        help='Verify the patch by applying it')
+    args = parser.parse_args()
+
+    with open(args.old, 'rb') as f:
+        old = f.read()
+    with open(args.new, 'rb') as f:
+        new = f.read()
+    patch = make_patch(old, new)
+    if args.verify and apply_patch(old, patch) != new:
+        sys.exit('Patch verification failed')
+    output = args.output or re.sub(r'\.bin$', '', args.new) + EXTENSION
+    with open(output, 'wb') as f:
+        f.write(patch)
+    print('{0}: {1} bytes, {2:.1f}% of {3}'.format(output, len(patch), len(patch) * 100 / max(len(new), 1), args.new))
@@ -4,6 +4,8 @@
 """
 
 import argparse
+import binascii
+import collections
 import hashlib
 import http.server
 import json
@@ -11,15 +13,22 @@ import logging
 import os
 import re
 import socket
+import threading
 import time
 import urllib.parse
 
+PATCH_EXTENSION = '.acpatch'
+PATCH_HEADER_SIZE = 48
+
 
 class UpdateHttpServer:
-    def __init__(self, port, bind, catalog_dir):
+    def __init__(self, port, bind, catalog_dir, rollout=None, rate_limit=0):
+        limiter = RateLimiter(rate_limit)
+
         def handler(*args):
-            UpdateHTTPRequestHandler(catalog_dir, *args)
-        httpd = http.server.HTTPServer((bind, port), handler)
+            UpdateHTTPRequestHandler(catalog_dir, rollout, limiter, *args)
+        httpd = http.server.ThreadingHTTPServer((bind, port), handler)
+        httpd.daemon_threads = True
         sa = httpd.socket.getsockname()
         logger.info('http server starting {0}:{1} {2}'.format(sa[0], sa[1], catalog_dir))
         try:
@@ -30,11 +39,25 @@ class UpdateHttpServer:
 
 
 class UpdateHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
-    def __init__(self, catalog_dir, *args):
+    # HTTP/1.1 keeps the connection alive for the catalog and the binary.
+    protocol_version = 'HTTP/1.1'
+
+    def __init__(self, catalog_dir, rollout, limiter, *args):
         self.catalog_dir = catalog_dir
+        self.rollout = rollout
+        self.limiter = limiter
         http.server.BaseHTTPRequestHandler.__init__(self, *args)
 
     def do_GET(self):
+        # Let the devices back off when the requests exceed the limit.
+        retry_after = self.limiter.retry_after()
+        if retry_after:
+            logger.info('Too many requests, retry after {0}s'.format(retry_after))
+            self.send_response(http.HTTPStatus.TOO_MANY_REQUESTS)
+            self.send_header('Retry-After', str(retry_after))
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            return
         request_path = urllib.parse.urlparse(self.path)
         if request_path.path == '/_catalog':
             err = ''
@@ -62,6 +85,7 @@ class UpdateHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
             if not result:
                 logger.info(err)
                 self.send_response(http.HTTPStatus.FORBIDDEN, err)
+                self.send_header('Content-Length', '0')
                 self.end_headers()
         else:
             self.__send_file(self.path)
@@ -85,6 +109,7 @@ class UpdateHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
     def __send_file(self, path):
         if not self.__check_header():
             self.send_response(http.HTTPStatus.FORBIDDEN, 'The request available only from ESP8266 or ESP32 http updater.')
+            self.send_header('Content-Length', '0')
             self.end_headers()
             return
 
@@ -92,33 +117,54 @@ class UpdateHTTPRequestHandler(http.server.BaseHTTPRequestHandler):
         logger.debug('Request file:{0}'.format(filename))
         try:
             fsize = os.path.getsize(filename)
-            self.send_response(http.HTTPStatus.OK)
+            # The client resumes the interrupted download with the Range
+            # request from the bytes it already has.
+            start = 0
+            m = re.match(r'bytes=(\d+)-$', self.headers.get('Range', ''))
+            if m and int(m.group(1)) < fsize:
+                start = int(m.group(1))
+                self.send_response(http.HTTPStatus.PARTIAL_CONTENT)
+                self.send_header('Content-Range', 'bytes {0}-{1}/{2}'.format(start, fsize - 1, fsize))
+            else:
+                self.send_response(http.HTTPStatus.OK)
             self.send_header('Content-Type', 'application/octet-stream')
             self.send_header('Content-Disposition', 'attachment; filename=' + os.path.basename(filename))
-            self.send_header('Content-Length', fsize)
+            self.send_header('Content-Length', fsize - start)
+            self.send_header('Accept-Ranges', 'bytes')
             self.send_header('x-MD5', get_MD5(filename))
             self.end_headers()
             f = open(filename, 'rb')
+            f.seek(start)
             self.wfile.write(f.read())
             f.close()
         except Exception as e:
             err = str(e)
             logger.error(err)
             self.send_response(http.HTTPStatus.INTERNAL_SERVER_ERROR, err)
+            self.send_header('Content-Length', '0')
             self.end_headers()
 
     def __send_dir(self, path):
-        content = dir_json(path)
+        content = dir_json(path, self.rollout)
         d = json.dumps(content).encode('UTF-8', 'replace')
         logger.debug(d)
+        # The client keeps the catalog while the ETag matches.
+        etag = '"' + hashlib.md5(d).hexdigest() + '"'
+        if etag in [t.strip() for t in self.headers.get('If-None-Match', '').split(',')]:
+            self.send_response(http.HTTPStatus.NOT_MODIFIED)
+            self.send_header('ETag', etag)
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            return
         self.send_response(http.HTTPStatus.OK)
         self.send_header('Content-Type', 'application/json')
         self.send_header('Content-Length', str(len(d)))
+        self.send_header('ETag', etag)
         self.end_headers()
         self.wfile.write(d)
 
 
-def dir_json(path):
+def dir_json(path, rollout=None):
     d = list()
     for entry in os.listdir(path):
         e = {'name': entry}
@@ -126,25 +172,60 @@ def dir_json(path):
             e['type'] = "directory"
         else:
             e['type'] = "file"
-            if os.path.splitext(entry)[1] == '.bin':
+            ext = os.path.splitext(entry)[1]
+            if ext in ('.bin', PATCH_EXTENSION):
                 fn = os.path.join(path, entry)
                 try:
                     f = open(fn, 'rb')
-                    c = f.read(1)
+                    c = f.read(PATCH_HEADER_SIZE)
                     f.close()
-                except Exception as e:
-                    logger.info(str(e))
+                except Exception as ex:
+                    logger.info(str(ex))
                     c = b'\x00'
-                if c == b'\xe9':
+                if ext == '.bin' and c[:1] == b'\xe9':
                     e['type'] = "bin"
+                    # The MD5 tells the scheduled update whether it is the running firmware.
+                    e['md5'] = get_MD5(fn)
+                elif ext == PATCH_EXTENSION and len(c) == PATCH_HEADER_SIZE and c[:8] == b'ACPATCH1':
+                    # The patch is available to the firmware with the MD5 as the base.
+                    e['type'] = "patch"
+                    e['base'] = binascii.hexlify(c[16:32]).decode('ascii')
+                    # The MD5 of the firmware that the patch produces.
+                    e['md5'] = binascii.hexlify(c[32:48]).decode('ascii')
+                if e['type'] != "file":
                     mtime = os.path.getmtime(fn)
                     e['date'] = time.strftime('%x', time.localtime(mtime))
                     e['time'] = time.strftime('%X', time.localtime(mtime))
                     e['size'] = os.path.getsize(fn)
+                    if rollout is not None:
+                        e['rollout'] = rollout
         d.append(e)
     return d
 
 
+class RateLimiter:
+    """Limits the requests per minute from all clients."""
+
+    def __init__(self, limit):
+        self.limit = limit
+        self.lock = threading.Lock()
+        self.requests = collections.deque()
+
+    def retry_after(self):
+        """Returns 0 if the request is accepted, otherwise the seconds
+        until the limit allows the request."""
+        if not self.limit:
+            return 0
+        with self.lock:
+            now = time.time()
+            while self.requests and now - self.requests[0] >= 60:
+                self.requests.popleft()
+            if len(self.requests) < self.limit:
+                self.requests.append(now)
+                return 0
+            return int(60 - (now - self.requests[0])) + 1
+
+
 def get_MD5(filename):
     try:
         f = open(filename, 'rb')
@@ -157,9 +238,9 @@ def get_MD5(filename):
         return None
 
 
-def run(port=8000, bind='127.0.0.1', catalog_dir='', log_level=logging.INFO):
+def run(port=8000, bind='127.0.0.1', catalog_dir='', log_level=logging.INFO, rollout=None, rate_limit=0):
     logging.basicConfig(level=log_level)
-    UpdateHttpServer(port, bind, catalog_dir)
+    UpdateHttpServer(port, bind, catalog_dir, rollout, rate_limit)
 
 
 if __name__ == "__main__":
@@ -172,9 +253,13 @@ if __name__ == "__main__":
                         help='Catalog directory')
     parser.add_argument('--log', '-l', action='store', default='INFO',
                         help='Logging level')
+    parser.add_argument('--rollout', '-r', action='store', default=None, type=int,
+                        help='Percentage of the devices to which the scheduled update rolls out')
+    parser.add_argument('--rate-limit', action='store', default=0, type=int,
+                        help='Maximum requests per minute, responds 429 beyond it [default:0, unlimited]')
     args = parser.parse_args()
     loglevel = getattr(logging, args.log.upper(), None)
     if not isinstance(loglevel, int):
         raise ValueError('Invalid log level: %s' % args.log)
     logger = logging.getLogger(__name__)
-    run(args.port, args.bind, args.catalog, loglevel)
+    run(args.port, args.bind, args.catalog, loglevel, args.rollout, args.rate_limit)